@@ -22,6 +22,7 @@
 
 // Based on the ScummVM (GPLv2+) file of the same name
 
+#include "common/atomic.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -44,7 +45,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, int id, bool permanent);
+	Channel(MixerImpl *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, byte volume, int8 balance);
 	~Channel();
 
 	/**
@@ -63,18 +64,6 @@ public:
 	 */
 	bool isFinished() const { return _stream->endOfStream(); }
 
-	/**
-	 * Queries whether the channel is a permanent channel.
-	 * A permanent channel is not affected by a Mixer::stopAll
-	 * call.
-	 */
-	bool isPermanent() const { return _permanent; }
-
-	/**
-	 * Returns the id of the channel.
-	 */
-	int getId() const { return _id; }
-
 	/**
 	 * Pauses or unpaused the channel in a recursive fashion.
 	 *
@@ -123,9 +112,10 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Queries the playback position of the channel, from which
+	 * MixerImpl computes how long it has been playing.
 	 */
-	Common::Timestamp getElapsedTime();
+	void getTime(ChannelTime &time) const;
 
 	/**
 	 * Queries the channel's sound type.
@@ -147,9 +137,7 @@ public:
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
-	bool _permanent;
 	int _pauseLevel;
-	int _id;
 
 	byte _volume;
 	int8 _balance;
@@ -157,7 +145,7 @@ private:
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
-	Mixer *_mixer;
+	MixerImpl *_mixer;
 
 	uint32 _samplesConsumed;
 	uint32 _samplesDecoded;
@@ -175,15 +163,21 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _commandHead(0), _commandTail(0), _mixing(0), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0),
+	  _soundTypeSettings(), _mixSoundTypeSettings() {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_finishedHandles[i] = 0xFFFFFFFF;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// Streams of sounds which are still queued are owned by us as well
+	applyCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -196,29 +190,151 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
-			break;
+int MixerImpl::getMixVolumeForSoundType(SoundType type) const {
+	assert(0 <= (int)type && (int)type < ARRAYSIZE(_mixSoundTypeSettings));
+
+	if (_mixSoundTypeSettings[type].mute)
+		return 0;
+
+	return _mixSoundTypeSettings[type].volume;
+}
+
+int MixerImpl::findChannel(SoundHandle handle) {
+	updateFinishedChannels();
+
+	const int index = handle._val % NUM_CHANNELS;
+	if (!_channelInfo[index].active || _channelInfo[index].handle._val != handle._val)
+		return -1;
+
+	return index;
+}
+
+void MixerImpl::updateFinishedChannels() {
+	Common::memoryBarrier();
+
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_channelInfo[i].active && _finishedHandles[i] == _channelInfo[i].handle._val)
+			_channelInfo[i].active = false;
+}
+
+void MixerImpl::postCommand(const ChannelCommand &command) {
+	while (_commandTail - _commandHead == COMMAND_QUEUE_SIZE) {
+		// The mixer has not caught up yet (or is not running at all), so
+		// apply the queue ourselves if it is not busy
+		if (Common::compareAndSwap(&_mixing, 0, 1)) {
+			applyCommands();
+			Common::memoryBarrier();
+			_mixing = 0;
+		} else {
+			g_system->delayMillis(1);
 		}
 	}
-	if (index == -1) {
-		warning("MixerImpl::out of mixer slots");
-		delete chan;
-		return;
+
+	_commands[_commandTail % COMMAND_QUEUE_SIZE] = command;
+
+	// The command has to be complete before the mixing can see it
+	Common::memoryBarrier();
+	_commandTail++;
+}
+
+void MixerImpl::postStop(int index) {
+	_channelInfo[index].active = false;
+
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandStop;
+	command.handle = _channelInfo[index].handle;
+	command.channel = 0;
+	command.value = 0;
+	postCommand(command);
+}
+
+void MixerImpl::waitForMixing() {
+	// Any mixing which starts after this point applies the stop commands
+	// before touching the channels, so only a running one has to finish
+	Common::memoryBarrier();
+
+	while (_mixing)
+		g_system->delayMillis(1);
+}
+
+void MixerImpl::applyCommands() {
+	Common::memoryBarrier();
+	const uint32 tail = _commandTail;
+	Common::memoryBarrier();
+
+	for (uint32 i = _commandHead; i != tail; i++) {
+		const ChannelCommand &command = _commands[i % COMMAND_QUEUE_SIZE];
+		const int index = command.handle._val % NUM_CHANNELS;
+
+		// Changes to sounds which terminated in the meantime are dropped
+		Channel *chan = _channels[index];
+		if (command.type != ChannelCommand::kCommandPlay && command.type != ChannelCommand::kCommandPauseAll &&
+				command.type != ChannelCommand::kCommandSoundType) {
+			if (!chan || chan->getHandle()._val != command.handle._val)
+				continue;
+		}
+
+		switch (command.type) {
+		case ChannelCommand::kCommandPlay:
+			// The slot is only reused after the previous sound was stopped
+			delete chan;
+			_channels[index] = command.channel;
+			_channels[index]->notifyGlobalVolChange();
+			publishChannelTime(index);
+			break;
+		case ChannelCommand::kCommandStop:
+			delete chan;
+			_channels[index] = 0;
+			break;
+		case ChannelCommand::kCommandPause:
+			chan->pause(command.value != 0);
+			publishChannelTime(index);
+			break;
+		case ChannelCommand::kCommandPauseAll:
+			for (int j = 0; j != NUM_CHANNELS; j++) {
+				if (_channels[j]) {
+					_channels[j]->pause(command.value != 0);
+					publishChannelTime(j);
+				}
+			}
+			break;
+		case ChannelCommand::kCommandVolume:
+			chan->setVolume(command.value);
+			break;
+		case ChannelCommand::kCommandBalance:
+			chan->setBalance(command.value);
+			break;
+		case ChannelCommand::kCommandSoundType:
+			_mixSoundTypeSettings[command.value] = command.settings;
+			for (int j = 0; j != NUM_CHANNELS; j++) {
+				if (_channels[j] && _channels[j]->getType() == command.value)
+					_channels[j]->notifyGlobalVolChange();
+			}
+			break;
+		}
 	}
 
-	_channels[index] = chan;
+	// The slots have to be read before the producer may reuse them
+	Common::memoryBarrier();
+	_commandHead = tail;
+}
 
-	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+void MixerImpl::publishChannelTime(int index) {
+	ChannelTime &time = _channelTimes[index];
+	ChannelTime current;
+	_channels[index]->getTime(current);
 
-	chan->setHandle(chanHandle);
-	_handleSeed++;
-	if (handle)
-		*handle = chanHandle;
+	// A seqlock: readers retry while the sequence is odd or has changed
+	time.sequence++;
+	Common::memoryBarrier();
+	time.handle = _channels[index]->getHandle()._val;
+	time.samplesConsumed = current.samplesConsumed;
+	time.mixerTimeStamp = current.mixerTimeStamp;
+	time.pauseStartTime = current.pauseStartTime;
+	time.pauseTime = current.pauseTime;
+	time.paused = current.paused;
+	Common::memoryBarrier();
+	time.sequence++;
 }
 
 void MixerImpl::playStream(
@@ -238,10 +354,12 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	updateFinishedChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (_channelInfo[i].active && _channelInfo[i].id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -259,87 +377,138 @@ void MixerImpl::playStream(
 	autofreeStream = DisposeAfterUse::YES;
 #endif
 
+	int index = -1;
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (!_channelInfo[i].active) {
+			index = i;
+			break;
+		}
+	}
+
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, id, permanent);
-	chan->setVolume(volume);
-	chan->setBalance(balance);
-	insertChannel(handle, chan);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, volume, balance);
+
+	if (index == -1) {
+		warning("MixerImpl::out of mixer slots");
+		delete chan;
+		return;
+	}
+
+	SoundHandle chanHandle;
+	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	_handleSeed++;
+
+	chan->setHandle(chanHandle);
+	if (handle)
+		*handle = chanHandle;
+
+	ChannelInfo &info = _channelInfo[index];
+	info.active = true;
+	info.handle = chanHandle;
+	info.id = id;
+	info.type = type;
+	info.permanent = permanent;
+	info.volume = volume;
+	info.balance = balance;
+
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandPlay;
+	command.handle = chanHandle;
+	command.channel = chan;
+	command.value = 0;
+	postCommand(command);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
 	len >>= 2;
 
+	//  zero the buf
+	memset(buf, 0, 2 * len * sizeof(int16));
+
+	// Only happens while a caller applies a full command queue
+	if (!Common::compareAndSwap(&_mixing, 0, 1))
+		return 0;
+
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	applyCommands();
 
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
+				const uint32 finishedHandle = _channels[i]->getHandle()._val;
 				delete _channels[i];
 				_channels[i] = 0;
+
+				Common::memoryBarrier();
+				_finishedHandles[i] = finishedHandle;
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
+				publishChannelTime(i);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	Common::memoryBarrier();
+	_mixing = 0;
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
-	}
+
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_channelInfo[i].active && !_channelInfo[i].permanent)
+			postStop(i);
+
+	waitForMixing();
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
-	}
+
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_channelInfo[i].active && _channelInfo[i].id == id)
+			postStop(i);
+
+	waitForMixing();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	postStop(index);
+	waitForMixing();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandSoundType;
+	command.channel = 0;
+	command.value = type;
+	command.settings = _soundTypeSettings[type];
+	postCommand(command);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -350,37 +519,55 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelInfo[index].volume = volume;
+
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandVolume;
+	command.handle = handle;
+	command.channel = 0;
+	command.value = volume;
+	postCommand(command);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_mutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelInfo[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelInfo[index].balance = balance;
+
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandBalance;
+	command.handle = handle;
+	command.channel = 0;
+	command.value = balance;
+	postCommand(command);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_mutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelInfo[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -390,27 +577,70 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Common::Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Common::Timestamp(0, _sampleRate);
+	Common::Timestamp ts(0, _sampleRate);
+
+	const int index = findChannel(handle);
+	if (index == -1)
+		return ts;
+
+	const ChannelTime &time = _channelTimes[index];
+	uint32 sequence, timeHandle, samplesConsumed, mixerTimeStamp, pauseStartTime, pauseTime;
+	bool paused;
+
+	do {
+		sequence = time.sequence;
+		Common::memoryBarrier();
+		timeHandle = time.handle;
+		samplesConsumed = time.samplesConsumed;
+		mixerTimeStamp = time.mixerTimeStamp;
+		pauseStartTime = time.pauseStartTime;
+		pauseTime = time.pauseTime;
+		paused = time.paused;
+		Common::memoryBarrier();
+	} while ((sequence & 1) || sequence != time.sequence);
+
+	// The mixing did not pick up the sound yet
+	if (timeHandle != handle._val || mixerTimeStamp == 0)
+		return ts;
+
+	uint32 delta;
+	if (paused)
+		delta = pauseStartTime - mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - mixerTimeStamp - pauseTime;
+
+	// Convert the number of samples into a time duration.
 
-	return _channels[index]->getElapsedTime();
+	ts = ts.addFrames(samplesConsumed);
+	ts = ts.addMsecs(delta);
+
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
-		}
-	}
+
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandPauseAll;
+	command.channel = 0;
+	command.value = paused;
+	postCommand(command);
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
+
+	updateFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+		if (_channelInfo[i].active && _channelInfo[i].id == id) {
+			pauseHandle(_channelInfo[i].handle, paused);
 			return;
 		}
 	}
@@ -420,41 +650,51 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannel(handle) == -1)
 		return;
 
-	_channels[index]->pause(paused);
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandPause;
+	command.handle = handle;
+	command.channel = 0;
+	command.value = paused;
+	postCommand(command);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
 
+	updateFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_channelInfo[i].active && _channelInfo[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+
+	const int index = findChannel(handle);
+	if (index == -1)
+		return 0;
+
+	return _channelInfo[index].id;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannel(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+
+	updateFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channelInfo[i].active && _channelInfo[i].type == type)
 			return true;
 	return false;
 }
@@ -474,10 +714,12 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	ChannelCommand command;
+	command.type = ChannelCommand::kCommandSoundType;
+	command.channel = 0;
+	command.value = type;
+	command.settings = _soundTypeSettings[type];
+	postCommand(command);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -491,16 +733,17 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark --- Channel implementations ---
 #pragma mark -
 
-Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, int id, bool permanent)
-    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+Channel::Channel(MixerImpl *mixer, Mixer::SoundType type, AudioStream *stream,
+                 DisposeAfterUse::Flag autofreeStream, byte volume, int8 balance)
+    : _type(type), _mixer(mixer), _volume(volume),
+      _balance(balance), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
-	// Get a rate converter instance
+	// Get a rate converter instance. The volumes are only computed once
+	// the mixing picks up the channel.
 	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo());
 }
 
@@ -535,21 +778,17 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
+	int vol = _mixer->getMixVolumeForSoundType(_type) * _volume;
 
-		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
-		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
-		}
+	if (_balance == 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = vol / Mixer::kMaxChannelVolume;
+	} else if (_balance < 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 	} else {
-		_volL = _volR = 0;
+		_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+		_volR = vol / Mixer::kMaxChannelVolume;
 	}
 }
 
@@ -571,32 +810,12 @@ void Channel::pause(bool paused) {
 	}
 }
 
-Common::Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Common::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
+void Channel::getTime(ChannelTime &time) const {
+	time.samplesConsumed = _samplesConsumed;
+	time.mixerTimeStamp = _mixerTimeStamp;
+	time.pauseStartTime = _pauseStartTime;
+	time.pauseTime = _pauseTime;
+	time.paused = isPaused();
 }
 
 int Channel::mix(int16 *data, uint len) {
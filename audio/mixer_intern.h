@@ -31,6 +31,23 @@
 
 namespace Audio {
 
+/**
+ * The playback position of a channel, used to compute its elapsed time.
+ */
+struct ChannelTime {
+	ChannelTime() : sequence(0), handle(0xFFFFFFFF), samplesConsumed(0), mixerTimeStamp(0), pauseStartTime(0), pauseTime(0), paused(false) {}
+
+	/** Odd while the time is being written, see MixerImpl::publishChannelTime() */
+	volatile uint32 sequence;
+
+	uint32 handle;
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
@@ -53,15 +70,10 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 256 // Has to be a power of two
 	};
 
-	Common::Mutex _mutex;
-
-	const uint _sampleRate;
-	bool _mixerReady;
-	uint32 _handleSeed;
-
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
@@ -69,9 +81,91 @@ private:
 		int volume;
 	};
 
+	/**
+	 * A change to the channels, which is applied at the start of the next
+	 * mixCallback() call, so that changing them never has to wait for the
+	 * mixing to finish.
+	 */
+	struct ChannelCommand {
+		enum Type {
+			kCommandPlay,
+			kCommandStop,
+			kCommandPause,
+			kCommandPauseAll,
+			kCommandVolume,
+			kCommandBalance,
+			kCommandSoundType
+		};
+
+		Type type;
+		SoundHandle handle;
+		Channel *channel;            ///< The new channel for kCommandPlay
+		int value;                   ///< The new volume, balance or pause state, or the sound type
+		SoundTypeSettings settings;  ///< The new settings for kCommandSoundType
+	};
+
+	/**
+	 * What the callers of the mixer know about a channel. These are only
+	 * used under _mutex, and never by the mixing.
+	 */
+	struct ChannelInfo {
+		ChannelInfo() : active(false), id(-1), type(kPlainSoundType), permanent(false), volume(kMaxChannelVolume), balance(0) {}
+
+		bool active;
+		SoundHandle handle;
+		int id;
+		SoundType type;
+		bool permanent;
+		byte volume;
+		int8 balance;
+	};
+
+	/**
+	 * Serializes the callers of the mixer, which may be the engine and
+	 * timer threads. mixCallback() never takes it.
+	 */
+	Common::Mutex _mutex;
+
+	/**
+	 * @name The command queue
+	 * A ring buffer with one producer (the callers, under _mutex) and one
+	 * consumer (mixCallback()). Only the producer advances the tail, and
+	 * only the consumer advances the head, so neither needs a lock.
+	 */
+	//@{
+	ChannelCommand _commands[COMMAND_QUEUE_SIZE];
+	volatile uint32 _commandHead;
+	volatile uint32 _commandTail;
+	//@}
+
+	/**
+	 * Set while the commands are applied or the channels are mixed. Usually
+	 * by mixCallback(), but when the queue is full and the mixer is not
+	 * running, the producer takes it to apply the commands itself.
+	 */
+	volatile int32 _mixing;
+
+	const uint _sampleRate;
+	bool _mixerReady;
+	uint32 _handleSeed;
+
+	/** The settings as seen by the callers */
 	SoundTypeSettings _soundTypeSettings[4];
+	ChannelInfo _channelInfo[NUM_CHANNELS];
+
+	/** The settings and channels used for mixing */
+	SoundTypeSettings _mixSoundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * @name Published by the mixing for the callers
+	 * The handle of the last sound in each channel which ended by itself,
+	 * and the playback times.
+	 */
+	//@{
+	volatile uint32 _finishedHandles[NUM_CHANNELS];
+	ChannelTime _channelTimes[NUM_CHANNELS];
+	//@}
 
 public:
 
@@ -119,8 +213,49 @@ public:
 
 	virtual uint getOutputRate() const;
 
-protected:
-	void insertChannel(SoundHandle *handle, Channel *chan);
+	/**
+	 * Return the effective volume of a sound type while mixing, which is
+	 * 0 if it is muted. Used by the channels.
+	 */
+	int getMixVolumeForSoundType(SoundType type) const;
+
+private:
+	/**
+	 * Return the index of the channel for the given handle, or -1 if the
+	 * sound already ended. _mutex must be held.
+	 */
+	int findChannel(SoundHandle handle);
+
+	/**
+	 * Mark the channels of sounds which ended by themselves as free.
+	 * _mutex must be held.
+	 */
+	void updateFinishedChannels();
+
+	/**
+	 * Queue a command for the mixing. If the queue is full, this waits
+	 * for the mixing to catch up. _mutex must be held.
+	 */
+	void postCommand(const ChannelCommand &command);
+
+	/**
+	 * Stop the sound in a channel, and forget about it. _mutex must be held.
+	 */
+	void postStop(int index);
+
+	/**
+	 * Wait until no channel is being mixed, so that the mixing sees the
+	 * commands posted so far before it touches any channel again.
+	 */
+	void waitForMixing();
+
+	/**
+	 * Apply all queued commands. Only called while holding _mixing.
+	 */
+	void applyCommands();
+
+	/** Make the playback time of a channel available to the callers */
+	void publishChannelTime(int index);
 
 public:
 	/**
@@ -37,6 +37,18 @@
 #include "common/textconsole.h"
 #include "common/util.h"
 
+// SSE2 is always available on x86-64 and NEON is always available on
+// AArch64; on other CPUs, the compiler has to be told to use them.
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_RATE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define USE_RATE_NEON
+#endif
+#endif
+
 namespace Audio {
 
 
@@ -59,6 +71,94 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Mix a block of sample frames into the output buffer, applying the volume
+ * and clamping the result like clampedAdd() does. The input holds one
+ * sample per frame for mono and two for stereo; the output is always stereo.
+ */
+template<bool stereo>
+static void mixSamples(st_sample_t *obuf, const st_sample_t *samples, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+#if defined(USE_RATE_SSE2)
+	// The volume is at most kMaxMixerVolume, so it fits in a signed
+	// 16-bit value. Handle four frames at a time.
+	__m128i vol = _mm_set1_epi32(vol_l | (vol_r << 16));
+	__m128i round = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	for (; frames >= 4; frames -= 4) {
+		__m128i in;
+
+		if (stereo) {
+			in = _mm_loadu_si128((const __m128i *)samples);
+			samples += 8;
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)samples);
+			in = _mm_unpacklo_epi16(in, in);
+			samples += 4;
+		}
+
+		__m128i low = _mm_mullo_epi16(in, vol);
+		__m128i high = _mm_mulhi_epi16(in, vol);
+		__m128i out0 = _mm_unpacklo_epi16(low, high);
+		__m128i out1 = _mm_unpackhi_epi16(low, high);
+
+		// Divide by kMaxMixerVolume, rounding towards zero like the
+		// integer division in the generic code
+		out0 = _mm_srai_epi32(_mm_add_epi32(out0, _mm_and_si128(_mm_srai_epi32(out0, 31), round)), 8);
+		out1 = _mm_srai_epi32(_mm_add_epi32(out1, _mm_and_si128(_mm_srai_epi32(out1, 31), round)), 8);
+
+		__m128i out = _mm_adds_epi16(_mm_loadu_si128((const __m128i *)obuf), _mm_packs_epi32(out0, out1));
+		_mm_storeu_si128((__m128i *)obuf, out);
+		obuf += 8;
+	}
+#elif defined(USE_RATE_NEON)
+	// Handle four frames at a time
+	int16x4_t vol = vreinterpret_s16_u32(vdup_n_u32(vol_l | (vol_r << 16)));
+	int32x4_t round = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	for (; frames >= 4; frames -= 4) {
+		int16x4_t in0, in1;
+
+		if (stereo) {
+			in0 = vld1_s16(samples);
+			in1 = vld1_s16(samples + 4);
+			samples += 8;
+		} else {
+			int16x4_t in = vld1_s16(samples);
+			int16x4x2_t zipped = vzip_s16(in, in);
+			in0 = zipped.val[0];
+			in1 = zipped.val[1];
+			samples += 4;
+		}
+
+		int32x4_t out0 = vmull_s16(in0, vol);
+		int32x4_t out1 = vmull_s16(in1, vol);
+
+		// Divide by kMaxMixerVolume, rounding towards zero like the
+		// integer division in the generic code
+		out0 = vshrq_n_s32(vaddq_s32(out0, vandq_s32(vshrq_n_s32(out0, 31), round)), 8);
+		out1 = vshrq_n_s32(vaddq_s32(out1, vandq_s32(vshrq_n_s32(out1, 31), round)), 8);
+
+		int16x8_t out = vcombine_s16(vqmovn_s32(out0), vqmovn_s32(out1));
+		vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), out));
+		obuf += 8;
+	}
+#endif
+
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *samples++;
+		out1 = (stereo ? *samples++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -72,6 +172,9 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled frames waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -121,37 +224,39 @@ int SimpleRateConverter<stereo>::flow(AudioStream &input, st_sample_t *obuf, st_
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Resample a block of frames, then mix them all at once
+		st_size_t blockFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *outPtr = outBuf;
+
+		for (st_size_t frames = 0; frames < blockFrames; frames++) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						mixSamples<stereo>(obuf, outBuf, frames, vol_l, vol_r);
+						return (obuf - ostart) / 2 + frames;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			*outPtr++ = *inPtr++;
+			if (stereo)
+				*outPtr++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-		// output right channel
-		clampedAdd(obuf[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		obuf += 2;
+		mixSamples<stereo>(obuf, outBuf, blockFrames, vol_l, vol_r);
+		obuf += blockFrames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -185,6 +290,9 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated frames waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -230,47 +338,50 @@ int LinearRateConverter<stereo>::flow(AudioStream &input, st_sample_t *obuf, st_
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+		// Interpolate a block of frames, then mix them all at once
+		st_size_t blockFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_size_t frames = 0;
+		st_sample_t *outPtr = outBuf;
+
+		while (frames < blockFrames) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						mixSamples<stereo>(obuf, outBuf, frames, vol_l, vol_r);
+						return (obuf - ostart) / 2 + frames;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-			// output right channel
-			clampedAdd(obuf[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the block.
+			while (opos < (frac_t)FRAC_ONE_LOW && frames < blockFrames) {
+				// interpolate
+				*outPtr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*outPtr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-			obuf += 2;
+				frames++;
 
-			// Increment output position
-			opos += opos_inc;
+				// Increment output position
+				opos += opos_inc;
+			}
 		}
+
+		mixSamples<stereo>(obuf, outBuf, blockFrames, vol_l, vol_r);
+		obuf += blockFrames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -295,7 +406,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
 		st_sample_t *ostart = obuf;
@@ -317,20 +427,10 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		len /= (stereo ? 2 : 1);
+		mixSamples<stereo>(obuf, _buffer, len, vol_l, vol_r);
+		obuf += len * 2;
 
-			// output left channel
-			clampedAdd(obuf[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
 		return (obuf - ostart) / 2;
 	}
 
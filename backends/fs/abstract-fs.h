@@ -63,6 +63,18 @@ protected:
 	 */
 	virtual AbstractFSNode *getChild(const Common::String &name) const = 0;
 
+	/**
+	 * Returns the child node with the given name, which is known to exist and
+	 * to be of the given type, e.g. because of an earlier directory listing.
+	 * Implementations can use this to avoid querying the file system.
+	 *
+	 * @note By default, this method returns getChild(name).
+	 *
+	 * @param name        String containing the name of the child.
+	 * @param isDirectory Whether the child is a directory.
+	 */
+	virtual AbstractFSNode *getKnownChild(const Common::String &name, bool isDirectory) const { return getChild(name); }
+
 	/**
 	 * The parent node of this directory.
 	 * The parent of the root is the root itself.
@@ -159,6 +171,22 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the time the object was last modified, in seconds since an
+	 * unspecified epoch. Only comparisons of the value are meaningful.
+	 *
+	 * @note By default, this method returns 0, meaning that the time is unknown.
+	 */
+	virtual uint32 getModificationTime() const { return 0; }
+
+	/**
+	 * Returns the size of the file referred by this node, without opening
+	 * it.
+	 *
+	 * @note By default, this method returns -1, meaning that the size is unknown.
+	 */
+	virtual int32 getFileSize() const { return -1; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -169,6 +197,16 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Creates a SeekableReadStream instance for the file referred by this
+	 * node, which keeps the data of the file in memory, e.g. by mapping it.
+	 *
+	 * @note By default, this method returns createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -177,6 +215,17 @@ public:
 	 * @return pointer to the stream object, 0 in case of a failure
 	 */
 	virtual Common::WriteStream *createWriteStream() = 0;
+
+	/**
+	 * Hints that a part of the file referred by this node is going to be
+	 * read soon, so that it can be read in the background beforehand.
+	 *
+	 * @note By default, this method does nothing.
+	 *
+	 * @param offset the start of the part of the file
+	 * @param size   the size of the part of the file, 0 for up to its end
+	 */
+	virtual void prefetch(uint32 offset, uint32 size) {}
 };
 
 
@@ -25,12 +25,14 @@
 #if defined(POSIX) || defined(PLAYSTATION3)
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mapped-stream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
 
 #ifdef __OS2__
@@ -46,6 +48,24 @@ void POSIXFilesystemNode::setFlags() {
 	_isDirectory = _isValid ? S_ISDIR(st.st_mode) : false;
 }
 
+uint32 POSIXFilesystemNode::getModificationTime() const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0)
+		return 0;
+
+	return (uint32)st.st_mtime;
+}
+
+int32 POSIXFilesystemNode::getFileSize() const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return -1;
+
+	return (int32)st.st_size;
+}
+
 POSIXFilesystemNode::POSIXFilesystemNode(const Common::String &p) {
 	assert(p.size() > 0);
 
@@ -109,6 +129,23 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+AbstractFSNode *POSIXFilesystemNode::getKnownChild(const Common::String &n, bool isDirectory) const {
+	assert(!_path.empty());
+	assert(_isDirectory);
+	assert(!n.contains('/'));
+
+	// Like getChildren(), start with a clone of this node instead of calling stat()
+	POSIXFilesystemNode *child = new POSIXFilesystemNode(*this);
+	child->_displayName = n;
+	if (_path.lastChar() != '/')
+		child->_path += '/';
+	child->_path += n;
+	child->_isDirectory = isDirectory;
+	child->_isValid = true;
+
+	return child;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -241,8 +278,29 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+	Common::SeekableReadStream *stream = POSIXMappedStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return StdioStream::makeFromPath(getPath(), true);
 }
 
+void POSIXFilesystemNode::prefetch(uint32 offset, uint32 size) {
+#ifdef POSIX_FADV_WILLNEED
+	// The kernel reads the data into the page cache asynchronously, and keeps
+	// it there after the descriptor is closed
+	const int fd = open(_path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return;
+
+	posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED);
+	close(fd);
+#endif
+}
+
 #endif //#if defined(POSIX)
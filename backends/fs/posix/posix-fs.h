@@ -66,12 +66,17 @@ public:
 	virtual bool isDirectory() const { return _isDirectory; }
 	virtual bool isReadable() const { return access(_path.c_str(), R_OK) == 0; }
 	virtual bool isWritable() const { return access(_path.c_str(), W_OK) == 0; }
+	virtual uint32 getModificationTime() const;
+	virtual int32 getFileSize() const;
+	virtual void prefetch(uint32 offset, uint32 size);
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const;
+	virtual AbstractFSNode *getKnownChild(const Common::String &n, bool isDirectory) const;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const;
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createMappedReadStream();
 	virtual Common::WriteStream *createWriteStream();
 
 private:
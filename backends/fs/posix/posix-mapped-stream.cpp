@@ -0,0 +1,77 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) || defined(PLAYSTATION3)
+
+#include "backends/fs/posix/posix-mapped-stream.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Files smaller than this are read through stdio. Copying their data is
+ * cheap, and a mapping uses at least a whole page.
+ */
+static const off_t kMinMappedSize = 64 * 1024;
+
+/**
+ * Files larger than this are read through stdio, so that a few large files
+ * can not use up the address space on 32-bit systems.
+ */
+static const off_t kMaxMappedSize = (sizeof(void *) > 4) ? 0x40000000 : 0x4000000;
+
+POSIXMappedStream::POSIXMappedStream(void *mapping, uint32 size)
+	: Common::MemoryReadStream((const byte *)mapping, size), _mapping(mapping), _mappingSize(size) {
+}
+
+POSIXMappedStream::~POSIXMappedStream() {
+	munmap(_mapping, _mappingSize);
+}
+
+POSIXMappedStream *POSIXMappedStream::makeFromPath(const Common::String &path) {
+#ifdef _POSIX_MAPPED_FILES
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return 0;
+
+	struct stat st;
+	void *mapping = MAP_FAILED;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= kMinMappedSize && st.st_size <= kMaxMappedSize)
+		mapping = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid without the descriptor
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	return new POSIXMappedStream(mapping, st.st_size);
+#else
+	return 0;
+#endif
+}
+
+#endif
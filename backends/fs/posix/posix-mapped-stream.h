@@ -0,0 +1,56 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MAPPED_STREAM_H
+#define BACKENDS_FS_POSIX_MAPPED_STREAM_H
+
+#include "common/memstream.h"
+#include "common/str.h"
+
+/**
+ * A read stream for a file which is mapped into memory, so that reading it
+ * does not need any system calls, and the data can be used in place through
+ * getDataPtr().
+ *
+ * The file must not be truncated while it is mapped.
+ */
+class POSIXMappedStream : public Common::MemoryReadStream {
+public:
+	/**
+	 * Map the file with the given path into memory, and wrap the mapping in
+	 * a POSIXMappedStream instance.
+	 *
+	 * @return the stream, or 0 if the file is not mapped, e.g. because it
+	 *         is small, too large, or on a file system without mmap support
+	 */
+	static POSIXMappedStream *makeFromPath(const Common::String &path);
+
+	~POSIXMappedStream();
+
+private:
+	POSIXMappedStream(void *mapping, uint32 size);
+
+	void *_mapping;
+	uint32 _mappingSize;
+};
+
+#endif
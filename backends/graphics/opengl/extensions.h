@@ -25,6 +25,12 @@
 
 namespace OpenGL {
 
+/**
+ * Look up the address of an OpenGL function of the current context, like
+ * SDL_GL_GetProcAddress does.
+ */
+typedef void *(*ProcAddressLookup)(const char *name);
+
 /**
  * Checks for availability of extensions we want to use and initializes them
  * when available.
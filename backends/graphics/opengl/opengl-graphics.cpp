@@ -26,6 +26,7 @@
 #include "backends/graphics/opengl/texture.h"
 #include "backends/graphics/opengl/debug.h"
 #include "backends/graphics/opengl/extensions.h"
+#include "backends/graphics/opengl/shader.h"
 
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -48,7 +49,11 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
     : _currentState(), _oldState(), _transactionMode(kTransactionNone), _screenChangeID(1 << (sizeof(int) * 8 - 2)),
       _outputScreenWidth(0), _outputScreenHeight(0), _displayX(0), _displayY(0),
       _displayWidth(0), _displayHeight(0), _defaultFormat(), _defaultFormatAlpha(),
-      _gameScreen(nullptr), _gameScreenShakeOffset(0), _overlay(nullptr),
+      _gameScreen(nullptr), _gameScreenShakeOffset(0),
+#ifdef USE_GLSL_SCALERS
+      _shadersSupported(false), _scalerShader(nullptr), _scalerShaderMode(GFX_LINEAR),
+#endif
+      _overlay(nullptr),
       _overlayVisible(false), _cursor(nullptr),
       _cursorX(0), _cursorY(0), _cursorDisplayX(0),_cursorDisplayY(0), _cursorHotspotX(0), _cursorHotspotY(0),
       _cursorHotspotXScaled(0), _cursorHotspotYScaled(0), _cursorWidthScaled(0), _cursorHeightScaled(0),
@@ -68,6 +73,9 @@ OpenGLGraphicsManager::~OpenGLGraphicsManager() {
 #ifdef USE_OSD
 	delete _osd;
 #endif
+#ifdef USE_GLSL_SCALERS
+	delete _scalerShader;
+#endif
 }
 
 bool OpenGLGraphicsManager::hasFeature(OSystem::Feature f) {
@@ -119,6 +127,12 @@ namespace {
 const OSystem::GraphicsMode glGraphicsModes[] = {
 	{ "opengl_linear",  _s("OpenGL"),                GFX_LINEAR  },
 	{ "opengl_nearest", _s("OpenGL (No filtering)"), GFX_NEAREST },
+#ifdef USE_GLSL_SCALERS
+	{ "opengl_advmame2x", _s("OpenGL AdvMAME2x"), GFX_SHADER_ADVMAME2X },
+	{ "opengl_advmame3x", _s("OpenGL AdvMAME3x"), GFX_SHADER_ADVMAME3X },
+	{ "opengl_hq2x", _s("OpenGL HQ2x"), GFX_SHADER_HQ2X },
+	{ "opengl_tv2x", _s("OpenGL TV2x"), GFX_SHADER_TV2X },
+#endif
 	{ nullptr, nullptr, 0 }
 };
 
@@ -138,6 +152,14 @@ bool OpenGLGraphicsManager::setGraphicsMode(int mode) {
 	switch (mode) {
 	case GFX_LINEAR:
 	case GFX_NEAREST:
+#ifdef USE_GLSL_SCALERS
+	// The shaders look up the source pixels themselves, which only works
+	// without filtering.
+	case GFX_SHADER_ADVMAME2X:
+	case GFX_SHADER_ADVMAME3X:
+	case GFX_SHADER_HQ2X:
+	case GFX_SHADER_TV2X:
+#endif
 		_currentState.graphicsMode = mode;
 
 		if (_gameScreen) {
@@ -364,8 +386,22 @@ void OpenGLGraphicsManager::updateScreen() {
 	const GLfloat shakeOffset = _gameScreenShakeOffset * (GLfloat)_displayHeight / _gameScreen->getHeight();
 
 	// First step: Draw the (virtual) game screen.
+#ifdef USE_GLSL_SCALERS
+	Shader *shader = getScalerShader();
+	if (shader && !shader->activate(*_gameScreen)) {
+		// Fall back to no filtering, without trying to compile it again.
+		shader = nullptr;
+	}
+#endif
+
 	_gameScreen->draw(_displayX, _displayY + shakeOffset, _displayWidth, _displayHeight);
 
+#ifdef USE_GLSL_SCALERS
+	if (shader) {
+		Shader::deactivate();
+	}
+#endif
+
 	// Second step: Draw the overlay if visible.
 	if (_overlayVisible) {
 		_overlay->draw(0, 0, _outputScreenWidth, _outputScreenHeight);
@@ -816,6 +852,9 @@ void OpenGLGraphicsManager::setActualScreenSize(uint width, uint height) {
 void OpenGLGraphicsManager::notifyContextCreate(const Graphics::PixelFormat &defaultFormat, const Graphics::PixelFormat &defaultFormatAlpha) {
 	// Initialize all extensions.
 	initializeGLExtensions();
+#ifdef USE_GLSL_SCALERS
+	_shadersSupported = initializeShaderFunctions(getProcAddressLookup());
+#endif
 
 	// Disable 3D properties.
 	GLCALL(glDisable(GL_CULL_FACE));
@@ -889,6 +928,12 @@ void OpenGLGraphicsManager::notifyContextCreate(const Graphics::PixelFormat &def
 }
 
 void OpenGLGraphicsManager::notifyContextDestroy() {
+#ifdef USE_GLSL_SCALERS
+	if (_scalerShader) {
+		_scalerShader->releaseInternalProgram();
+	}
+#endif
+
 	if (_gameScreen) {
 		_gameScreen->releaseInternalTexture();
 	}
@@ -908,6 +953,22 @@ void OpenGLGraphicsManager::notifyContextDestroy() {
 #endif
 }
 
+#ifdef USE_GLSL_SCALERS
+Shader *OpenGLGraphicsManager::getScalerShader() {
+	if (_scalerShaderMode != _currentState.graphicsMode) {
+		delete _scalerShader;
+		_scalerShader = createScalerShader(_currentState.graphicsMode);
+		_scalerShaderMode = _currentState.graphicsMode;
+
+		if (_scalerShader && !_shadersSupported) {
+			warning("OpenGL: Shaders are not supported, the graphics mode is used without scaler");
+		}
+	}
+
+	return _shadersSupported ? _scalerShader : nullptr;
+}
+#endif
+
 void OpenGLGraphicsManager::adjustMousePosition(int16 &x, int16 &y) {
 	if (_overlayVisible) {
 		// It might be confusing that we actually have to handle something
@@ -26,6 +26,7 @@
 #define BACKENDS_GRAPHICS_OPENGL_OPENGL_GRAPHICS_H
 
 #include "backends/graphics/opengl/opengl-sys.h"
+#include "backends/graphics/opengl/extensions.h"
 #include "backends/graphics/graphics.h"
 
 #include "common/frac.h"
@@ -43,10 +44,17 @@ namespace OpenGL {
 #define USE_OSD 1
 
 class Texture;
+#ifdef USE_GLSL_SCALERS
+class Shader;
+#endif
 
 enum {
 	GFX_LINEAR = 0,
-	GFX_NEAREST = 1
+	GFX_NEAREST = 1,
+	GFX_SHADER_ADVMAME2X = 2,
+	GFX_SHADER_ADVMAME3X = 3,
+	GFX_SHADER_HQ2X = 4,
+	GFX_SHADER_TV2X = 5
 };
 
 class OpenGLGraphicsManager : virtual public GraphicsManager {
@@ -170,6 +178,14 @@ protected:
 	 */
 	virtual void setInternalMousePosition(int x, int y) = 0;
 
+	/**
+	 * Query the function looking up OpenGL functions of the context, which
+	 * is needed for the shader based graphics modes.
+	 *
+	 * @return The lookup function or nullptr when it is not available.
+	 */
+	virtual ProcAddressLookup getProcAddressLookup() const { return nullptr; }
+
 private:
 	/**
 	 * Create a texture with the specified pixel format.
@@ -353,6 +369,30 @@ private:
 	 */
 	int _gameScreenShakeOffset;
 
+#ifdef USE_GLSL_SCALERS
+	/**
+	 * Whether the context supports GLSL shaders.
+	 */
+	bool _shadersSupported;
+
+	/**
+	 * The shader of the current graphics mode, or nullptr if it has none.
+	 */
+	Shader *_scalerShader;
+
+	/**
+	 * The graphics mode _scalerShader was created for.
+	 */
+	int _scalerShaderMode;
+
+	/**
+	 * Query the shader the game screen has to be drawn with.
+	 *
+	 * @return The shader or nullptr if the game screen is drawn without one.
+	 */
+	Shader *getScalerShader();
+#endif
+
 	//
 	// Overlay
 	//
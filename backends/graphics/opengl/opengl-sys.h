@@ -54,4 +54,9 @@ using namespace Tizen::Graphics::Opengl;
 #include <GL/gl.h>
 #endif
 
+// The scalers need GLSL shaders, which OpenGL ES 1.x does not have.
+#if !defined(USE_GLES) && !defined(TIZEN)
+#define USE_GLSL_SCALERS 1
+#endif
+
 #endif
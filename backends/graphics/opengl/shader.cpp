@@ -0,0 +1,365 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/graphics/opengl/shader.h"
+
+#ifdef USE_GLSL_SCALERS
+
+#include "backends/graphics/opengl/opengl-graphics.h"
+#include "backends/graphics/opengl/texture.h"
+#include "backends/graphics/opengl/debug.h"
+
+#include "common/textconsole.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// Older OpenGL headers (like the one of Windows) only cover OpenGL 1.1.
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+
+namespace OpenGL {
+
+namespace {
+
+struct ShaderFunctions {
+	GLuint (APIENTRY *createShader)(GLenum type);
+	void (APIENTRY *shaderSource)(GLuint shader, GLsizei count, const char **string, const GLint *length);
+	void (APIENTRY *compileShader)(GLuint shader);
+	void (APIENTRY *getShaderiv)(GLuint shader, GLenum pname, GLint *params);
+	void (APIENTRY *getShaderInfoLog)(GLuint shader, GLsizei bufSize, GLsizei *length, char *infoLog);
+	void (APIENTRY *deleteShader)(GLuint shader);
+	GLuint (APIENTRY *createProgram)();
+	void (APIENTRY *attachShader)(GLuint program, GLuint shader);
+	void (APIENTRY *linkProgram)(GLuint program);
+	void (APIENTRY *getProgramiv)(GLuint program, GLenum pname, GLint *params);
+	void (APIENTRY *getProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei *length, char *infoLog);
+	void (APIENTRY *deleteProgram)(GLuint program);
+	void (APIENTRY *useProgram)(GLuint program);
+	GLint (APIENTRY *getUniformLocation)(GLuint program, const char *name);
+	void (APIENTRY *uniform1i)(GLint location, GLint v0);
+	void (APIENTRY *uniform2f)(GLint location, GLfloat v0, GLfloat v1);
+};
+
+ShaderFunctions g_shaderFunctions;
+
+template<typename T>
+bool lookUpFunction(ProcAddressLookup lookup, T &function, const char *name) {
+	// Casting between object and function pointers is not allowed in ISO
+	// C++, but every platform with OpenGL supports it
+	void *address = lookup(name);
+	memcpy(&function, &address, sizeof(function));
+	return address != nullptr;
+}
+
+} // End of anonymous namespace
+
+bool initializeShaderFunctions(ProcAddressLookup lookup) {
+	memset(&g_shaderFunctions, 0, sizeof(g_shaderFunctions));
+	if (!lookup) {
+		return false;
+	}
+
+	// The functions can be looked up even for contexts which do not support
+	// them, so the version has to be checked first.
+	const char *version = (const char *)glGetString(GL_VERSION);
+	if (!version || version[0] < '2' || version[0] > '9' || version[1] != '.') {
+		debug(5, "OpenGL: No shader support in version %s", version ? version : "(unknown)");
+		return false;
+	}
+
+	ShaderFunctions &f = g_shaderFunctions;
+	bool found = true;
+	found &= lookUpFunction(lookup, f.createShader, "glCreateShader");
+	found &= lookUpFunction(lookup, f.shaderSource, "glShaderSource");
+	found &= lookUpFunction(lookup, f.compileShader, "glCompileShader");
+	found &= lookUpFunction(lookup, f.getShaderiv, "glGetShaderiv");
+	found &= lookUpFunction(lookup, f.getShaderInfoLog, "glGetShaderInfoLog");
+	found &= lookUpFunction(lookup, f.deleteShader, "glDeleteShader");
+	found &= lookUpFunction(lookup, f.createProgram, "glCreateProgram");
+	found &= lookUpFunction(lookup, f.attachShader, "glAttachShader");
+	found &= lookUpFunction(lookup, f.linkProgram, "glLinkProgram");
+	found &= lookUpFunction(lookup, f.getProgramiv, "glGetProgramiv");
+	found &= lookUpFunction(lookup, f.getProgramInfoLog, "glGetProgramInfoLog");
+	found &= lookUpFunction(lookup, f.deleteProgram, "glDeleteProgram");
+	found &= lookUpFunction(lookup, f.useProgram, "glUseProgram");
+	found &= lookUpFunction(lookup, f.getUniformLocation, "glGetUniformLocation");
+	found &= lookUpFunction(lookup, f.uniform1i, "glUniform1i");
+	found &= lookUpFunction(lookup, f.uniform2f, "glUniform2f");
+
+	if (!found) {
+		memset(&g_shaderFunctions, 0, sizeof(g_shaderFunctions));
+		return false;
+	}
+
+	return true;
+}
+
+Shader::Shader(const char *name, const char *fragment)
+    : _name(name), _fragment(fragment), _program(0), _textureSizeLocation(-1), _inputSizeLocation(-1), _failed(false) {
+}
+
+Shader::~Shader() {
+	if (_program) {
+		GLCALL(g_shaderFunctions.deleteProgram(_program));
+	}
+}
+
+bool Shader::activate(const Texture &texture) {
+	if (!_program && !compile()) {
+		return false;
+	}
+
+	GLCALL(g_shaderFunctions.useProgram(_program));
+	GLCALL(g_shaderFunctions.uniform2f(_textureSizeLocation, texture.getTextureWidth(), texture.getTextureHeight()));
+	GLCALL(g_shaderFunctions.uniform2f(_inputSizeLocation, texture.getWidth(), texture.getHeight()));
+	return true;
+}
+
+void Shader::deactivate() {
+	GLCALL(g_shaderFunctions.useProgram(0));
+}
+
+namespace {
+
+// The scalers only need texture coordinates. The fixed function state set up
+// by OpenGLGraphicsManager is used for everything else.
+const char *const s_vertexShader =
+	"#version 110\n"
+	"varying vec2 texCoord;\n"
+	"void main() {\n"
+	"	texCoord = gl_MultiTexCoord0.xy;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+// Every scaler gets the texture, the size of the whole OpenGL texture, and
+// the size of the area used in it, in pixels. fetch() looks up a neighbour of
+// a source pixel, repeating the pixels at the edges of the area.
+const char *const s_fragmentHeader =
+	"#version 110\n"
+	"uniform sampler2D source;\n"
+	"uniform vec2 textureSize;\n"
+	"uniform vec2 inputSize;\n"
+	"varying vec2 texCoord;\n"
+	"vec4 fetch(vec2 pixel, float x, float y) {\n"
+	"	vec2 p = clamp(pixel + vec2(x, y), vec2(0.0), inputSize - 1.0);\n"
+	"	return texture2D(source, (p + 0.5) / textureSize);\n"
+	"}\n";
+
+// The Scale2x rules of AdvMame2x: each quarter of a pixel takes the color of
+// its two neighbours on that side when they are equal, unless the pixel is
+// part of a straight line.
+const char *const s_advMame2xShader =
+	"void main() {\n"
+	"	vec2 pos = texCoord * textureSize;\n"
+	"	vec2 pixel = min(floor(pos), inputSize - 1.0);\n"
+	"	vec2 sub = pos - pixel;\n"
+	"	vec4 B = fetch(pixel, 0.0, -1.0);\n"
+	"	vec4 D = fetch(pixel, -1.0, 0.0);\n"
+	"	vec4 E = fetch(pixel, 0.0, 0.0);\n"
+	"	vec4 F = fetch(pixel, 1.0, 0.0);\n"
+	"	vec4 H = fetch(pixel, 0.0, 1.0);\n"
+	"	vec4 X = sub.x < 0.5 ? D : F;\n"
+	"	vec4 Y = sub.y < 0.5 ? B : H;\n"
+	"	gl_FragColor = (B != H && D != F && X == Y) ? X : E;\n"
+	"}\n";
+
+// The Scale3x rules of AdvMame3x, for each ninth of a pixel.
+const char *const s_advMame3xShader =
+	"void main() {\n"
+	"	vec2 pos = texCoord * textureSize;\n"
+	"	vec2 pixel = min(floor(pos), inputSize - 1.0);\n"
+	"	vec2 cell = floor((pos - pixel) * 3.0);\n"
+	"	vec4 A = fetch(pixel, -1.0, -1.0);\n"
+	"	vec4 B = fetch(pixel, 0.0, -1.0);\n"
+	"	vec4 C = fetch(pixel, 1.0, -1.0);\n"
+	"	vec4 D = fetch(pixel, -1.0, 0.0);\n"
+	"	vec4 E = fetch(pixel, 0.0, 0.0);\n"
+	"	vec4 F = fetch(pixel, 1.0, 0.0);\n"
+	"	vec4 G = fetch(pixel, -1.0, 1.0);\n"
+	"	vec4 H = fetch(pixel, 0.0, 1.0);\n"
+	"	vec4 I = fetch(pixel, 1.0, 1.0);\n"
+	"	vec4 color = E;\n"
+	"	if (B != H && D != F) {\n"
+	"		if (cell.y < 0.5) {\n"
+	"			if (cell.x < 0.5)\n"
+	"				color = D == B ? D : E;\n"
+	"			else if (cell.x < 1.5)\n"
+	"				color = ((D == B && E != C) || (B == F && E != A)) ? B : E;\n"
+	"			else\n"
+	"				color = B == F ? F : E;\n"
+	"		} else if (cell.y < 1.5) {\n"
+	"			if (cell.x < 0.5)\n"
+	"				color = ((D == B && E != G) || (D == H && E != A)) ? D : E;\n"
+	"			else if (cell.x > 1.5)\n"
+	"				color = ((B == F && E != I) || (H == F && E != C)) ? F : E;\n"
+	"		} else {\n"
+	"			if (cell.x < 0.5)\n"
+	"				color = D == H ? D : E;\n"
+	"			else if (cell.x < 1.5)\n"
+	"				color = ((D == H && E != I) || (H == F && E != G)) ? H : E;\n"
+	"			else\n"
+	"				color = H == F ? F : E;\n"
+	"		}\n"
+	"	}\n"
+	"	gl_FragColor = color;\n"
+	"}\n";
+
+// An approximation of HQ2x without its lookup table. Pixels are compared with
+// the YUV thresholds of diffYUV(), and each quarter of a pixel is blended
+// with the neighbours on its side, where an edge passes by its corner.
+const char *const s_hq2xShader =
+	"bool similar(vec4 a, vec4 b) {\n"
+	"	vec3 d = a.rgb - b.rgb;\n"
+	"	vec3 yuv = vec3((d.r + d.g + d.b) / 4.0, (d.r - d.b) / 4.0, (2.0 * d.g - d.r - d.b) / 8.0);\n"
+	"	return all(lessThanEqual(abs(yuv), vec3(48.0, 7.0, 6.0) / 255.0));\n"
+	"}\n"
+	"void main() {\n"
+	"	vec2 pos = texCoord * textureSize;\n"
+	"	vec2 pixel = min(floor(pos), inputSize - 1.0);\n"
+	"	vec2 sub = pos - pixel;\n"
+	"	float dx = sub.x < 0.5 ? -1.0 : 1.0;\n"
+	"	float dy = sub.y < 0.5 ? -1.0 : 1.0;\n"
+	"	vec4 E = fetch(pixel, 0.0, 0.0);\n"
+	"	vec4 X = fetch(pixel, dx, 0.0);\n"
+	"	vec4 Y = fetch(pixel, 0.0, dy);\n"
+	"	vec4 Z = fetch(pixel, dx, dy);\n"
+	"	vec4 color = E;\n"
+	"	if (similar(X, Y) && !similar(E, X))\n"
+	"		color = (2.0 * E + X + Y) / 4.0;\n"
+	"	else if (similar(E, X) && similar(E, Y) && !similar(E, Z))\n"
+	"		color = (3.0 * E + Z) / 4.0;\n"
+	"	gl_FragColor = color;\n"
+	"}\n";
+
+// TV2x: every second line is darkened to 7/8 of the brightness.
+const char *const s_tv2xShader =
+	"void main() {\n"
+	"	vec2 pos = texCoord * textureSize;\n"
+	"	vec2 pixel = min(floor(pos), inputSize - 1.0);\n"
+	"	vec4 E = fetch(pixel, 0.0, 0.0);\n"
+	"	gl_FragColor = (pos.y - pixel.y < 0.5) ? E : vec4(E.rgb * 0.875, E.a);\n"
+	"}\n";
+
+} // End of anonymous namespace
+
+GLuint Shader::compileShader(GLenum type, const char *header, const char *body) {
+	const char *sources[2] = { header, body };
+
+	GLuint shader;
+	GLCALL(shader = g_shaderFunctions.createShader(type));
+	GLCALL(g_shaderFunctions.shaderSource(shader, 2, sources, nullptr));
+	GLCALL(g_shaderFunctions.compileShader(shader));
+
+	GLint status;
+	GLCALL(g_shaderFunctions.getShaderiv(shader, GL_COMPILE_STATUS, &status));
+	if (status != GL_TRUE) {
+		char log[512];
+		GLCALL(g_shaderFunctions.getShaderInfoLog(shader, sizeof(log), nullptr, log));
+		warning("Could not compile the %s shader: %s", _name, log);
+		GLCALL(g_shaderFunctions.deleteShader(shader));
+		return 0;
+	}
+
+	return shader;
+}
+
+bool Shader::compile() {
+	if (_failed || !g_shaderFunctions.createProgram) {
+		return false;
+	}
+
+	_failed = true;
+
+	const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, s_vertexShader, "");
+	if (!vertexShader) {
+		return false;
+	}
+
+	const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, s_fragmentHeader, _fragment);
+	if (!fragmentShader) {
+		GLCALL(g_shaderFunctions.deleteShader(vertexShader));
+		return false;
+	}
+
+	GLuint program;
+	GLCALL(program = g_shaderFunctions.createProgram());
+	GLCALL(g_shaderFunctions.attachShader(program, vertexShader));
+	GLCALL(g_shaderFunctions.attachShader(program, fragmentShader));
+	GLCALL(g_shaderFunctions.linkProgram(program));
+
+	// The shaders are freed along with the program.
+	GLCALL(g_shaderFunctions.deleteShader(vertexShader));
+	GLCALL(g_shaderFunctions.deleteShader(fragmentShader));
+
+	GLint status;
+	GLCALL(g_shaderFunctions.getProgramiv(program, GL_LINK_STATUS, &status));
+	if (status != GL_TRUE) {
+		char log[512];
+		GLCALL(g_shaderFunctions.getProgramInfoLog(program, sizeof(log), nullptr, log));
+		warning("Could not link the %s shader: %s", _name, log);
+		GLCALL(g_shaderFunctions.deleteProgram(program));
+		return false;
+	}
+
+	GLint sourceLocation;
+	GLCALL(sourceLocation = g_shaderFunctions.getUniformLocation(program, "source"));
+	GLCALL(_textureSizeLocation = g_shaderFunctions.getUniformLocation(program, "textureSize"));
+	GLCALL(_inputSizeLocation = g_shaderFunctions.getUniformLocation(program, "inputSize"));
+
+	GLCALL(g_shaderFunctions.useProgram(program));
+	GLCALL(g_shaderFunctions.uniform1i(sourceLocation, 0));
+	GLCALL(g_shaderFunctions.useProgram(0));
+
+	_program = program;
+	_failed = false;
+	return true;
+}
+
+Shader *createScalerShader(int mode) {
+	switch (mode) {
+	case GFX_SHADER_ADVMAME2X:
+		return new Shader("AdvMAME2x", s_advMame2xShader);
+
+	case GFX_SHADER_ADVMAME3X:
+		return new Shader("AdvMAME3x", s_advMame3xShader);
+
+	case GFX_SHADER_HQ2X:
+		return new Shader("HQ2x", s_hq2xShader);
+
+	case GFX_SHADER_TV2X:
+		return new Shader("TV2x", s_tv2xShader);
+
+	default:
+		return nullptr;
+	}
+}
+
+} // End of namespace OpenGL
+
+#endif
@@ -0,0 +1,104 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_OPENGL_SHADER_H
+#define BACKENDS_GRAPHICS_OPENGL_SHADER_H
+
+#include "backends/graphics/opengl/opengl-sys.h"
+#include "backends/graphics/opengl/extensions.h"
+
+#ifdef USE_GLSL_SCALERS
+
+namespace OpenGL {
+
+class Texture;
+
+/**
+ * Load the OpenGL 2.0 functions used for GLSL shaders. This has to be
+ * called whenever a new context was created.
+ *
+ * @param lookup The function to look up OpenGL functions with, or nullptr
+ *               if they cannot be looked up.
+ * @return Whether shaders can be used with the current context.
+ */
+bool initializeShaderFunctions(ProcAddressLookup lookup);
+
+/**
+ * A GLSL program which draws a texture through one of the scalers. The
+ * scaling is done for every output pixel, according to where it is within
+ * its source pixel, so it works for any display size.
+ */
+class Shader {
+public:
+	/**
+	 * Create the shader for a scaler.
+	 *
+	 * @param name     The name of the scaler, used in warnings.
+	 * @param fragment The source of the fragment shader.
+	 */
+	Shader(const char *name, const char *fragment);
+	~Shader();
+
+	/**
+	 * Forget the OpenGL program, because its context was destroyed. It is
+	 * compiled again the next time it is used.
+	 */
+	void releaseInternalProgram() { _program = 0; }
+
+	/**
+	 * Use the shader for drawing the given texture, compiling it first if
+	 * needed. The texture has to use nearest filtering.
+	 *
+	 * @return false if the shader cannot be compiled.
+	 */
+	bool activate(const Texture &texture);
+
+	/**
+	 * Go back to the fixed function pipeline.
+	 */
+	static void deactivate();
+
+private:
+	const char *_name;
+	const char *_fragment;
+
+	GLuint _program;
+	GLint _textureSizeLocation;
+	GLint _inputSizeLocation;
+
+	/** Whether compiling failed, so that it is not tried again */
+	bool _failed;
+
+	bool compile();
+	GLuint compileShader(GLenum type, const char *header, const char *body);
+};
+
+/**
+ * Create the shader for one of the GFX_SHADER_* graphics modes.
+ */
+Shader *createScalerShader(int mode);
+
+} // End of namespace OpenGL
+
+#endif
+
+#endif
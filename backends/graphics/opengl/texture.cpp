@@ -50,7 +50,7 @@ void Texture::queryTextureInformation() {
 
 Texture::Texture(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format)
     : _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType), _format(format), _glFilter(GL_NEAREST),
-      _glTexture(0), _textureData(), _userPixelData(), _allDirty(false) {
+      _glTexture(0), _textureData(), _userPixelData(), _allDirty(false), _dirtyAreaCount(0) {
 	recreateInternalTexture();
 }
 
@@ -133,15 +133,7 @@ void Texture::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= dstSurf->w);
 	assert(y + h <= dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
-	}
+	addDirtyArea(Common::Rect(x, y, x + w, y + h));
 
 	const byte *src = (const byte *)srcPtr;
 	byte *dst = (byte *)dstSurf->getBasePtr(x, y);
@@ -207,8 +199,19 @@ void Texture::updateTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	// Set the texture.
+	GLCALL(glBindTexture(GL_TEXTURE_2D, _glTexture));
+
+	const uint dirtyAreaCount = getDirtyAreaCount();
+	for (uint i = 0; i < dirtyAreaCount; ++i) {
+		updateArea(getDirtyArea(i));
+	}
+
+	// We should have handled everything, thus not dirty anymore.
+	clearDirty();
+}
 
+void Texture::updateArea(Common::Rect dirtyArea) {
 	// In case we use linear filtering we might need to duplicate the last
 	// pixel row/column to avoid glitches with filtering.
 	if (_glFilter == GL_LINEAR) {
@@ -238,15 +241,17 @@ void Texture::updateTexture() {
 		}
 	}
 
-	// Set the texture.
-	GLCALL(glBindTexture(GL_TEXTURE_2D, _glTexture));
-
 	// Update the actual texture.
-	// Although we keep track of the dirty part of the texture buffer we
-	// cannot take advantage of the left/right boundries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
+#ifdef GL_UNPACK_ROW_LENGTH
+	// With GL_UNPACK_ROW_LENGTH we can tell OpenGL the pitch of the texture
+	// buffer and only upload the dirty rect itself.
+	GLCALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, _textureData.pitch / _textureData.format.bytesPerPixel));
+	GLCALL(glTexSubImage2D(GL_TEXTURE_2D, 0, dirtyArea.left, dirtyArea.top, dirtyArea.width(), dirtyArea.height(),
+	                       _glFormat, _glType, _textureData.getBasePtr(dirtyArea.left, dirtyArea.top)));
+	GLCALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+#else
+	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH, so it is not
+	// possible to specify a pitch to glTexSubImage2D. Thus, we are left
 	// with the following options:
 	//
 	// 1) (As we do right now) Simply always update the whole texture lines of
@@ -261,16 +266,82 @@ void Texture::updateTexture() {
 	//    graphics manager did but it is much slower! Thus, we do not use it.
 	GLCALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyArea.top, _textureData.w, dirtyArea.height(),
 	                       _glFormat, _glType, _textureData.getBasePtr(0, dirtyArea.top)));
+#endif
+}
 
-	// We should have handled everything, thus not dirty anymore.
-	clearDirty();
+uint Texture::getUploadCost(const Common::Rect &area) const {
+#ifdef GL_UNPACK_ROW_LENGTH
+	return area.width() * area.height();
+#else
+	// Whole texture lines are uploaded, see updateArea.
+	return _textureData.w * area.height();
+#endif
+}
+
+void Texture::addDirtyArea(Common::Rect area) {
+	if (_allDirty || area.isEmpty()) {
+		return;
+	}
+
+	// Every upload has a fixed overhead, which we express as a number of
+	// pixels. Two areas are merged when uploading the bounding rect of both
+	// costs no more than uploading them separately.
+	static const uint uploadOverhead = 64 * 64;
+
+	for (uint i = 0; i < _dirtyAreaCount;) {
+		Common::Rect merged = area;
+		merged.extend(_dirtyAreas[i]);
+
+		if (getUploadCost(merged) <= getUploadCost(area) + getUploadCost(_dirtyAreas[i]) + uploadOverhead) {
+			// The merged area might be worth merging with areas we already
+			// looked at, thus restart the search.
+			area = merged;
+			_dirtyAreas[i] = _dirtyAreas[--_dirtyAreaCount];
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (_dirtyAreaCount == kMaxDirtyAreas) {
+		// We are out of slots. Merge with the area which adds the least
+		// cost and try again.
+		uint best = 0;
+		uint bestCost = 0xFFFFFFFF;
+
+		for (uint i = 0; i < _dirtyAreaCount; ++i) {
+			Common::Rect merged = area;
+			merged.extend(_dirtyAreas[i]);
+
+			const uint cost = getUploadCost(merged) - getUploadCost(_dirtyAreas[i]);
+			if (cost < bestCost) {
+				best = i;
+				bestCost = cost;
+			}
+		}
+
+		area.extend(_dirtyAreas[best]);
+		_dirtyAreas[best] = _dirtyAreas[--_dirtyAreaCount];
+		addDirtyArea(area);
+		return;
+	}
+
+	_dirtyAreas[_dirtyAreaCount++] = area;
+}
+
+uint Texture::getDirtyAreaCount() const {
+	if (_allDirty) {
+		return 1;
+	} else {
+		return _dirtyAreaCount;
+	}
 }
 
-Common::Rect Texture::getDirtyArea() const {
+Common::Rect Texture::getDirtyArea(uint index) const {
 	if (_allDirty) {
 		return Common::Rect(_userPixelData.w, _userPixelData.h);
 	} else {
-		return _dirtyArea;
+		return _dirtyAreas[index];
 	}
 }
 
@@ -348,23 +419,27 @@ void TextureCLUT8::updateTexture() {
 		return;
 	}
 
-	// Do the palette look up
+	// Do the palette look up, but only for the dirty areas
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
-
-	if (outSurf->format.bytesPerPixel == 2) {
-		doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
-	} else if (outSurf->format.bytesPerPixel == 4) {
-		doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
-	} else {
-		warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+	const uint dirtyAreaCount = getDirtyAreaCount();
+	for (uint i = 0; i < dirtyAreaCount; ++i) {
+		const Common::Rect dirtyArea = getDirtyArea(i);
+
+		if (outSurf->format.bytesPerPixel == 2) {
+			doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
+		} else if (outSurf->format.bytesPerPixel == 4) {
+			doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
+		} else {
+			warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+			break;
+		}
 	}
 
 	// Do generic handling of updating the texture.
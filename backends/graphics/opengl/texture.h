@@ -82,11 +82,18 @@ public:
 	void draw(GLfloat x, GLfloat y, GLfloat w, GLfloat h);
 
 	void flagDirty() { _allDirty = true; }
-	bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	bool isDirty() const { return _allDirty || _dirtyAreaCount != 0; }
 
 	uint getWidth() const { return _userPixelData.w; }
 	uint getHeight() const { return _userPixelData.h; }
 
+	/**
+	 * @return The dimensions of the OpenGL texture. These are larger than
+	 *         the logical ones when the texture has to be power of two sized.
+	 */
+	uint getTextureWidth() const { return _textureData.w; }
+	uint getTextureHeight() const { return _textureData.h; }
+
 	/**
 	 * @return The hardware format of the texture data.
 	 */
@@ -123,7 +130,16 @@ public:
 protected:
 	virtual void updateTexture();
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * @return The number of separate dirty areas of the texture.
+	 */
+	uint getDirtyAreaCount() const;
+
+	/**
+	 * @param index The index of the dirty area, less than getDirtyAreaCount().
+	 * @return The dirty area.
+	 */
+	Common::Rect getDirtyArea(uint index) const;
 private:
 	const GLenum _glIntFormat;
 	const GLenum _glFormat;
@@ -136,9 +152,34 @@ private:
 	Graphics::Surface _textureData;
 	Graphics::Surface _userPixelData;
 
+	enum {
+		/**
+		 * The maximum number of separately tracked dirty areas. Any more
+		 * areas get merged with the existing ones.
+		 */
+		kMaxDirtyAreas = 8
+	};
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	Common::Rect _dirtyAreas[kMaxDirtyAreas];
+	uint _dirtyAreaCount;
+	void clearDirty() { _allDirty = false; _dirtyAreaCount = 0; }
+
+	/**
+	 * Add an area to the dirty areas. Areas which are cheaper to upload
+	 * together than separately are merged.
+	 */
+	void addDirtyArea(Common::Rect area);
+
+	/**
+	 * @return The approximate cost of uploading the area, in pixels.
+	 */
+	uint getUploadCost(const Common::Rect &area) const;
+
+	/**
+	 * Upload an area of the texture buffer to the OpenGL texture.
+	 */
+	void updateArea(Common::Rect dirtyArea);
 
 	static GLint _maxTextureSize;
 };
@@ -178,10 +178,22 @@ bool OpenGLSdlGraphicsManager::setGraphicsMode(int mode) {
 	// 640x400). We follow the same logic here until we have a better way to
 	// give hints to our backend for that.
 	_graphicsScale = 2;
+#ifdef USE_GLSL_SCALERS
+	// Give the 3x scaler a window it can actually scale to.
+	if (mode == OpenGL::GFX_SHADER_ADVMAME3X) {
+		_graphicsScale = 3;
+	}
+#endif
 
 	return OpenGLGraphicsManager::setGraphicsMode(mode);
 }
 
+#ifdef USE_GLSL_SCALERS
+OpenGL::ProcAddressLookup OpenGLSdlGraphicsManager::getProcAddressLookup() const {
+	return SDL_GL_GetProcAddress;
+}
+#endif
+
 void OpenGLSdlGraphicsManager::resetGraphicsScale() {
 	OpenGLGraphicsManager::resetGraphicsScale();
 
@@ -67,6 +67,10 @@ protected:
 	virtual bool loadVideoMode(uint requestedWidth, uint requestedHeight, const Graphics::PixelFormat &format);
 
 	virtual void refreshScreen();
+
+#ifdef USE_GLSL_SCALERS
+	virtual OpenGL::ProcAddressLookup getProcAddressLookup() const;
+#endif
 private:
 	bool setupMode(uint width, uint height);
 
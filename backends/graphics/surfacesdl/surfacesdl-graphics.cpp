@@ -134,7 +134,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_cursorFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(0), _screenChangeCount(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -179,6 +179,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_scalerProc = Normal1x;
 #endif
 	_scalerType = 0;
+	_scalerPool = SdlScalerPool::create();
 
 #if !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 	_videoMode.fullscreen = ConfMan.getBool("fullscreen");
@@ -196,6 +197,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 		SDL_FreeSurface(_mouseOrigSurface);
 	_mouseOrigSurface = 0;
 	g_system->deleteMutex(_graphicsMutex);
+	delete _scalerPool;
 
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1091,7 +1093,30 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwscreen->pitch;
 
+		// Expensive scalers run in bands on the scaler threads. The bands of
+		// all rects are scaled at once, so a rect overlapping an earlier one
+		// has to wait until those are done, or the order of the writes (and
+		// of the aspect ratio correction) would change.
+		const bool useScalerPool = _scalerPool && scalerProc != Normal1x && IsScalerReentrant(scalerProc);
+		SDL_Rect waveRects[NUM_DIRTY_RECT];
+		int origDstY[NUM_DIRTY_RECT];
+		SDL_Rect *waveStart = _dirtyRectList;
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
+			if (useScalerPool) {
+				for (SDL_Rect *w = waveStart; w != r; ++w) {
+					const SDL_Rect &o = waveRects[w - _dirtyRectList];
+					if (r->x < o.x + o.w && o.x < r->x + r->w && r->y < o.y + o.h && o.y < r->y + r->h) {
+						runScalerBands(waveStart, r, origDstY);
+						waveStart = r;
+						break;
+					}
+				}
+
+				waveRects[r - _dirtyRectList] = *r;
+				origDstY[r - _dirtyRectList] = -1;
+			}
+
 			register int dst_y = r->y + _currentShakePos;
 			register int dst_h = 0;
 #ifdef USE_SCALERS
@@ -1113,8 +1138,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				if (useScalerPool)
+					addScalerBands(scalerProc, (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h, scale1);
+				else
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
 			}
 
 			r->x = rx1;
@@ -1123,10 +1152,20 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			r->h = dst_h * scale1;
 
 #ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
-				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible) {
+				// With the scaler threads, the rect is only stretched once
+				// it has been scaled
+				if (useScalerPool)
+					origDstY[r - _dirtyRectList] = orig_dst_y * scale1;
+				else
+					r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			}
 #endif
 		}
+
+		if (useScalerPool)
+			runScalerBands(waveStart, lastRect, origDstY);
+
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwscreen);
 
@@ -1228,6 +1267,33 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	_mouseNeedsRedraw = false;
 }
 
+void SurfaceSdlGraphicsManager::addScalerBands(ScalerProc *scalerProc, const byte *src, uint32 srcPitch, byte *dst, uint32 dstPitch, int width, int height, int scale) {
+	// Bands too small are not worth handing to another thread. Their height
+	// is kept even, since some scalers (like DotMatrix) use the parity of
+	// the row, and some process two rows at once.
+	const int kMinBandHeight = 16;
+	const int numBands = CLIP<int>(height / kMinBandHeight, 1, _scalerPool->getThreadCount());
+	const int bandHeight = ((height + numBands - 1) / numBands + 1) & ~1;
+
+	for (int y = 0; y < height; y += bandHeight) {
+		_scalerPool->addBand(scalerProc, src + y * srcPitch, srcPitch, dst + y * scale * dstPitch, dstPitch,
+			width, MIN(bandHeight, height - y));
+	}
+}
+
+void SurfaceSdlGraphicsManager::runScalerBands(SDL_Rect *first, SDL_Rect *last, const int *origDstY) {
+	if (_scalerPool->hasBands())
+		_scalerPool->run();
+
+#ifdef USE_SCALERS
+	for (SDL_Rect *r = first; r != last; ++r) {
+		const int y = origDstY[r - _dirtyRectList];
+		if (y >= 0)
+			r->h = stretch200To240((uint8 *) _hwscreen->pixels, _hwscreen->pitch, r->w, r->h, r->x, r->y, y);
+	}
+#endif
+}
+
 bool SurfaceSdlGraphicsManager::saveScreenshot(const char *filename) {
 	assert(_hwscreen != NULL);
 
@@ -27,6 +27,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -253,6 +254,9 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	/** Threads scaling the screen in bands, or 0 if there is only one core */
+	SdlScalerPool *_scalerPool;
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwsurface in destructor
@@ -342,6 +346,18 @@ protected:
 
 	virtual void internUpdateScreen();
 
+	/**
+	 * Queue the scaling of a dirty area on the scaler threads, split into
+	 * bands of rows.
+	 */
+	void addScalerBands(ScalerProc *scalerProc, const byte *src, uint32 srcPitch, byte *dst, uint32 dstPitch, int width, int height, int scale);
+
+	/**
+	 * Scale the queued bands of the given dirty rects, and apply the aspect
+	 * ratio correction to those which have an original y position set.
+	 */
+	void runScalerBands(SDL_Rect *first, SDL_Rect *last, const int *origDstY);
+
 	virtual bool loadGFXMode();
 	virtual void unloadGFXMode();
 	virtual bool hotswapGFXMode();
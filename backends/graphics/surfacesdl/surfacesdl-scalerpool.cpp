@@ -0,0 +1,165 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlScalerPool *SdlScalerPool::create() {
+	int numThreads;
+	if (ConfMan.hasKey("scaler_threads")) {
+		numThreads = ConfMan.getInt("scaler_threads");
+	} else {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		numThreads = SDL_GetCPUCount();
+#else
+		// SDL 1.2 cannot tell the number of cores
+		numThreads = 1;
+#endif
+	}
+
+	numThreads = CLIP<int>(numThreads, 1, kMaxThreads + 1);
+	if (numThreads == 1)
+		return 0;
+
+	SdlScalerPool *pool = new SdlScalerPool(numThreads - 1);
+	if (pool->_numWorkers == 0) {
+		delete pool;
+		return 0;
+	}
+
+	debug(1, "Scaling with %d threads", pool->getThreadCount());
+	return pool;
+}
+
+SdlScalerPool::SdlScalerPool(int numWorkers)
+	: _numBands(0), _nextBand(0), _unfinishedBands(0), _numWorkers(0), _shouldQuit(false) {
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (int i = 0; i < numWorkers; i++) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, "Cabal Scaler", this);
+#else
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, this);
+#endif
+		if (!thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+
+		_workers[_numWorkers++] = thread;
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	// Signal the workers to end, and wait for them to actually finish
+	SDL_LockMutex(_mutex);
+	_shouldQuit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (int i = 0; i < _numWorkers; i++)
+		SDL_WaitThread(_workers[i], NULL);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+void SdlScalerPool::addBand(ScalerProc *scalerProc, const byte *src, uint32 srcPitch, byte *dst, uint32 dstPitch, int width, int height) {
+	Band band;
+	band.scalerProc = scalerProc;
+	band.src = src;
+	band.srcPitch = srcPitch;
+	band.dst = dst;
+	band.dstPitch = dstPitch;
+	band.width = width;
+	band.height = height;
+
+	// The workers only look at the bands during run(), so no locking is
+	// needed here
+	assert(_numBands == 0);
+	_bands.push_back(band);
+}
+
+void SdlScalerPool::run() {
+	SDL_LockMutex(_mutex);
+	_numBands = _bands.size();
+	_nextBand = 0;
+	_unfinishedBands = _numBands;
+	SDL_CondBroadcast(_workCond);
+
+	runBands();
+	while (_unfinishedBands > 0)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_numBands = 0;
+	_nextBand = 0;
+	SDL_UnlockMutex(_mutex);
+
+	_bands.clear();
+}
+
+void SdlScalerPool::runBands() {
+	while (_nextBand < _numBands) {
+		const Band band = _bands[_nextBand++];
+		SDL_UnlockMutex(_mutex);
+
+		band.scalerProc(band.src, band.srcPitch, band.dst, band.dstPitch, band.width, band.height);
+
+		SDL_LockMutex(_mutex);
+		if (--_unfinishedBands == 0)
+			SDL_CondSignal(_doneCond);
+	}
+}
+
+void SdlScalerPool::workerThread() {
+	SDL_LockMutex(_mutex);
+	while (true) {
+		// Wait until there are bands to scale
+		while (!_shouldQuit && _nextBand >= _numBands)
+			SDL_CondWait(_workCond, _mutex);
+
+		if (_shouldQuit)
+			break;
+
+		runBands();
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+int SDLCALL SdlScalerPool::workerThreadEntry(void *arg) {
+	SdlScalerPool *pool = (SdlScalerPool *)arg;
+	assert(pool);
+	pool->workerThread();
+	return 0;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/* Cabal - Legacy Game Implementations
+ *
+ * Cabal is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scaler.h"
+#include "common/array.h"
+
+/**
+ * A pool of SDL threads which run scaler procs on bands of a surface, so
+ * that the expensive scalers can use all cores of the CPU.
+ *
+ * Jobs are queued with addBand() and run with run(), which also uses the
+ * calling thread and returns once all of them are done.
+ */
+class SdlScalerPool {
+public:
+	enum {
+		kMaxThreads = 8
+	};
+
+	/**
+	 * Create a pool with the number of threads given by the "scaler_threads"
+	 * config key, or one per CPU core. Returns 0 if only a single thread
+	 * would be used.
+	 */
+	static SdlScalerPool *create();
+
+	~SdlScalerPool();
+
+	/** Return the number of threads running jobs, including the caller's. */
+	int getThreadCount() const { return _numWorkers + 1; }
+
+	/**
+	 * Queue a job scaling the given area. The scaler may read one pixel
+	 * around it, which has to stay unchanged until run() returns.
+	 */
+	void addBand(ScalerProc *scalerProc, const byte *src, uint32 srcPitch, byte *dst, uint32 dstPitch, int width, int height);
+
+	/** Return whether any jobs are queued. */
+	bool hasBands() const { return !_bands.empty(); }
+
+	/** Run all queued jobs, and wait until they are finished. */
+	void run();
+
+private:
+	explicit SdlScalerPool(int numWorkers);
+
+	struct Band {
+		ScalerProc *scalerProc;
+		const byte *src;
+		uint32 srcPitch;
+		byte *dst;
+		uint32 dstPitch;
+		int width, height;
+	};
+
+	Common::Array<Band> _bands;
+	/** The number of bands being run, or 0 outside of run() */
+	uint _numBands;
+	/** The next band to be picked up by a thread */
+	uint _nextBand;
+	/** The number of bands which were not finished yet */
+	uint _unfinishedBands;
+
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+	SDL_Thread *_workers[kMaxThreads];
+	int _numWorkers;
+	bool _shouldQuit;
+
+	/**
+	 * Pick up and run bands until none are left. The mutex has to be
+	 * locked, and is locked again on return.
+	 */
+	void runBands();
+
+	void workerThread();
+	static int SDLCALL workerThreadEntry(void *arg);
+};
+
+#endif
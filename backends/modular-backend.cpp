@@ -26,23 +26,32 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/mutex/mutex.h"
+#include "backends/threads/threads.h"
 
 #include "audio/mixer.h"
+#include "common/savefile.h"
 #include "graphics/pixelformat.h"
 
 ModularBackend::ModularBackend()
 	:
 	_mutexManager(0),
+	_threadManager(0),
 	_graphicsManager(0),
 	_mixer(0) {
 
 }
 
 ModularBackend::~ModularBackend() {
+	// The savefile manager may still have savefiles to write, which needs
+	// the timer and mutex managers
+	delete _savefileManager;
+	_savefileManager = 0;
 	delete _graphicsManager;
 	_graphicsManager = 0;
 	delete _mixer;
 	_mixer = 0;
+	delete _threadManager;
+	_threadManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 }
@@ -219,6 +228,49 @@ void ModularBackend::deleteMutex(MutexRef mutex) {
 	_mutexManager->deleteMutex(mutex);
 }
 
+OSystem::ThreadRef ModularBackend::createThread(ThreadProc proc, void *param, const char *name) {
+	if (!_threadManager)
+		return 0;
+	return _threadManager->createThread(proc, param, name);
+}
+
+void ModularBackend::joinThread(ThreadRef thread) {
+	assert(_threadManager);
+	_threadManager->joinThread(thread);
+}
+
+OSystem::ConditionRef ModularBackend::createCondition() {
+	if (!_threadManager)
+		return 0;
+	return _threadManager->createCondition();
+}
+
+void ModularBackend::waitCondition(ConditionRef cond, MutexRef mutex) {
+	assert(_threadManager);
+	_threadManager->waitCondition(cond, mutex);
+}
+
+void ModularBackend::signalCondition(ConditionRef cond) {
+	assert(_threadManager);
+	_threadManager->signalCondition(cond);
+}
+
+void ModularBackend::broadcastCondition(ConditionRef cond) {
+	assert(_threadManager);
+	_threadManager->broadcastCondition(cond);
+}
+
+void ModularBackend::deleteCondition(ConditionRef cond) {
+	assert(_threadManager);
+	_threadManager->deleteCondition(cond);
+}
+
+uint ModularBackend::getCPUCount() {
+	if (!_threadManager)
+		return 1;
+	return _threadManager->getCPUCount();
+}
+
 Audio::Mixer *ModularBackend::getMixer() {
 	assert(_mixer);
 	return (Audio::Mixer *)_mixer;
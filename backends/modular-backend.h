@@ -29,6 +29,7 @@
 
 class GraphicsManager;
 class MutexManager;
+class ThreadManager;
 
 /**
  * Base class for modular backends.
@@ -115,6 +116,20 @@ public:
 
 	//@}
 
+	/** @name Worker threads */
+	//@{
+
+	virtual ThreadRef createThread(ThreadProc proc, void *param, const char *name);
+	virtual void joinThread(ThreadRef thread);
+	virtual ConditionRef createCondition();
+	virtual void waitCondition(ConditionRef cond, MutexRef mutex);
+	virtual void signalCondition(ConditionRef cond);
+	virtual void broadcastCondition(ConditionRef cond);
+	virtual void deleteCondition(ConditionRef cond);
+	virtual uint getCPUCount();
+
+	//@}
+
 	/** @name Sound */
 	//@{
 
@@ -135,6 +150,8 @@ protected:
 	//@{
 
 	MutexManager *_mutexManager;
+	/** Optional, without it no worker threads are created */
+	ThreadManager *_threadManager;
 	GraphicsManager *_graphicsManager;
 	Audio::Mixer *_mixer;
 
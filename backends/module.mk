@@ -56,6 +56,7 @@ MODULE_OBJS += \
 	graphics/opengl/debug.o \
 	graphics/opengl/extensions.o \
 	graphics/opengl/opengl-graphics.o \
+	graphics/opengl/shader.o \
 	graphics/opengl/texture.o
 endif
 
@@ -91,10 +92,12 @@ MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/sdl/sdl-graphics.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	graphics/surfacesdl/surfacesdl-scalerpool.o \
 	mixer/doublebuffersdl/doublebuffersdl-mixer.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
+	threads/sdl/sdl-threads.o \
 	timer/sdl/sdl-timer.o
 
 # SDL 2 removed audio CD support
@@ -113,6 +116,7 @@ ifdef POSIX
 MODULE_OBJS += \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
+	fs/posix/posix-mapped-stream.o \
 	plugins/posix/posix-provider.o \
 	saves/posix/posix-saves.o \
 	taskbar/unity/unity-taskbar.o
@@ -155,6 +159,7 @@ ifdef PLAYSTATION3
 MODULE_OBJS += \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
+	fs/posix/posix-mapped-stream.o \
 	fs/ps3/ps3-fs-factory.o \
 	events/ps3sdl/ps3sdl-events.o
 endif
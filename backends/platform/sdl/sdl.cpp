@@ -44,6 +44,7 @@
 
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
+#include "backends/threads/sdl/sdl-threads.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #ifdef USE_OPENGL
@@ -108,6 +109,8 @@ OSystem_SDL::~OSystem_SDL() {
 	_mixerManager = 0;
 	delete _timerManager;
 	_timerManager = 0;
+	delete _threadManager;
+	_threadManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 
@@ -144,6 +147,9 @@ void OSystem_SDL::init() {
 	if (_mutexManager == 0)
 		_mutexManager = new SdlMutexManager();
 
+	if (_threadManager == 0)
+		_threadManager = new SdlThreadManager();
+
 	if (_window == 0)
 		_window = new SdlWindow();
 
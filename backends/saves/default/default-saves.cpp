@@ -31,24 +31,150 @@
 
 #include "backends/saves/default/default-saves.h"
 
+#include "common/algorithm.h"
 #include "common/savefile.h"
 #include "common/util.h"
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/system.h"
+#include "common/threadpool.h"
+#include "common/timer.h"
 #include "common/zlib.h"
 
 #ifndef _WIN32_WCE
 #include <errno.h>	// for removeSavefile()
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+#if defined(POSIX)
+#include <fcntl.h>	// for syncFile()
+#include <unistd.h>
+#endif
+
+#include <time.h>	// for getSavefileStamp()
+
+/**
+ * A savefile which collects all written data in memory. Once it is
+ * finalized, the data is handed over to the savefile manager, which
+ * compresses and writes it in the background.
+ */
+class AsyncOutSaveFile : public Common::WriteStream {
+private:
+	DefaultSaveFileManager *_manager;
+	Common::String _name;
+	Common::String _path;
+	bool _compress;
+	byte *_data;
+	uint32 _size;
+	uint32 _capacity;
+	bool _queued;
+	bool _err;
+
+public:
+	AsyncOutSaveFile(DefaultSaveFileManager *manager, const Common::String &name, const Common::String &path, bool compress)
+		: _manager(manager), _name(name), _path(path), _compress(compress), _data(0), _size(0), _capacity(0), _queued(false), _err(false) {
+	}
+
+	~AsyncOutSaveFile() {
+		finalize();
+	}
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; }
+
+	uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (_queued) {
+			_err = true;
+			return 0;
+		}
+
+		if (dataSize > _capacity - _size) {
+			// Grow geometrically, big savegames are written in many small pieces
+			const uint32 capacity = MAX<uint32>(MAX<uint32>(_capacity * 2, 4096), _size + dataSize);
+			byte *data = (byte *)realloc(_data, capacity);
+			if (!data) {
+				_err = true;
+				return 0;
+			}
+			_data = data;
+			_capacity = capacity;
+		}
+
+		memcpy(_data + _size, dataPtr, dataSize);
+		_size += dataSize;
+		return dataSize;
+	}
+
+	void finalize() {
+		if (_queued)
+			return;
+		_queued = true;
+
+		// Never replace an existing savefile with incomplete data
+		if (_err) {
+			free(_data);
+		} else {
+			_manager->queueSave(_name, _path, _data, _size, _compress);
+		}
+		_data = 0;
+	}
+};
+
+/**
+ * Writes the first pending savefile, on the savefile thread.
+ */
+class DefaultSaveFileManager::SaveJob : public Common::ThreadJob {
+public:
+	SaveJob(DefaultSaveFileManager *manager) : _manager(manager) {}
+
+	virtual void run() {
+		Common::StackLock lock(_manager->_writeMutex);
+		_manager->processNextSave(0);
+	}
+
+private:
+	DefaultSaveFileManager *_manager;
+};
+
+/**
+ * Make sure that the data written to a file is on the disk, and not only
+ * in the cache of the operating system.
+ */
+static bool syncFile(const Common::String &path) {
+#if defined(POSIX)
+	const int fd = open(path.c_str(), O_RDWR);
+	if (fd == -1)
+		return false;
+
+	const bool result = (fsync(fd) == 0);
+	close(fd);
+	return result;
+#else
+	return true;
+#endif
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) {
+DefaultSaveFileManager::DefaultSaveFileManager()
+	: _saveThread(0), _timerInstalled(false), _pendingError(Common::kNoError) {
+}
+
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath)
+	: _saveThread(0), _timerInstalled(false), _pendingError(Common::kNoError) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	if (_timerInstalled) {
+		// The timer manager may already be gone when the backend shuts down
+		Common::TimerManager *timer = g_system->getTimerManager();
+		if (timer)
+			timer->removeTimerProc(&pendingSaveProc);
+	}
+
+	waitForPendingSaves();
+	delete _saveThread;
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -60,6 +186,9 @@ void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 }
 
 Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &pattern) {
+	if (_accessLog)
+		_accessLog->patterns.push_back(pattern);
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
@@ -73,16 +202,38 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 	Common::StringArray results;
 	Common::String search(pattern);
 
+	// Savefiles which are still being written in the background are listed
+	// under their final names, and their temporary files are left out
+	Common::StringArray pending;
+	{
+		Common::StackLock lock(_pendingMutex);
+		for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+			if ((*i)->name.matchString(search, true))
+				pending.push_back((*i)->name);
+		}
+	}
+
 	if (dir.listMatchingMembers(savefiles, search) > 0) {
 		for (Common::ArchiveMemberList::const_iterator file = savefiles.begin(); file != savefiles.end(); ++file) {
-			results.push_back((*file)->getName());
+			const Common::String name = (*file)->getName();
+			if (name.hasSuffix(".tmp") && Common::find(pending.begin(), pending.end(), Common::String(name.c_str(), name.size() - 4)) != pending.end())
+				continue;
+			results.push_back(name);
 		}
 	}
 
+	for (Common::StringArray::const_iterator i = pending.begin(); i != pending.end(); ++i) {
+		if (Common::find(results.begin(), results.end(), *i) == results.end())
+			results.push_back(*i);
+	}
+
 	return results;
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	if (_accessLog)
+		_accessLog->names.push_back(filename);
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -93,6 +244,10 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 	Common::FSNode savePath(savePathName);
 
 	Common::FSNode file = savePath.getChild(filename);
+
+	// Make sure that a savefile written in the background is complete
+	waitForPendingSaves(file.getPath());
+
 	if (!file.exists())
 		return 0;
 
@@ -114,6 +269,14 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 
 	Common::FSNode file = savePath.getChild(filename);
 
+	// Collect the data in memory, so that compressing and writing it does
+	// not hold up the game
+	if (ConfMan.hasKey("async_saves") && ConfMan.getBool("async_saves"))
+		return new AsyncOutSaveFile(this, filename, file.getPath(), compress);
+
+	// Don't let an earlier background write replace this savefile
+	waitForPendingSaves(file.getPath());
+
 	// Open the file for saving
 	Common::WriteStream *sf = file.createWriteStream();
 
@@ -131,6 +294,8 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 
 	Common::FSNode file = savePath.getChild(filename);
 
+	waitForPendingSaves(file.getPath());
+
 	// FIXME: remove does not exist on all systems. If your port fails to
 	// compile because of this, please let us know (scummvm-devel or Fingolfin).
 	// There is a nicely portable workaround, too: Make this method overloadable.
@@ -148,6 +313,187 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 	}
 }
 
+bool DefaultSaveFileManager::flushPendingSaves() {
+	waitForPendingSaves();
+
+	Common::StackLock lock(_pendingMutex);
+	if (_pendingError.getCode() == Common::kNoError)
+		return true;
+
+	setError(_pendingError, _pendingErrorDesc);
+	_pendingError = Common::kNoError;
+	_pendingErrorDesc.clear();
+	return false;
+}
+
+uint DefaultSaveFileManager::getPendingSaveCount() {
+	Common::StackLock lock(_pendingMutex);
+	return _pendingSaves.size();
+}
+
+uint32 DefaultSaveFileManager::getSavefileStamp(const Common::String &filename) {
+	{
+		// Savefiles which are still being written have no stamp yet
+		Common::StackLock lock(_pendingMutex);
+		for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+			if ((*i)->name.equalsIgnoreCase(filename))
+				return 0;
+		}
+	}
+
+	// A savefile which was modified just now may be modified again within
+	// the resolution of the modification time, without changing it
+	const uint32 mtime = Common::FSNode(getSavePath()).getChild(filename).getModificationTime();
+	if (mtime == 0 || mtime + 2 > (uint32)time(0))
+		return 0;
+
+	return mtime;
+}
+
+void DefaultSaveFileManager::queueSave(const Common::String &name, const Common::String &path, byte *data, uint32 size, bool compress) {
+	PendingSave *save = new PendingSave;
+	save->name = name;
+	save->path = path;
+	save->data = data;
+	save->size = size;
+	save->pos = 0;
+	save->compress = compress;
+	save->stream = 0;
+
+	{
+		Common::StackLock lock(_pendingMutex);
+		_pendingSaves.push_back(save);
+	}
+
+	if (!_saveThread && !_timerInstalled) {
+		_saveThread = new Common::ThreadPool(1, "DefaultSaveFileManager");
+		if (!_saveThread->getThreadCount()) {
+			delete _saveThread;
+			_saveThread = 0;
+
+			Common::TimerManager *timer = g_system->getTimerManager();
+			_timerInstalled = timer && timer->installTimerProc(&pendingSaveProc, kSaveTimerInterval, this, "DefaultSaveFileManager");
+		}
+	}
+
+	// Each job writes the first pending savefile, so they are written in order
+	if (_saveThread)
+		_saveThread->addJob(new SaveJob(this), DisposeAfterUse::YES);
+
+	// Without a thread or a timer, there is no way to write in the background
+	if (!_saveThread && !_timerInstalled)
+		waitForPendingSaves();
+}
+
+void DefaultSaveFileManager::waitForPendingSaves(const Common::String &path) {
+	while (true) {
+		{
+			Common::StackLock lock(_pendingMutex);
+
+			bool found = false;
+			for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end() && !found; ++i)
+				found = path.empty() || (*i)->path == path;
+			if (!found)
+				return;
+		}
+
+		// Savefiles are written in order, so that a newer savefile always
+		// replaces an older one with the same name
+		if (_saveThread) {
+			_saveThread->wait();
+		} else {
+			// Only write one slice at a time, the timer thread is blocked
+			// while waiting for the lock
+			Common::StackLock lock(_writeMutex);
+			processNextSave(kSaveSliceSize);
+		}
+	}
+}
+
+void DefaultSaveFileManager::processNextSave(uint32 sliceSize) {
+	PendingSave *save;
+	{
+		Common::StackLock lock(_pendingMutex);
+		if (_pendingSaves.empty())
+			return;
+		save = _pendingSaves.front();
+	}
+
+	// The savefile stays in the list while it is written, so that it is
+	// still listed, but the list is not locked meanwhile
+	if (!processPendingSave(save, sliceSize))
+		return;
+
+	{
+		Common::StackLock lock(_pendingMutex);
+		_pendingSaves.pop_front();
+	}
+	finishPendingSave(save);
+}
+
+bool DefaultSaveFileManager::processPendingSave(PendingSave *save, uint32 sliceSize) {
+	// The data is written to a temporary file first, which replaces the
+	// savefile once it is complete. A crash or a full disk never leaves a
+	// truncated savefile behind.
+	const Common::String tempPath = save->path + ".tmp";
+
+	if (!save->stream) {
+		Common::WriteStream *file = Common::FSNode(tempPath).createWriteStream();
+		if (!file) {
+			Common::StackLock lock(_pendingMutex);
+			_pendingError = Common::kCreatingFileFailed;
+			_pendingErrorDesc = "Could not create the savefile '" + save->name + "'";
+			return true;
+		}
+
+		save->stream = save->compress ? Common::wrapCompressedWriteStream(file) : file;
+	}
+
+	uint32 count = save->size - save->pos;
+	if (sliceSize && count > sliceSize)
+		count = sliceSize;
+	save->pos += save->stream->write(save->data + save->pos, count);
+
+	if (save->pos < save->size && !save->stream->err())
+		return false;
+
+	save->stream->finalize();
+	const bool success = (save->pos == save->size && !save->stream->err());
+	delete save->stream;
+	save->stream = 0;
+
+	// The savefile must only be replaced once the new data is on the disk,
+	// or a crash could leave an empty file behind on some file systems
+	if (success && syncFile(tempPath)) {
+		if (rename(tempPath.c_str(), save->path.c_str()) == 0)
+			return true;
+
+		// rename() does not replace existing files on all systems
+		remove(save->path.c_str());
+		if (rename(tempPath.c_str(), save->path.c_str()) == 0)
+			return true;
+	}
+
+	remove(tempPath.c_str());
+
+	Common::StackLock lock(_pendingMutex);
+	_pendingError = Common::kWritingFailed;
+	_pendingErrorDesc = "Could not write the savefile '" + save->name + "'";
+	return true;
+}
+
+void DefaultSaveFileManager::finishPendingSave(PendingSave *save) {
+	delete save->stream;
+	free(save->data);
+	delete save;
+}
+
+void DefaultSaveFileManager::pendingSaveProc(void *refCon) {
+	DefaultSaveFileManager *manager = (DefaultSaveFileManager *)refCon;
+	Common::StackLock lock(manager->_writeMutex);
+	manager->processNextSave(kSaveSliceSize);
+}
+
 Common::String DefaultSaveFileManager::getSavePath() const {
 
 	Common::String dir;
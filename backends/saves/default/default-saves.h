@@ -27,6 +27,12 @@
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
+#include "common/list.h"
+#include "common/mutex.h"
+
+namespace Common {
+class ThreadPool;
+}
 
 /**
  * Provides a default savefile manager implementation for common platforms.
@@ -35,12 +41,24 @@ class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::String &defaultSavepath);
+	virtual ~DefaultSaveFileManager();
 
 	virtual Common::StringArray listSavefiles(const Common::String &pattern);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true);
 	virtual bool removeSavefile(const Common::String &filename);
 
+	virtual bool flushPendingSaves();
+	virtual uint getPendingSaveCount();
+	virtual uint32 getSavefileStamp(const Common::String &filename);
+
+	/**
+	 * Queue the given savefile data for writing in the background. Takes
+	 * ownership of the data. Used by the streams returned by openForSaving
+	 * when asynchronous saving is enabled.
+	 */
+	void queueSave(const Common::String &name, const Common::String &path, byte *data, uint32 size, bool compress);
+
 protected:
 	/**
 	 * Get the path to the savegame directory.
@@ -54,6 +72,68 @@ protected:
 	 * Sets the internal error and error message accordingly.
 	 */
 	virtual void checkPath(const Common::FSNode &dir);
+
+	/**
+	 * Finish writing the pending savefiles, in order, until none of them
+	 * is written to the given path anymore. An empty path finishes all of
+	 * them.
+	 */
+	void waitForPendingSaves(const Common::String &path = Common::String());
+
+private:
+	class SaveJob;
+	friend class SaveJob;
+
+	/** A savefile which is compressed and written in the background. */
+	struct PendingSave {
+		Common::String name;
+		Common::String path;
+		byte *data;
+		uint32 size;
+		uint32 pos;
+		bool compress;
+		Common::WriteStream *stream;
+	};
+
+	enum {
+		/**
+		 * The number of bytes compressed and written on every timer tick,
+		 * when the backend has no threads
+		 */
+		kSaveSliceSize = 64 * 1024,
+		/** The interval of the background saving timer, in microseconds */
+		kSaveTimerInterval = 10000
+	};
+
+	/**
+	 * Compress and write the next slice of the first pending savefile, or
+	 * all of it if sliceSize is 0. _writeMutex must be held.
+	 */
+	void processNextSave(uint32 sliceSize);
+
+	/**
+	 * Compress and write the next slice of the given savefile, or all of it
+	 * if sliceSize is 0. Returns true when the savefile is done.
+	 */
+	bool processPendingSave(PendingSave *save, uint32 sliceSize);
+	void finishPendingSave(PendingSave *save);
+
+	static void pendingSaveProc(void *refCon);
+
+	/** Guards the list of pending savefiles and the pending error */
+	Common::List<PendingSave *> _pendingSaves;
+	Common::Mutex _pendingMutex;
+	/** Held while a savefile is compressed and written */
+	Common::Mutex _writeMutex;
+
+	/**
+	 * The thread writing the savefiles. Without one, they are written a
+	 * slice at a time by a timer.
+	 */
+	Common::ThreadPool *_saveThread;
+	bool _timerInstalled;
+	Common::Error _pendingError;
+	Common::String _pendingErrorDesc;
 };
 
 #endif
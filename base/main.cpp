@@ -42,6 +42,7 @@
 #include "common/debug-channels.h" /* for debug manager */
 #include "common/events.h"
 #include "common/fs.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/tokenizer.h"
@@ -243,6 +244,10 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	// Inform backend that the engine finished
 	system.engineDone();
 
+	// Finish the savefiles which are still being written in the background
+	if (!system.getSavefileManager()->flushPendingSaves())
+		warning("%s", system.getSavefileManager()->popErrorDesc().c_str());
+
 	// Clean up any game-specific keymaps
 	engine->deinitKeymap();
 
@@ -445,6 +445,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 // Engine plugins
 
 #include "engines/metaengine.h"
+#include "engines/advancedDetector.h"
 
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
@@ -514,7 +515,7 @@ GameDescriptor EngineManager::findGameInLoadedPlugins(const Common::String &game
 	return result;
 }
 
-GameList EngineManager::detectGames(const Common::FSList &fslist) const {
+GameList EngineManager::detectGames(const Common::FSList &fslist, bool flushCache) const {
 	GameList candidates;
 	EnginePlugin::List plugins;
 	EnginePlugin::List::const_iterator iter;
@@ -527,6 +528,11 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	// Remember the MD5 sums computed by the AdvancedDetector
+	if (flushCache)
+		ADDetectionCache::instance().flush();
+
 	return candidates;
 }
 
@@ -266,6 +266,47 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	return 0;
 }
 
+SeekableReadStream *SearchSet::createMappedReadStreamForMember(const String &name) const {
+	if (name.empty())
+		return 0;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		SeekableReadStream *stream = it->_arc->createMappedReadStreamForMember(name);
+		if (stream)
+			return stream;
+	}
+
+	return 0;
+}
+
+SeekableReadStream *SearchSet::createReadAheadStreamForMember(const String &name, uint32 bufSize) const {
+	if (name.empty())
+		return 0;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		SeekableReadStream *stream = it->_arc->createReadAheadStreamForMember(name, bufSize);
+		if (stream)
+			return stream;
+	}
+
+	return 0;
+}
+
+void SearchSet::prefetchMember(const String &name, uint32 offset, uint32 size) const {
+	if (name.empty())
+		return;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(name)) {
+			it->_arc->prefetchMember(name, offset, size);
+			return;
+		}
+	}
+}
+
 
 SearchManager::SearchManager() {
 	clear();	// Force a reset
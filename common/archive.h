@@ -117,6 +117,39 @@ public:
 	 * @return the newly created input stream
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Create a stream bound to a member like createReadStreamForMember(),
+	 * which keeps the data of the member in memory where this is cheap, see
+	 * FSNode::createMappedReadStream(). The default implementation returns
+	 * createReadStreamForMember().
+	 */
+	virtual SeekableReadStream *createMappedReadStreamForMember(const String &name) const { return createReadStreamForMember(name); }
+
+	/**
+	 * Create a stream bound to a member like createReadStreamForMember(),
+	 * which reads ahead on a worker thread, see
+	 * wrapReadAheadSeekableReadStream(). This is only possible for streams
+	 * which own their file, so the default implementation returns
+	 * createReadStreamForMember(): the member streams of most archives
+	 * share the stream of the archive, which must not be read from two
+	 * threads at once.
+	 *
+	 * @param name    the name of the member
+	 * @param bufSize the size of each of the read ahead buffers
+	 */
+	virtual SeekableReadStream *createReadAheadStreamForMember(const String &name, uint32 bufSize) const { return createReadStreamForMember(name); }
+
+	/**
+	 * Hint that a part of the member with the specified name is going to be
+	 * read soon, e.g. the resources of the next scene, so that it can be read
+	 * in the background beforehand. The default implementation does nothing.
+	 *
+	 * @param name   the name of the member
+	 * @param offset the start of the part of the member
+	 * @param size   the size of the part of the member, 0 for up to its end
+	 */
+	virtual void prefetchMember(const String &name, uint32 offset = 0, uint32 size = 0) const {}
 };
 
 
@@ -241,6 +274,24 @@ public:
 	 * opening the first file encountered that matches the name.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Like createReadStreamForMember(), opening the first file encountered
+	 * that matches the name.
+	 */
+	virtual SeekableReadStream *createMappedReadStreamForMember(const String &name) const;
+
+	/**
+	 * Like createReadStreamForMember(), opening the first file encountered
+	 * that matches the name.
+	 */
+	virtual SeekableReadStream *createReadAheadStreamForMember(const String &name, uint32 bufSize) const;
+
+	/**
+	 * Passes the hint on to the Archive with the highest priority which
+	 * contains the member.
+	 */
+	virtual void prefetchMember(const String &name, uint32 offset = 0, uint32 size = 0) const;
 };
 
 
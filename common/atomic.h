@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @name Atomic operations
+ * For the rare data which is shared between threads without a mutex, like
+ * the command queue of the audio mixer. The values have to be declared
+ * volatile, so the compiler does not keep them in registers.
+ *
+ * Compilers without support for these are assumed to only run on single
+ * core systems.
+ */
+//@{
+
+/**
+ * Full memory barrier: no load or store is moved across it, neither by the
+ * compiler nor by the CPU.
+ */
+inline void memoryBarrier() {
+#if defined(_MSC_VER)
+	long barrier = 0;
+	_InterlockedExchange(&barrier, 1);
+#elif defined(__GNUC__)
+	__sync_synchronize();
+#endif
+}
+
+/**
+ * Atomically set the value to newValue if it is oldValue. This is also a
+ * full memory barrier.
+ *
+ * @return true if the value was changed
+ */
+inline bool compareAndSwap(volatile int32 *value, int32 oldValue, int32 newValue) {
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchange((volatile long *)value, newValue, oldValue) == oldValue;
+#elif defined(__GNUC__)
+	return __sync_bool_compare_and_swap(value, oldValue, newValue);
+#else
+	if (*value != oldValue)
+		return false;
+
+	*value = newValue;
+	return true;
+#endif
+}
+
+//@}
+
+} // End of namespace Common
+
+#endif
@@ -28,6 +28,7 @@
 #include "common/scummsys.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -64,12 +65,18 @@ public:
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	virtual uint32 peekBit() = 0;
 
-	/** Read a multi-bit value from the bit stream, without changing the stream's position. */
+	/**
+	 * Read a multi-bit value from the bit stream, without changing the stream's position.
+	 * Bits past the end of the stream are read as 0.
+	 */
 	virtual uint32 peekBits(uint8 n) = 0;
 
 	/** Add a bit to the value x, making it an n+1-bit value. */
 	virtual void addBit(uint32 &x, uint32 n) = 0;
 
+	/** Are the bits handed out in the order of MSB to LSB? */
+	virtual bool isMSBFirst() const = 0;
+
 protected:
 	BitStream() {
 	}
@@ -212,34 +219,58 @@ public:
 
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	uint32 peekBit() {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
-
-		uint32 v = getBit();
-
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
-
-		return v;
+		return peekBits(1);
 	}
 
 	/**
 	 * Read a multi-bit value from the bit stream, without changing the stream's position.
 	 *
-	 * The bit order is the same as in getBits().
+	 * The bit order is the same as in getBits(). Bits past the end of the
+	 * stream are read as 0.
 	 */
 	uint32 peekBits(uint8 n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			error("BitStreamImpl::peekBits(): Too many bits requested to be read");
+
+		// The bits are all in the current value
+		if (_inValue != 0 && n <= valueBits - _inValue) {
+			if (isMSB2LSB)
+				return _value >> (32 - n);
+			else
+				return _value & (0xFFFFFFFF >> (32 - n));
+		}
+
+		// Otherwise, read ahead and go back afterwards
 		uint32 value   = _value;
 		uint8  inValue = _inValue;
 		uint32 curPos  = _stream->pos();
 
-		uint32 v = getBits(n);
+		uint32 v = 0;
+		for (uint8 i = 0; i < n; i++) {
+			if (inValue == 0) {
+				value = 0;
+				if (_stream->pos() + (valueBits >> 3) <= (int32)(size() >> 3))
+					value = readData();
+
+				if (isMSB2LSB)
+					value <<= 32 - valueBits;
+			}
+
+			if (isMSB2LSB) {
+				v = (v << 1) | (value >> 31);
+				value <<= 1;
+			} else {
+				v |= (value & 1) << i;
+				value >>= 1;
+			}
+
+			inValue = (inValue + 1) % valueBits;
+		}
 
 		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
 
 		return v;
 	}
@@ -275,8 +306,32 @@ public:
 
 	/** Skip the specified amount of bits. */
 	void skip(uint32 n) {
-		while (n-- > 0)
-			getBit();
+		while (n > 0) {
+			if (_inValue == 0) {
+				// Skip whole data values without reading them
+				if (n >= valueBits) {
+					uint32 values = n / valueBits;
+					if ((size() - pos()) < values * valueBits)
+						error("BitStreamImpl::skip(): End of bit stream reached");
+
+					_stream->seek(values * (valueBits >> 3), SEEK_CUR);
+					n -= values * valueBits;
+					continue;
+				}
+
+				readValue();
+			}
+
+			// Skip the bits in the current value
+			uint8 count = MIN<uint32>(n, valueBits - _inValue);
+			if (isMSB2LSB)
+				_value <<= count;
+			else
+				_value >>= count;
+
+			_inValue = (_inValue + count) % valueBits;
+			n -= count;
+		}
 	}
 
 	/** Skip the bits to closest data value border. */
@@ -302,6 +357,10 @@ public:
 	bool eos() const {
 		return _stream->eos() || (pos() >= size());
 	}
+
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
 };
 
 // typedefs for various memory layouts.
@@ -50,6 +50,22 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  */
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
 
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
+ * provides buffering like wrapBufferedSeekableReadStream(). Once the stream
+ * is read sequentially, the next buffer is read on a worker thread while
+ * the current one is used, so reading from a slow medium does not block
+ * the caller. Seeking out of the buffer stops that again.
+ *
+ * The parent stream is only used by the wrapper from then on, and it has
+ * to be safe to read it from another thread. Without thread support, this
+ * is just a buffered stream.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ */
+SeekableReadStream *wrapReadAheadSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which
  * transparently provides buffering.
@@ -25,20 +25,57 @@
 #include "common/memstream.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 
 namespace Common {
 
 class DecompressorDCL {
 public:
-	bool unpack(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize);
+	DecompressorDCL();
+
+	/**
+	 * Decompress data from a stream.
+	 * @param sourceStream	source stream to read from
+	 * @param sourceSize	size of the compressed data at the current position of sourceStream
+	 * @param target		buffer of targetSize bytes to write to, used if targetFixedSize is set
+	 * @param targetSize	size of the decompressed data (if fixed)
+	 * @param targetFixedSize	if the target has a fixed size. Otherwise a buffer is
+	 *                          allocated, which can be taken with releaseTarget().
+	 */
+	bool unpack(SeekableReadStream *sourceStream, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize);
+
+	/**
+	 * Decompress data from memory, see above.
+	 */
+	bool unpack(const byte *source, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize);
+
+	/**
+	 * Return the buffer allocated for a target of dynamic size, which is
+	 * then owned by the caller and has to be freed with free().
+	 */
+	byte *releaseTarget();
+
+	uint32 getBytesWritten() const { return _bytesWritten; }
 
 protected:
+	enum {
+		kLookupBits = 8
+	};
+
+	/** Result of decoding kLookupBits bits at once */
+	struct HuffmanEntry {
+		uint16 value;	///< decoded value, or the tree node to go on from
+		byte bits;		///< number of bits used
+		bool leaf;		///< if value is a decoded value
+	};
+
 	/**
 	 * Initialize decompressor.
-	 * @param sourceStream	source stream to read from
-	 * @param targetStream	target memory stream to write to
+	 * @param source		source data to read from
+	 * @param sourceSize	size of the source data
+	 * @param target		target buffer to write to
 	 */
-	void init(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize);
+	void init(const byte *source, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize);
 
 	/**
 	 * Get a number of bits from _src stream, starting with the least
@@ -57,40 +94,51 @@ protected:
 	void fetchBitsLSB();
 
 	/**
-	 * Write one byte into _dest stream
-	 * @param b byte to put
+	 * Make room for at least size more bytes in a target of dynamic size.
 	 */
-	void putByte(byte b);
+	void reserveTarget(uint32 size);
+
+	int huffman_lookup(const int *tree, const HuffmanEntry *table);
 
-	int huffman_lookup(const int *tree);
+	static void buildTable(const int *tree, HuffmanEntry *table);
 
 	uint32 _dwBits;			///< bits buffer
 	byte _nBits;			///< number of unread bits in _dwBits
-	uint32 _sourceSize;		///< size of the source stream
-	uint32 _targetSize;		///< size of the target stream (if fixed)
+	uint32 _targetSize;		///< size of the target buffer
 	bool _targetFixedSize;  ///< if target stream is fixed size or dynamic size
-	uint32 _bytesRead;		///< number of bytes read from _sourceStream
-	uint32 _bytesWritten;	///< number of bytes written to _targetStream
-	SeekableReadStream *_sourceStream;
-	WriteStream *_targetStream;
+	uint32 _bytesWritten;	///< number of bytes written to _target
+	const byte *_source;	///< next byte of the source data
+	const byte *_sourceEnd;	///< end of the source data
+	byte *_target;
+
+	static HuffmanEntry _lengthTable[1 << kLookupBits];
+	static HuffmanEntry _distanceTable[1 << kLookupBits];
+	static HuffmanEntry _asciiTable[1 << kLookupBits];
+	static bool _tablesBuilt;
 };
 
-void DecompressorDCL::init(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize) {
-	_sourceStream = sourceStream;
-	_targetStream = targetStream;
-	_sourceSize = sourceStream->size();
-	_targetSize = targetSize;
+DecompressorDCL::HuffmanEntry DecompressorDCL::_lengthTable[1 << kLookupBits];
+DecompressorDCL::HuffmanEntry DecompressorDCL::_distanceTable[1 << kLookupBits];
+DecompressorDCL::HuffmanEntry DecompressorDCL::_asciiTable[1 << kLookupBits];
+bool DecompressorDCL::_tablesBuilt = false;
+
+void DecompressorDCL::init(const byte *source, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize) {
+	_source = source;
+	_sourceEnd = source + sourceSize;
+	_target = target;
+	_targetSize = targetFixedSize ? targetSize : 0;
 	_targetFixedSize = targetFixedSize;
 	_nBits = 0;
-	_bytesRead = _bytesWritten = 0;
+	_bytesWritten = 0;
 	_dwBits = 0;
 }
 
 void DecompressorDCL::fetchBitsLSB() {
+	// Past the end of the source data, zeros are read
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_sourceStream->readByte()) << _nBits;
+		if (_source < _sourceEnd)
+			_dwBits |= ((uint32)*_source++) << _nBits;
 		_nBits += 8;
-		_bytesRead++;
 	}
 }
 
@@ -108,9 +156,21 @@ byte DecompressorDCL::getByteLSB() {
 	return getBitsLSB(8);
 }
 
-void DecompressorDCL::putByte(byte b) {
-	_targetStream->writeByte(b);
-	_bytesWritten++;
+void DecompressorDCL::reserveTarget(uint32 size) {
+	if (_bytesWritten + size <= _targetSize)
+		return;
+
+	_targetSize = MAX<uint32>(MAX<uint32>(_targetSize * 2, 4096), _bytesWritten + size);
+	_target = (byte *)realloc(_target, _targetSize);
+	if (!_target)
+		error("DCL-INFLATE: Out of memory");
+}
+
+byte *DecompressorDCL::releaseTarget() {
+	byte *target = _target;
+	_target = nullptr;
+	_targetSize = 0;
+	return target;
 }
 
 #define HUFFMAN_LEAF 0x40000000
@@ -316,34 +376,83 @@ static const int ascii_tree[] = {
 	LN(509, 128)      LN(510, 26)
 };
 
-int DecompressorDCL::huffman_lookup(const int *tree) {
-	int pos = 0;
+void DecompressorDCL::buildTable(const int *tree, HuffmanEntry *table) {
+	// Walk the tree for every possible value of the next kLookupBits bits,
+	// so that most codes can be decoded with a single lookup
+	for (uint i = 0; i < (uint)(1 << kLookupBits); i++) {
+		int pos = 0;
+		byte bits = 0;
 
+		while (!(tree[pos] & HUFFMAN_LEAF) && bits < kLookupBits) {
+			pos = ((i >> bits) & 1) ? tree[pos] & 0xFFF : tree[pos] >> 12;
+			bits++;
+		}
+
+		table[i].leaf = (tree[pos] & HUFFMAN_LEAF) != 0;
+		table[i].value = table[i].leaf ? tree[pos] & 0xFFFF : pos;
+		table[i].bits = bits;
+	}
+}
+
+DecompressorDCL::DecompressorDCL() : _targetSize(0), _targetFixedSize(true), _bytesWritten(0), _target(nullptr) {
+	if (!_tablesBuilt) {
+		buildTable(length_tree, _lengthTable);
+		buildTable(distance_tree, _distanceTable);
+		buildTable(ascii_tree, _asciiTable);
+		_tablesBuilt = true;
+	}
+}
+
+int DecompressorDCL::huffman_lookup(const int *tree, const HuffmanEntry *table) {
+	if (_nBits < kLookupBits)
+		fetchBitsLSB();
+	const HuffmanEntry &entry = table[_dwBits & ((1 << kLookupBits) - 1)];
+	_dwBits >>= entry.bits;
+	_nBits -= entry.bits;
+
+	if (entry.leaf)
+		return entry.value;
+
+	// The code is longer than the lookup bits, follow the tree bit by bit
+	int pos = entry.value;
 	while (!(tree[pos] & HUFFMAN_LEAF)) {
 		int bit = getBitsLSB(1);
-		debug(8, "[%d]:%d->", pos, bit);
 		pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
 	}
 
-	debug(8, "=%02x\n", tree[pos] & 0xffff);
 	return tree[pos] & 0xFFFF;
 }
 
 #define DCL_BINARY_MODE 0
 #define DCL_ASCII_MODE 1
 
-#define MIDI_SETUP_BUNDLE_FILE_MAXIMUM_DICTIONARY_SIZE 4096
+bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize) {
+	sourceSize = MIN<uint32>(sourceSize, sourceStream->size() - sourceStream->pos());
 
-bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize) {
-	byte   dictionary[MIDI_SETUP_BUNDLE_FILE_MAXIMUM_DICTIONARY_SIZE];
-	uint16 dictionaryPos = 0;
-	uint16 dictionarySize = 0;
-	uint16 dictionaryMask = 0;
+	// Streams which are in memory are decompressed in place
+	const byte *data = sourceStream->getDataPtr();
+	if (data) {
+		data += sourceStream->pos();
+		sourceStream->seek(sourceSize, SEEK_CUR);
+		return unpack(data, sourceSize, target, targetSize, targetFixedSize);
+	}
+
+	byte *sourceBufferPtr = (byte *)malloc(sourceSize);
+	if (!sourceBufferPtr)
+		return false;
+
+	sourceSize = sourceStream->read(sourceBufferPtr, sourceSize);
+	bool success = unpack(sourceBufferPtr, sourceSize, target, targetSize, targetFixedSize);
+	free(sourceBufferPtr);
+	return success;
+}
+
+bool DecompressorDCL::unpack(const byte *source, uint32 sourceSize, byte *target, uint32 targetSize, bool targetFixedSize) {
 	int value;
 	uint16 tokenOffset = 0;
 	uint16 tokenLength = 0;
 
-	init(sourceStream, targetStream, targetSize, targetFixedSize);
+	init(source, sourceSize, target, targetSize, targetFixedSize);
 
 	byte mode = getByteLSB();
 	byte dictionaryType = getByteLSB();
@@ -356,25 +465,22 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 	// TODO: original code supported 3 as well???
 	// Was this an accident or on purpose? And the original code did just give out a warning
 	// and didn't error out at all
+	// The dictionary types stand for 1024, 2048 and 4096 bytes. The target
+	// itself is used as the dictionary, as the largest offsets of each type
+	// are exactly the dictionary size.
 	switch (dictionaryType) {
 	case 4:
-		dictionarySize = 1024;
-		break;
 	case 5:
-		dictionarySize = 2048;
-		break;
 	case 6:
-		dictionarySize = 4096;
 		break;
 	default:
 		warning("DCL-INFLATE: Error: unsupported dictionary type %02x", dictionaryType);
 		return false;
 	}
-	dictionaryMask = dictionarySize - 1;
 
-	while ((!targetFixedSize) || (_bytesWritten < _targetSize)) {
+	while ((!_targetFixedSize) || (_bytesWritten < _targetSize)) {
 		if (getBitsLSB(1)) { // (length,distance) pair
-			value = huffman_lookup(length_tree);
+			value = huffman_lookup(length_tree, _lengthTable);
 
 			if (value < 8)
 				tokenLength = value + 2;
@@ -384,9 +490,7 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 			if (tokenLength == 519)
 				break; // End of stream signal
 
-			debug(8, " | ");
-
-			value = huffman_lookup(distance_tree);
+			value = huffman_lookup(distance_tree, _distanceTable);
 
 			if (tokenLength == 2)
 				tokenOffset = (value << 2) | getBitsLSB(2);
@@ -394,7 +498,7 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 				tokenOffset = (value << dictionaryType) | getBitsLSB(dictionaryType);
 			tokenOffset++;
 
-			debug(8, "\nCOPY(%d from %d)\n", tokenLength, tokenOffset);
+			debug(8, "COPY(%d from %d)", tokenLength, tokenOffset);
 
 			if (_targetFixedSize) {
 				if (tokenLength + _bytesWritten > _targetSize) {
@@ -402,6 +506,8 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 							tokenLength, _targetSize, _bytesWritten, tokenLength);
 					return false;
 				}
+			} else {
+				reserveTarget(tokenLength);
 			}
 
 			if (_bytesWritten < tokenOffset) {
@@ -410,41 +516,20 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 				return false;
 			}
 
-			uint16 dictionaryBaseIndex = (dictionaryPos - tokenOffset) & dictionaryMask;
-			uint16 dictionaryIndex = dictionaryBaseIndex;
-			uint16 dictionaryNextIndex = dictionaryPos;
-
-			while (tokenLength) {
-				// Write byte from dictionary
-				putByte(dictionary[dictionaryIndex]);
-				debug(9, "\33[32;31m%02x\33[37;37m ", dictionary[dictionaryIndex]);
-
-				dictionary[dictionaryNextIndex] = dictionary[dictionaryIndex];
-
-				dictionaryNextIndex = (dictionaryNextIndex + 1) & dictionaryMask;
-				dictionaryIndex = (dictionaryIndex + 1) & dictionaryMask;
-
-				if (dictionaryIndex == dictionaryPos)
-					dictionaryIndex = dictionaryBaseIndex;
-				if (dictionaryNextIndex == dictionarySize)
-					dictionaryNextIndex = 0;
-
-				tokenLength--;
-			}
-			dictionaryPos = dictionaryNextIndex;
-			debug(9, "\n");
+			// Copy byte by byte, so that copies overlapping their own output
+			// repeat the last tokenOffset bytes
+			byte *dest = _target + _bytesWritten;
+			const byte *src = dest - tokenOffset;
+			_bytesWritten += tokenLength;
+			while (tokenLength--)
+				*dest++ = *src++;
 
 		} else { // Copy byte verbatim
-			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree) : getByteLSB();
-			putByte(value);
-
-			// Also remember it inside dictionary
-			dictionary[dictionaryPos] = value;
-			dictionaryPos++;
-			if (dictionaryPos >= dictionarySize)
-				dictionaryPos = 0;
+			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree, _asciiTable) : getByteLSB();
 
-			debug(9, "\33[32;31m%02x \33[37;37m", value);
+			if (!_targetFixedSize)
+				reserveTarget(1);
+			_target[_bytesWritten++] = value;
 		}
 	}
 
@@ -470,29 +555,21 @@ bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpack
 	// Read source into memory
 	src->read(sourceBufferPtr, packedSize);
 
-	Common::MemoryReadStream  *sourceStream = new MemoryReadStream(sourceBufferPtr, packedSize, DisposeAfterUse::NO);
-	Common::MemoryWriteStream *targetStream = new MemoryWriteStream(dest, unpackedSize);
-
-	success = dcl.unpack(sourceStream, targetStream, unpackedSize, true);
-	delete sourceStream;
-	delete targetStream;
+	success = dcl.unpack(sourceBufferPtr, packedSize, dest, unpackedSize, true);
+	free(sourceBufferPtr);
 	return success;
 }
 
 SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream, uint32 packedSize, uint32 unpackedSize) {
 	bool success = false;
 	byte *targetPtr = nullptr;
-	Common::MemoryWriteStream *targetStream;
 	DecompressorDCL dcl;
 
 	targetPtr = (byte *)malloc(unpackedSize);
 	if (!targetPtr)
 		return nullptr;
 
-	targetStream = new MemoryWriteStream(targetPtr, unpackedSize);
-
-	success = dcl.unpack(sourceStream, targetStream, unpackedSize, true);
-	delete targetStream;
+	success = dcl.unpack(sourceStream, packedSize, targetPtr, unpackedSize, true);
 
 	if (!success) {
 		free(targetPtr);
@@ -504,18 +581,14 @@ SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream, uint32 packe
 // This one figures out the unpacked size by itself
 // Needed for at least Simon 2, because the unpacked size is not stored anywhere
 SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream) {
-	Common::MemoryWriteStreamDynamic *targetStream;
 	DecompressorDCL dcl;
 
-	targetStream = new MemoryWriteStreamDynamic(DisposeAfterUse::NO);
-
-	if (dcl.unpack(sourceStream, targetStream, 0, false)) {
-		byte *targetPtr = targetStream->getData();
-		uint32 unpackedSize = targetStream->size();
-		delete targetStream;
-		return new MemoryReadStream(targetPtr, unpackedSize, DisposeAfterUse::YES);
+	const bool success = dcl.unpack(sourceStream, sourceStream->size() - sourceStream->pos(), nullptr, 0, false);
+	byte *targetPtr = dcl.releaseTarget();
+	if (success) {
+		return new MemoryReadStream(targetPtr, dcl.getBytesWritten(), DisposeAfterUse::YES);
 	}
-	delete targetStream;
+	free(targetPtr);
 	return nullptr;
 }
 
@@ -20,6 +20,8 @@
  *
  */
 
+#include "common/bufferedstream.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -69,6 +71,15 @@ FSNode FSNode::getChild(const String &n) const {
 	return FSNode(node);
 }
 
+FSNode FSNode::getKnownChild(const String &n, bool isDirectory) const {
+	// If this node is invalid or not a directory, return an invalid node
+	if (_realNode == 0 || !_realNode->isDirectory())
+		return FSNode();
+
+	AbstractFSNode *node = _realNode->getKnownChild(n, isDirectory);
+	return FSNode(node);
+}
+
 bool FSNode::getChildren(FSList &fslist, ListMode mode, bool hidden) const {
 	if (!_realNode || !_realNode->isDirectory())
 		return false;
@@ -125,6 +136,14 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+uint32 FSNode::getModificationTime() const {
+	return _realNode ? _realNode->getModificationTime() : 0;
+}
+
+int32 FSNode::getFileSize() const {
+	return _realNode ? _realNode->getFileSize() : -1;
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -140,6 +159,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createMappedReadStream() const {
+	if (_realNode == 0)
+		return 0;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createMappedReadStream: '%s' does not exist", getName().c_str());
+		return 0;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createMappedReadStream: '%s' is a directory", getName().c_str());
+		return 0;
+	}
+
+	return _realNode->createMappedReadStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -152,22 +186,27 @@ WriteStream *FSNode::createWriteStream() const {
 	return _realNode->createWriteStream();
 }
 
+void FSNode::prefetch(uint32 offset, uint32 size) const {
+	if (_realNode)
+		_realNode->prefetch(offset, size);
+}
+
 FSDirectory::FSDirectory(const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _indexDirty(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _indexDirty(false) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::FSDirectory(const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _indexDirty(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _indexDirty(false) {
 
 	setPrefix(prefix);
 }
@@ -186,6 +225,140 @@ FSNode FSDirectory::getFSNode() const {
 	return _node;
 }
 
+/** The version of the directory index file format */
+static const int kDirectoryIndexVersion = 1;
+
+void FSDirectory::enableIndex() {
+	if (_cached)
+		return;
+
+	_indexName = String::format("dirindex-%08x.idx", hashit(_node.getPath()));
+}
+
+void FSDirectory::loadIndex() const {
+	InSaveFile *in = g_system->getSavefileManager()->openForLoading(_indexName);
+	if (!in)
+		return;
+
+	// Header: <version> then the path of the directory, in case of hash clashes
+	int version = 0;
+	if (sscanf(in->readLine().c_str(), "%d", &version) != 1 || version != kDirectoryIndexVersion ||
+	    in->readLine() != _node.getPath()) {
+		delete in;
+		return;
+	}
+
+	// Each directory: <mtime> <count> <path>, followed by count names
+	IndexEntry *entry = 0;
+	uint count = 0;
+	while (!in->eos() && !in->err()) {
+		String line = in->readLine();
+
+		if (count > 0) {
+			entry->names.push_back(line);
+			count--;
+			continue;
+		}
+
+		uint32 mtime;
+		int pathPos;
+		if (sscanf(line.c_str(), "%u %u %n", &mtime, &count, &pathPos) != 2)
+			break;
+
+		entry = &_index[line.c_str() + pathPos];
+		entry->mtime = mtime;
+		entry->used = false;
+		entry->names.clear();
+	}
+
+	if (in->err() || count > 0) {
+		// Don't trust a damaged index
+		warning("FSDirectory::loadIndex: Failed to read '%s'", _indexName.c_str());
+		_index.clear();
+	}
+
+	delete in;
+}
+
+void FSDirectory::saveIndex() const {
+	// Drop the directories which are no longer part of the cache
+	for (Index::iterator i = _index.begin(); i != _index.end(); ++i) {
+		if (!i->_value.used) {
+			_index.erase(i);
+			_indexDirty = true;
+		}
+	}
+
+	if (!_indexDirty)
+		return;
+
+	OutSaveFile *out = g_system->getSavefileManager()->openForSaving(_indexName, false);
+	if (!out)
+		return;
+
+	out->writeString(String::format("%d\n%s\n", kDirectoryIndexVersion, _node.getPath().c_str()));
+	for (Index::const_iterator i = _index.begin(); i != _index.end(); ++i) {
+		out->writeString(String::format("%u %u %s\n", i->_value.mtime, i->_value.names.size(), i->_key.c_str()));
+		for (uint j = 0; j < i->_value.names.size(); j++)
+			out->writeString(i->_value.names[j] + "\n");
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("FSDirectory::saveIndex: Failed to write '%s'", _indexName.c_str());
+
+	delete out;
+	_indexDirty = false;
+}
+
+void FSDirectory::listDirectory(const FSNode &node, FSList &list) const {
+	if (_indexName.empty()) {
+		node.getChildren(list, FSNode::kListAll, true);
+		return;
+	}
+
+	const String path = node.getPath();
+	const uint32 mtime = node.getModificationTime();
+
+	Index::iterator i = _index.find(path);
+	if (i != _index.end() && mtime != 0 && i->_value.mtime == mtime) {
+		// Adding or removing an entry changes the modification time of a
+		// directory, so the listing is still valid
+		i->_value.used = true;
+		for (uint j = 0; j < i->_value.names.size(); j++) {
+			String name = i->_value.names[j];
+			const bool isDirectory = (name.lastChar() == '/');
+			if (isDirectory)
+				name.deleteLastChar();
+			list.push_back(node.getKnownChild(name, isDirectory));
+		}
+		return;
+	}
+
+	node.getChildren(list, FSNode::kListAll, true);
+
+	if (i != _index.end()) {
+		_index.erase(i);
+		_indexDirty = true;
+	}
+
+	// The index is line based, so names with line breaks can't be stored
+	if (mtime == 0 || path.contains('\n') || path.contains('\r'))
+		return;
+
+	IndexEntry entry;
+	entry.mtime = mtime;
+	entry.used = true;
+	for (FSList::const_iterator it = list.begin(); it != list.end(); ++it) {
+		if (it->getName().contains('\n') || it->getName().contains('\r'))
+			return;
+		entry.names.push_back(it->isDirectory() ? it->getName() + "/" : it->getName());
+	}
+
+	_index[path] = entry;
+	_indexDirty = true;
+}
+
 FSNode *FSDirectory::lookupCache(NodeCache &cache, const String &name) const {
 	// make caching as lazy as possible
 	if (!name.empty()) {
@@ -237,6 +410,35 @@ SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) c
 	return stream;
 }
 
+SeekableReadStream *FSDirectory::createMappedReadStreamForMember(const String &name) const {
+	if (name.empty() || !_node.isDirectory())
+		return 0;
+
+	FSNode *node = lookupCache(_fileCache, name);
+	if (!node)
+		return 0;
+	SeekableReadStream *stream = node->createMappedReadStream();
+	if (!stream)
+		warning("FSDirectory::createMappedReadStreamForMember: Can't create stream for file '%s'", name.c_str());
+
+	return stream;
+}
+
+SeekableReadStream *FSDirectory::createReadAheadStreamForMember(const String &name, uint32 bufSize) const {
+	// Every stream has a file handle of its own, so it can be read from
+	// the read ahead thread
+	return wrapReadAheadSeekableReadStream(createReadStreamForMember(name), bufSize, DisposeAfterUse::YES);
+}
+
+void FSDirectory::prefetchMember(const String &name, uint32 offset, uint32 size) const {
+	if (name.empty() || !_node.isDirectory())
+		return;
+
+	FSNode *node = lookupCache(_fileCache, name);
+	if (node)
+		node->prefetch(offset, size);
+}
+
 FSDirectory *FSDirectory::getSubDirectory(const String &name, int depth, bool flat) {
 	return getSubDirectory(String(), name, depth, flat);
 }
@@ -257,7 +459,7 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String&
 		return;
 
 	FSList list;
-	node.getChildren(list, FSNode::kListAll, true);
+	listDirectory(node, list);
 
 	FSList::iterator it = list.begin();
 	for ( ; it != list.end(); ++it) {
@@ -292,8 +494,17 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String&
 void FSDirectory::ensureCached() const  {
 	if (_cached)
 		return;
+
+	if (!_indexName.empty())
+		loadIndex();
+
 	cacheDirectoryRecursive(_node, _depth, _prefix);
 	_cached = true;
+
+	if (!_indexName.empty()) {
+		saveIndex();
+		_index.clear();
+	}
 }
 
 int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -122,6 +122,18 @@ public:
 	 */
 	FSNode getChild(const String &name) const;
 
+	/**
+	 * Create a new node referring to a child node of the current node, which
+	 * must be a directory node, like getChild(). The child is known to exist,
+	 * and to be a directory or not, e.g. because of an earlier listing of this
+	 * directory, which may save querying the file system.
+	 *
+	 * @param name			the name of a child of this directory
+	 * @param isDirectory	whether the child is a directory
+	 * @return the node referring to the child with the given name
+	 */
+	FSNode getKnownChild(const String &name, bool isDirectory) const;
+
 	/**
 	 * Return a list of all child nodes of this directory node. If called on a node
 	 * that does not represent a directory, false is returned.
@@ -206,6 +218,23 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Returns the time the object referred by this node was last modified.
+	 * The value is in seconds since an unspecified epoch, thus only
+	 * comparing it with an earlier value of the same node is meaningful.
+	 *
+	 * @return the modification time, or 0 if it is not known.
+	 */
+	uint32 getModificationTime() const;
+
+	/**
+	 * Returns the size of the file referred by this node, without opening
+	 * it.
+	 *
+	 * @return the size in bytes, or -1 if it is not known.
+	 */
+	int32 getFileSize() const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -215,6 +244,20 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance like createReadStream(), which
+	 * keeps the data of the file in memory where this is cheap, e.g. by
+	 * mapping the file. Its data can then be used in place through
+	 * SeekableReadStream::getDataPtr().
+	 *
+	 * Only use this for large files which are read many times, and which
+	 * nothing else writes to while they are open, like the resource volumes
+	 * of a game. If a mapped file is truncated, accessing its data crashes.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -223,6 +266,16 @@ public:
 	 * @return pointer to the stream object, 0 in case of a failure
 	 */
 	WriteStream *createWriteStream() const;
+
+	/**
+	 * Hints that a part of the file referred by this node is going to be
+	 * read soon. Where supported, the file system then starts reading it in
+	 * the background, so that the reads of the caller do not have to wait.
+	 *
+	 * @param offset the start of the part of the file
+	 * @param size   the size of the part of the file, 0 for up to its end
+	 */
+	void prefetch(uint32 offset = 0, uint32 size = 0) const;
 };
 
 /**
@@ -276,6 +329,25 @@ class FSDirectory : public Archive {
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const String &name) const;
 
+	// listing of a directory in the index; the names of subdirectories end in a slash
+	struct IndexEntry {
+		uint32 mtime;
+		bool used;
+		Array<String> names;
+	};
+	// Key is the path of the directory
+	typedef HashMap<String, IndexEntry> Index;
+	mutable Index _index;
+	String _indexName;	// name of the index in the savefile directory, empty if none is used
+	mutable bool _indexDirty;
+
+	// list a directory, using the index if possible
+	void listDirectory(const FSNode &node, FSList &list) const;
+
+	// index management
+	void loadIndex() const;
+	void saveIndex() const;
+
 	// cache management
 	void cacheDirectoryRecursive(FSNode node, int depth, const String& prefix) const;
 
@@ -307,6 +379,19 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Keep an index of the listings of the cached directories in the savefile
+	 * directory. When the cache is filled again later, e.g. the next time a
+	 * game is started, the listing of each directory in the index is used
+	 * instead of listing the directory again, as long as the modification time
+	 * of the directory did not change. Thus, only the modification time of each
+	 * directory has to be queried.
+	 *
+	 * Has no effect if the cache has been filled already, or if the file system
+	 * does not provide modification times.
+	 */
+	void enableIndex();
+
 	/**
 	 * Create a new FSDirectory pointing to a sub directory of the instance. See class comment
 	 * for an explanation of the prefix parameter.
@@ -342,6 +427,24 @@ public:
 	 * for success.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Open the specified file with FSNode::createMappedReadStream(). A full
+	 * match of relative path and filename is needed for success.
+	 */
+	virtual SeekableReadStream *createMappedReadStreamForMember(const String &name) const;
+
+	/**
+	 * Open the specified file, reading ahead on a worker thread. A full
+	 * match of relative path and filename is needed for success.
+	 */
+	virtual SeekableReadStream *createReadAheadStreamForMember(const String &name, uint32 bufSize) const;
+
+	/**
+	 * Hint that a part of the specified file is going to be read soon. A full match
+	 * of relative path and filename is needed for success.
+	 */
+	virtual void prefetchMember(const String &name, uint32 offset = 0, uint32 size = 0) const;
 };
 
 
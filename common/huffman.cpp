@@ -58,6 +58,49 @@ Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const u
 		// And put the pointer to the symbol/code struct into the symbol list.
 		_symbols[i] = &_codes[lengths[i] - 1].back();
 	}
+
+	buildLookupTables(codeCount, codes, lengths);
+}
+
+void Huffman::buildLookupTables(uint32 codeCount, const uint32 *codes, const uint8 *lengths) {
+	_lookupBits = MIN<uint32>(_codes.size(), kMaxLookupBits);
+	if (codeCount > 0xFFFF) {
+		_lookupBits = 0;
+		return;
+	}
+
+	const uint32 tableSize = 1 << _lookupBits;
+	LookupEntry empty;
+	empty.index = 0;
+	empty.length = 0;
+	_lookupMSB.resize(tableSize);
+	_lookupLSB.resize(tableSize);
+	for (uint32 i = 0; i < tableSize; i++)
+		_lookupMSB[i] = _lookupLSB[i] = empty;
+
+	// Go through the codes in the order getSymbol() checks them, so that the
+	// first matching code wins for broken code sets as well
+	for (uint32 length = 1; length <= _lookupBits; length++) {
+		for (uint32 code = 0; code < codeCount; code++) {
+			if (lengths[code] != length || (codes[code] >> length))
+				continue;
+
+			LookupEntry entry;
+			entry.index = code;
+			entry.length = length;
+
+			// MSB to LSB: the code is in the top bits of the looked up value
+			const uint32 first = codes[code] << (_lookupBits - length);
+			for (uint32 i = 0; i < (1U << (_lookupBits - length)); i++)
+				if (!_lookupMSB[first + i].length)
+					_lookupMSB[first + i] = entry;
+
+			// LSB to MSB: the code is in the bottom bits of the looked up value
+			for (uint32 i = 0; i < (1U << (_lookupBits - length)); i++)
+				if (!_lookupLSB[codes[code] | (i << length)].length)
+					_lookupLSB[codes[code] | (i << length)] = entry;
+		}
+	}
 }
 
 Huffman::~Huffman() {
@@ -69,6 +112,17 @@ void Huffman::setSymbols(const uint32 *symbols) {
 }
 
 uint32 Huffman::getSymbol(BitStream &bits) const {
+	// Decode short codes with a single lookup
+	if (_lookupBits) {
+		const LookupTable &table = bits.isMSBFirst() ? _lookupMSB : _lookupLSB;
+		const LookupEntry &entry = table[bits.peekBits(_lookupBits)];
+		if (entry.length) {
+			bits.skip(entry.length);
+			return _symbols[entry.index]->symbol;
+		}
+	}
+
+	// Longer codes are searched for bit by bit
 	uint32 code = 0;
 
 	for (uint32 i = 0; i < _codes.size(); i++) {
@@ -75,6 +75,26 @@ private:
 
 	/** Sorted list of pointers to the symbols. */
 	SymbolList _symbols;
+
+	enum {
+		kMaxLookupBits = 9
+	};
+
+	/** The code starting with a given value of the next _lookupBits bits. */
+	struct LookupEntry {
+		uint16 index;  ///< Index of the code in _symbols.
+		uint8 length;  ///< Length of the code, 0 if it is longer than _lookupBits.
+	};
+
+	typedef Array<LookupEntry> LookupTable;
+
+	/** Number of bits decoded with a single lookup, 0 if there are no lookup tables. */
+	uint8 _lookupBits;
+
+	/** Lookup tables for bit streams handing out their bits MSB to LSB, and LSB to MSB. */
+	LookupTable _lookupMSB, _lookupLSB;
+
+	void buildLookupTables(uint32 codeCount, const uint32 *codes, const uint8 *lengths);
 };
 
 } // End of namespace Common
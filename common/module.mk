@@ -31,6 +31,7 @@ MODULE_OBJS := \
 	stream.o \
 	system.o \
 	textconsole.o \
+	threadpool.o \
 	timestamp.o \
 	tokenizer.o \
 	translation.o \
@@ -47,6 +47,17 @@ typedef SeekableReadStream InSaveFile;
 typedef WriteStream OutSaveFile;
 
 
+/**
+ * The savefiles which have been accessed while a SaveFileManager was
+ * logging accesses. See SaveFileManager::setAccessLog().
+ */
+struct SavefileAccessLog {
+	/** The names of the savefiles opened for loading */
+	StringArray names;
+	/** The patterns passed to listSavefiles */
+	StringArray patterns;
+};
+
 /**
  * The SaveFileManager is serving as a factory for InSaveFile
  * and OutSaveFile objects.
@@ -65,6 +76,7 @@ class SaveFileManager : NonCopyable {
 protected:
 	Error _error;
 	String _errorDesc;
+	SavefileAccessLog *_accessLog;
 
 	/**
 	 * Set some information about the last error which occurred .
@@ -74,6 +86,7 @@ protected:
 	virtual void setError(Error error, const String &errorDesc) { _error = error; _errorDesc = errorDesc; }
 
 public:
+	SaveFileManager() : _accessLog(0) {}
 	virtual ~SaveFileManager() {}
 
 	/**
@@ -161,6 +174,45 @@ public:
 	 * @see Common::matchString()
 	 */
 	virtual StringArray listSavefiles(const String &pattern) = 0;
+
+	/**
+	 * Wait until all savefiles which are still being written in the
+	 * background are on disk. Savefile managers which always write
+	 * synchronously have nothing to wait for.
+	 * @return true if all of them were written successfully. Otherwise,
+	 *         the last error is set accordingly.
+	 */
+	virtual bool flushPendingSaves() { return true; }
+
+	/**
+	 * Returns the number of savefiles which are still being written in the
+	 * background, so that callers can report when saving has completed.
+	 */
+	virtual uint getPendingSaveCount() { return 0; }
+
+	/**
+	 * Returns a value which changes whenever the given savefile is written
+	 * or removed, e.g. based on its modification time. Together with
+	 * setAccessLog(), this allows caching information read from savefiles.
+	 * @param name	the name of the savefile
+	 * @return the stamp of the savefile, or 0 if the savefile does not exist
+	 *         or no such value is available.
+	 */
+	virtual uint32 getSavefileStamp(const String &name) { return 0; }
+
+	/**
+	 * Add the names of all savefiles opened for loading, and all patterns
+	 * passed to listSavefiles(), to the given log, until logging is stopped
+	 * again by passing 0. Savefile managers which don't provide stamps for
+	 * their savefiles don't need to log accesses.
+	 * @param log	the log to add accesses to, or 0
+	 * @return the log which was used before
+	 */
+	SavefileAccessLog *setAccessLog(SavefileAccessLog *log) {
+		SavefileAccessLog *oldLog = _accessLog;
+		_accessLog = log;
+		return oldLog;
+	}
 };
 
 } // End of namespace Common
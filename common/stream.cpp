@@ -25,6 +25,7 @@
 #include "common/memstream.h"
 #include "common/substream.h"
 #include "common/str.h"
+#include "common/threadpool.h"
 
 namespace Common {
 
@@ -432,6 +433,255 @@ SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStr
 
 namespace {
 
+/**
+ * Wrapper class which reads the next part of any given SeekableReadStream
+ * on a worker thread, while the current part is being read.
+ * @see wrapReadAheadSeekableReadStream
+ */
+class ReadAheadSeekableReadStream : public SeekableReadStream {
+public:
+	ReadAheadSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
+	virtual ~ReadAheadSeekableReadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr();
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _bufStart + _pos; }
+	virtual int32 size() const { return _size; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		/**
+		 * Number of buffers which have to be read through one after the
+		 * other, before the next one is read ahead.
+		 */
+		kSequentialRefills = 2
+	};
+
+	class ReadJob;
+	friend class ReadJob;
+
+	/** Reads the next buffer from the parent stream, on the worker thread */
+	class ReadJob : public ThreadJob {
+	public:
+		ReadJob(ReadAheadSeekableReadStream *stream) : _stream(stream) {}
+
+		virtual void run() {
+			_stream->_nextBufSize = _stream->_parentStream->read(_stream->_nextBuf, _stream->_realBufSize);
+		}
+
+	private:
+		ReadAheadSeekableReadStream *_stream;
+	};
+
+	/** Wait for the buffer being read ahead, if there is one */
+	void finishReadAhead();
+
+	/** Make the buffer start at the current end of the buffer */
+	void refill();
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _realBufSize;
+	const int32 _size;
+	bool _eos;
+	/** The error state of the parent stream, as of the data read so far */
+	bool _err;
+
+	byte *_buf;
+	int32 _bufStart;
+	uint32 _bufSize;
+	uint32 _pos;
+
+	/** The position of the parent stream, while nothing is read ahead */
+	int32 _parentPos;
+	uint _sequentialRefills;
+
+	/**
+	 * @name The buffer read ahead
+	 * It starts at _parentPos, and must not be touched while _readAhead is
+	 * set, except by the worker thread.
+	 */
+	//@{
+	byte *_nextBuf;
+	uint32 _nextBufSize;
+	bool _readAhead;
+	//@}
+
+	/** The worker thread, created once the stream is read sequentially */
+	ThreadPool *_readThread;
+	ReadJob _readJob;
+	bool _readThreadFailed;
+};
+
+ReadAheadSeekableReadStream::ReadAheadSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	_realBufSize(bufSize),
+	_size(parentStream->size()),
+	_eos(false),
+	_err(false),
+	_bufStart(parentStream->pos()),
+	_bufSize(0),
+	_pos(0),
+	_parentPos(parentStream->pos()),
+	_sequentialRefills(0),
+	_nextBufSize(0),
+	_readAhead(false),
+	_readThread(0),
+	_readJob(this),
+	_readThreadFailed(false) {
+
+	assert(parentStream);
+	_buf = new byte[bufSize];
+	_nextBuf = new byte[bufSize];
+	assert(_buf && _nextBuf);
+}
+
+ReadAheadSeekableReadStream::~ReadAheadSeekableReadStream() {
+	// Waits for the buffer being read ahead
+	delete _readThread;
+
+	delete[] _buf;
+	delete[] _nextBuf;
+}
+
+void ReadAheadSeekableReadStream::clearErr() {
+	finishReadAhead();
+	_eos = _err = false;
+	_parentStream->clearErr();
+}
+
+void ReadAheadSeekableReadStream::finishReadAhead() {
+	if (!_readAhead)
+		return;
+
+	_readThread->wait();
+	_readAhead = false;
+	_parentPos += _nextBufSize;
+}
+
+void ReadAheadSeekableReadStream::refill() {
+	const int32 start = _bufStart + _bufSize;
+	const bool wasReadAhead = _readAhead;
+
+	finishReadAhead();
+
+	if (wasReadAhead) {
+		// The next buffer was read ahead while the current one was used
+		SWAP(_buf, _nextBuf);
+		_bufSize = _nextBufSize;
+		_sequentialRefills++;
+		_err = _parentStream->err();
+	} else {
+		if (_parentPos != start) {
+			_parentStream->seek(start);
+			_parentPos = start;
+		}
+
+		if (_bufSize != 0)
+			_sequentialRefills++;
+
+		_bufSize = _parentStream->read(_buf, _realBufSize);
+		_parentPos += _bufSize;
+		_err = _parentStream->err();
+	}
+
+	_bufStart = start;
+	_pos = 0;
+
+	// Only streams which are read from start to end benefit from reading
+	// ahead. Reading ahead stops at the end of the parent stream.
+	if (_sequentialRefills < kSequentialRefills || _bufSize < _realBufSize || _readThreadFailed)
+		return;
+
+	if (!_readThread) {
+		_readThread = new ThreadPool(1, "ReadAhead");
+		if (!_readThread->getThreadCount()) {
+			delete _readThread;
+			_readThread = 0;
+			_readThreadFailed = true;
+			return;
+		}
+	}
+
+	_readAhead = true;
+	_readThread->addJob(&_readJob);
+}
+
+uint32 ReadAheadSeekableReadStream::read(void *dataPtr, uint32 dataSize) {
+	uint32 alreadyRead = 0;
+
+	while (dataSize > 0) {
+		if (_pos == _bufSize) {
+			refill();
+
+			if (_bufSize == 0) {
+				// We are at the end of the parent stream
+				_eos = true;
+				break;
+			}
+		}
+
+		const uint32 n = MIN(dataSize, _bufSize - _pos);
+		memcpy(dataPtr, _buf + _pos, n);
+		_pos += n;
+		alreadyRead += n;
+		dataPtr = (byte *)dataPtr + n;
+		dataSize -= n;
+	}
+
+	return alreadyRead;
+}
+
+bool ReadAheadSeekableReadStream::seek(int32 offset, int whence) {
+	_eos = false;	// seeking always cancels EOS
+
+	int32 newPos = offset;
+	switch (whence) {
+	case SEEK_CUR:
+		newPos = pos() + offset;
+		break;
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	default:
+		break;
+	}
+
+	if (newPos < 0 || newPos > _size)
+		return false;
+
+	if (newPos >= _bufStart && newPos <= _bufStart + (int32)_bufSize) {
+		// Seeking within the buffer keeps the access sequential
+		_pos = newPos - _bufStart;
+	} else {
+		// The buffer read ahead is dropped, and the parent stream is only
+		// seeked in by the next read
+		finishReadAhead();
+		_bufStart = newPos;
+		_bufSize = _pos = 0;
+		_sequentialRefills = 0;
+	}
+
+	return true;
+}
+
+} // End of anonymous namespace
+
+SeekableReadStream *wrapReadAheadSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream) {
+	if (parentStream)
+		return new ReadAheadSeekableReadStream(parentStream, bufSize, disposeParentStream);
+	return 0;
+}
+
+#pragma mark -
+
+namespace {
+
 /**
  * Wrapper class which adds buffering to any WriteStream.
  */
@@ -453,6 +453,17 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to all the data of the stream, if the stream keeps
+	 * it in memory anyway, e.g. a MemoryReadStream or a memory mapped file.
+	 * This allows to use the data in place instead of reading a copy of it.
+	 * The data is size() bytes long, and remains valid as long as the stream
+	 * exists.
+	 *
+	 * @return the data of the stream, or 0 if it has to be read
+	 */
+	virtual const byte *getDataPtr() const { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
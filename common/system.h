@@ -980,7 +980,8 @@ public:
 	 * from a dedicated thread (as e.g. the SDL backend does).
 	 *
 	 * Hence backends which do not use threads to implement the timers simply
-	 * can use dummy implementations for these methods.
+	 * can use dummy implementations for these methods, unless they implement
+	 * the optional worker threads below.
 	 */
 	//@{
 
@@ -1022,6 +1023,83 @@ public:
 
 
 
+	/**
+	 * @name Worker threads
+	 * Backends may optionally run work on threads of their own, for tasks
+	 * which do not touch the rest of the OSystem API, like decoding video
+	 * frames or compressing savefiles. Code using them has to do the work
+	 * itself if createThread() returns 0, so backends without threads do
+	 * not need to implement any of these methods.
+	 *
+	 * Usually Common::ThreadPool should be used instead of calling these
+	 * methods directly.
+	 */
+	//@{
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef struct OpaqueCondition *ConditionRef;
+	typedef void (*ThreadProc)(void *param);
+
+	/**
+	 * Start a new thread running the given function.
+	 *
+	 * @param proc  the function to run.
+	 * @param param the parameter to pass to the function.
+	 * @param name  the name of the thread, for debugging.
+	 * @return the new thread, or 0 if threads are not supported.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *param, const char *name) { return 0; }
+
+	/**
+	 * Wait for the given thread to end, and free it.
+	 * @param thread the thread to wait for.
+	 */
+	virtual void joinThread(ThreadRef thread) {}
+
+	/**
+	 * Create a new condition variable.
+	 * @return the newly created condition, or 0 if threads are not supported.
+	 */
+	virtual ConditionRef createCondition() { return 0; }
+
+	/**
+	 * Unlock the mutex, wait until the condition is signalled, and lock
+	 * the mutex again. The mutex has to be locked exactly once by the
+	 * calling thread. Like with all condition variables, the waiting may
+	 * also end without a signal, so the condition has to be checked again.
+	 *
+	 * @param cond  the condition to wait for.
+	 * @param mutex the mutex protecting the condition.
+	 */
+	virtual void waitCondition(ConditionRef cond, MutexRef mutex) {}
+
+	/**
+	 * Wake up one thread waiting for the condition.
+	 * @param cond the condition to signal.
+	 */
+	virtual void signalCondition(ConditionRef cond) {}
+
+	/**
+	 * Wake up all threads waiting for the condition.
+	 * @param cond the condition to signal.
+	 */
+	virtual void broadcastCondition(ConditionRef cond) {}
+
+	/**
+	 * Delete the given condition. No thread may be waiting for it.
+	 * @param cond the condition to delete.
+	 */
+	virtual void deleteCondition(ConditionRef cond) {}
+
+	/**
+	 * Return the number of CPU cores which can run threads.
+	 */
+	virtual uint getCPUCount() { return 1; }
+
+	//@}
+
+
+
 	/** @name Sound */
 	//@{
 
@@ -0,0 +1,138 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/threadpool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(uint numThreads, const char *name)
+	: _workCond(0), _doneCond(0), _unfinishedJobs(0), _shouldQuit(false) {
+	assert(g_system);
+	_mutex = g_system->createMutex();
+
+	if (numThreads == 0)
+		return;
+
+	_workCond = g_system->createCondition();
+	_doneCond = g_system->createCondition();
+	if (!_workCond || !_doneCond)
+		return;
+
+	for (uint i = 0; i < numThreads; i++) {
+		OSystem::ThreadRef thread = g_system->createThread(threadProc, this, name);
+		if (!thread)
+			break;
+
+		_threads.push_back(thread);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	wait();
+
+	// Signal the workers to end, and wait for them to actually finish
+	g_system->lockMutex(_mutex);
+	_shouldQuit = true;
+	if (_workCond)
+		g_system->broadcastCondition(_workCond);
+	g_system->unlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); i++)
+		g_system->joinThread(_threads[i]);
+
+	if (_workCond)
+		g_system->deleteCondition(_workCond);
+	if (_doneCond)
+		g_system->deleteCondition(_doneCond);
+	g_system->deleteMutex(_mutex);
+}
+
+void ThreadPool::addJob(ThreadJob *job, DisposeAfterUse::Flag disposeAfterUse) {
+	QueuedJob queued;
+	queued.job = job;
+	queued.disposeAfterUse = disposeAfterUse;
+
+	g_system->lockMutex(_mutex);
+	_jobs.push_back(queued);
+	_unfinishedJobs++;
+	if (!_threads.empty())
+		g_system->signalCondition(_workCond);
+	g_system->unlockMutex(_mutex);
+}
+
+bool ThreadPool::poll() {
+	g_system->lockMutex(_mutex);
+	if (_threads.empty() && !_jobs.empty())
+		runJob();
+
+	const bool done = (_unfinishedJobs == 0);
+	g_system->unlockMutex(_mutex);
+	return done;
+}
+
+void ThreadPool::wait() {
+	g_system->lockMutex(_mutex);
+	while (_unfinishedJobs > 0) {
+		if (!_jobs.empty())
+			runJob();
+		else
+			g_system->waitCondition(_doneCond, _mutex);
+	}
+	g_system->unlockMutex(_mutex);
+}
+
+void ThreadPool::runJob() {
+	const QueuedJob queued = _jobs.front();
+	_jobs.pop_front();
+	g_system->unlockMutex(_mutex);
+
+	queued.job->run();
+	if (queued.disposeAfterUse == DisposeAfterUse::YES)
+		delete queued.job;
+
+	g_system->lockMutex(_mutex);
+	if (--_unfinishedJobs == 0 && _doneCond)
+		g_system->broadcastCondition(_doneCond);
+}
+
+void ThreadPool::workerThread() {
+	g_system->lockMutex(_mutex);
+	while (true) {
+		// Wait until there are jobs to run
+		while (!_shouldQuit && _jobs.empty())
+			g_system->waitCondition(_workCond, _mutex);
+
+		if (_shouldQuit)
+			break;
+
+		runJob();
+	}
+	g_system->unlockMutex(_mutex);
+}
+
+void ThreadPool::threadProc(void *param) {
+	ThreadPool *pool = (ThreadPool *)param;
+	assert(pool);
+	pool->workerThread();
+}
+
+} // End of namespace Common
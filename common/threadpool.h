@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/list.h"
+#include "common/noncopyable.h"
+#include "common/system.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * A piece of work which is run by a ThreadPool.
+ */
+class ThreadJob {
+public:
+	virtual ~ThreadJob() {}
+
+	/**
+	 * Do the work. This may be called on any thread, so it must not use
+	 * the OSystem API apart from the mutex functions.
+	 */
+	virtual void run() = 0;
+};
+
+/**
+ * A pool of worker threads running queued jobs, using the worker thread
+ * functions of OSystem.
+ *
+ * If the backend cannot create threads, the pool has no worker threads.
+ * The jobs are then run on the calling thread by poll() and wait(), so
+ * code using a pool works the same way on every backend.
+ */
+class ThreadPool : NonCopyable {
+public:
+	/**
+	 * Start the worker threads.
+	 *
+	 * @param numThreads The number of worker threads to start. Fewer may
+	 *                   be started if the backend runs out of threads.
+	 * @param name       The name of the threads, for debugging.
+	 */
+	ThreadPool(uint numThreads, const char *name);
+
+	/**
+	 * Wait for all queued jobs to finish, and end the worker threads.
+	 */
+	~ThreadPool();
+
+	/** Return the number of worker threads, which is 0 without thread support. */
+	uint getThreadCount() const { return _threads.size(); }
+
+	/**
+	 * Queue a job. It is started as soon as a worker thread is free.
+	 *
+	 * @param job             The job to run.
+	 * @param disposeAfterUse Whether to delete the job once it was run.
+	 *                        Otherwise it has to stay alive until it is
+	 *                        finished.
+	 */
+	void addJob(ThreadJob *job, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::NO);
+
+	/**
+	 * Return whether all queued jobs are finished. Without worker threads,
+	 * one queued job is run on the calling thread first, so that callers
+	 * which keep polling still make progress.
+	 */
+	bool poll();
+
+	/**
+	 * Wait until all queued jobs are finished. Jobs which were not started
+	 * yet are run on the calling thread meanwhile.
+	 */
+	void wait();
+
+private:
+	struct QueuedJob {
+		ThreadJob *job;
+		DisposeAfterUse::Flag disposeAfterUse;
+	};
+
+	OSystem::MutexRef _mutex;
+	/** Signalled when jobs are added, or the threads have to end */
+	OSystem::ConditionRef _workCond;
+	/** Signalled when the last unfinished job is done */
+	OSystem::ConditionRef _doneCond;
+
+	Array<OSystem::ThreadRef> _threads;
+	List<QueuedJob> _jobs;
+	/** The number of queued and running jobs */
+	uint _unfinishedJobs;
+	bool _shouldQuit;
+
+	/**
+	 * Run the next queued job. The mutex has to be locked, and is locked
+	 * again on return.
+	 */
+	void runJob();
+
+	void workerThread();
+	static void threadProc(void *param);
+};
+
+} // End of namespace Common
+
+#endif
@@ -103,9 +103,12 @@ typedef struct {
 
 #endif  // !USE_ZLIB
 
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -382,6 +385,8 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _sharedStream;	/* owner of _stream, shared
+													with the streams of the members */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +549,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_sharedStream = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +601,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -644,7 +649,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1419,6 +1423,264 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * Members of at most this size are read into memory completely when they
+ * are opened, which is cheaper than keeping the state needed to read them
+ * on demand.
+ */
+static const uint32 kZipMaxInMemorySize = 64 * 1024;
+
+/**
+ * A stream for a stored member of a zip archive, which reads the data
+ * directly from the archive file.
+ *
+ * The archive file is shared with the ZipArchive and all other streams of its
+ * members, so the stream may outlive the ZipArchive it was created from.
+ */
+class ZipStoredStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _archive;
+
+public:
+	ZipStoredStream(const SharedPtr<SeekableReadStream> &archive, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(archive.get(), begin, end), _archive(archive) {
+	}
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * A stream for a deflated member of a zip archive, which inflates the data
+ * as it is read.
+ *
+ * Every kCheckpointSpan bytes of output, the state needed to resume inflating
+ * at that point is remembered. Seeking backwards then only has to start over
+ * at the last checkpoint before the new position, instead of at the start of
+ * the member.
+ *
+ * Like ZipStoredStream, the stream shares the archive file and seeks it to
+ * its own position before each read.
+ */
+class ZipInflateStream : public SeekableReadStream {
+public:
+	ZipInflateStream(const SharedPtr<SeekableReadStream> &archive, uint32 dataStart, uint32 compressedSize, uint32 size);
+	~ZipInflateStream();
+
+	bool err() const { return _err; }
+	void clearErr() {
+		// only reset _eos; I/O errors are not recoverable
+		_eos = false;
+	}
+	bool eos() const { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		kWindowSize = 32768,		// 1 << MAX_WBITS
+		kCheckpointSpan = 1024 * 1024
+	};
+
+	struct Checkpoint {
+		uint32 pos;		///< position in the uncompressed data
+		uint32 inPos;	///< number of bytes of compressed data consumed
+		int bits;		///< number of bits of the last consumed byte not used yet
+		byte *window;	///< the kWindowSize bytes of output preceding pos
+	};
+
+	/**
+	 * Inflate the given number of bytes.
+	 *
+	 * @param dst the buffer to store the data in, or 0 to skip it
+	 * @param len the number of bytes to inflate
+	 * @return the number of bytes inflated, less than len on errors
+	 */
+	uint32 inflateData(byte *dst, uint32 len);
+
+	/** Remember the current state in a new checkpoint. */
+	void addCheckpoint();
+
+	/** Restart inflating at the given checkpoint, or at the start if 0. */
+	void restart(const Checkpoint *checkpoint);
+
+	SharedPtr<SeekableReadStream> _archive;
+	uint32 _dataStart;
+	uint32 _compressedSize;
+	uint32 _size;
+
+	z_stream _stream;
+	uint32 _inPos;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+	byte _inBuffer[UNZ_BUFSIZE];
+
+	/** The last kWindowSize bytes of output, position x is at x % kWindowSize */
+	byte _window[kWindowSize];
+
+	/** The checkpoints, in order of their position */
+	Array<Checkpoint> _checkpoints;
+};
+
+ZipInflateStream::ZipInflateStream(const SharedPtr<SeekableReadStream> &archive, uint32 dataStart, uint32 compressedSize, uint32 size)
+	: _archive(archive), _dataStart(dataStart), _compressedSize(compressedSize), _size(size),
+	  _stream(), _inPos(0), _pos(0), _eos(false), _err(false) {
+
+	// windowBits is passed < 0 to tell that there is no zlib header
+	_err = (inflateInit2(&_stream, -MAX_WBITS) != Z_OK);
+}
+
+ZipInflateStream::~ZipInflateStream() {
+	inflateEnd(&_stream);
+
+	for (uint i = 0; i < _checkpoints.size(); i++)
+		delete[] _checkpoints[i].window;
+}
+
+uint32 ZipInflateStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	return inflateData((byte *)dataPtr, dataSize);
+}
+
+bool ZipInflateStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	}
+
+	if (newPos < 0 || (uint32)newPos > _size || _err)
+		return false;
+
+	_eos = false;
+
+	// Find the last checkpoint before the new position
+	const Checkpoint *checkpoint = 0;
+	for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].pos <= (uint32)newPos; i++)
+		checkpoint = &_checkpoints[i];
+
+	// Restart if we have to go back, or if that saves inflating data
+	if ((uint32)newPos < _pos || (checkpoint && checkpoint->pos > _pos))
+		restart(checkpoint);
+
+	inflateData(0, newPos - _pos);
+	return !_err;
+}
+
+uint32 ZipInflateStream::inflateData(byte *dst, uint32 len) {
+	uint32 done = 0;
+
+	while (done < len && !_err) {
+		if (_stream.avail_in == 0) {
+			// Read more compressed data
+			const uint32 inLen = MIN<uint32>(UNZ_BUFSIZE, _compressedSize - _inPos);
+			_archive->seek(_dataStart + _inPos, SEEK_SET);
+			if (inLen == 0 || _archive->read(_inBuffer, inLen) != inLen) {
+				_err = true;
+				break;
+			}
+
+			_inPos += inLen;
+			_stream.next_in = _inBuffer;
+			_stream.avail_in = inLen;
+		}
+
+		// Inflate into the window, without wrapping around
+		byte *out = _window + _pos % kWindowSize;
+		_stream.next_out = out;
+		_stream.avail_out = MIN<uint32>(len - done, kWindowSize - _pos % kWindowSize);
+
+		// Stop at the end of each deflate block, where checkpoints can be set
+		const int zlibErr = inflate(&_stream, Z_BLOCK);
+
+		const uint32 count = _stream.next_out - out;
+		if (dst)
+			memcpy(dst + done, out, count);
+		done += count;
+		_pos += count;
+
+		if (zlibErr != Z_OK && zlibErr != Z_BUF_ERROR) {
+			// Z_STREAM_END before all data was inflated is an error as well
+			_err = (done < len);
+			break;
+		}
+
+		// Bit 7 of data_type is set at the end of a block, bit 6 if that
+		// block was the last one
+		const uint32 lastCheckpoint = _checkpoints.empty() ? 0 : _checkpoints.back().pos;
+		if ((_stream.data_type & 128) && !(_stream.data_type & 64) && _pos >= lastCheckpoint + kCheckpointSpan)
+			addCheckpoint();
+	}
+
+	if (done < len)
+		_eos = true;
+
+	return done;
+}
+
+void ZipInflateStream::addCheckpoint() {
+	Checkpoint checkpoint;
+	checkpoint.pos = _pos;
+	checkpoint.inPos = _inPos - _stream.avail_in;
+	checkpoint.bits = _stream.data_type & 7;
+
+	// Unwrap the window; kCheckpointSpan exceeds kWindowSize, so it is full
+	const uint32 windowPos = _pos % kWindowSize;
+	checkpoint.window = new byte[kWindowSize];
+	memcpy(checkpoint.window, _window + windowPos, kWindowSize - windowPos);
+	memcpy(checkpoint.window + kWindowSize - windowPos, _window, windowPos);
+
+	_checkpoints.push_back(checkpoint);
+}
+
+void ZipInflateStream::restart(const Checkpoint *checkpoint) {
+	if (inflateReset(&_stream) != Z_OK) {
+		_err = true;
+		return;
+	}
+
+	_stream.avail_in = 0;
+	_inPos = 0;
+	_pos = 0;
+
+	if (!checkpoint)
+		return;
+
+	_inPos = checkpoint->inPos;
+	_pos = checkpoint->pos;
+
+	if (checkpoint->bits) {
+		// The checkpoint starts in the middle of the last consumed byte
+		_archive->seek(_dataStart + _inPos - 1, SEEK_SET);
+		const byte partial = _archive->readByte();
+		if (_archive->err() || _archive->eos() ||
+		    inflatePrime(&_stream, checkpoint->bits, partial >> (8 - checkpoint->bits)) != Z_OK) {
+			_err = true;
+			return;
+		}
+	}
+
+	if (inflateSetDictionary(&_stream, checkpoint->window, kWindowSize) != Z_OK)
+		_err = true;
+}
+
+#endif // USE_ZLIB
+
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1496,6 +1758,24 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
+	if (fileInfo.uncompressed_size > kZipMaxInMemorySize) {
+		// Read larger members on demand, directly from the archive file
+		const unz_s *const archive = (const unz_s *)_zipFile;
+		const uint32 dataStart = archive->pfile_in_zip_read->pos_in_zipfile + archive->pfile_in_zip_read->byte_before_the_zipfile;
+
+		if (unzCloseCurrentFile(_zipFile) != UNZ_OK)
+			return 0;
+
+		if (fileInfo.compression_method == 0)
+			return new ZipStoredStream(archive->_sharedStream, dataStart, dataStart + fileInfo.uncompressed_size);
+
+#ifdef USE_ZLIB
+		return new ZipInflateStream(archive->_sharedStream, dataStart, fileInfo.compressed_size, fileInfo.uncompressed_size);
+#else
+		return 0;
+#endif
+	}
+
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
@@ -1510,11 +1790,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
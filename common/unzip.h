@@ -51,7 +51,7 @@ Archive *makeZipArchive(const FSNode &node);
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
  * This takes ownership of the stream,  in particular, it is deleted when the
- * ZipArchive is deleted.
+ * ZipArchive and all streams created for its members are deleted.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
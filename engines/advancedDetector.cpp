@@ -28,12 +28,131 @@
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "engines/advancedDetector.h"
 #include "engines/obsolete.h"
 
+namespace Common {
+DECLARE_SINGLETON(ADDetectionCache);
+}
+
+/** The name of the detection cache in the savefile directory */
+static const char *const kDetectionCacheName = "detection.cache";
+
+/** The version of the detection cache file format */
+static const int kDetectionCacheVersion = 1;
+
+/**
+ * Entries which have not been used during a session are dropped when there
+ * are more of them than this, e.g. because of games removed from the disk.
+ */
+static const uint kDetectionCacheMaxEntries = 50000;
+
+ADDetectionCache::ADDetectionCache() : _loaded(false), _dirty(false) {
+}
+
+bool ADDetectionCache::lookup(const Common::FSNode &node, uint md5Bytes, int32 size, Common::String &md5) {
+	load();
+
+	const uint32 mtime = node.getModificationTime();
+	if (mtime == 0)
+		return false;
+
+	EntryMap::iterator i = _entries.find(Common::String::format("%u:%s", md5Bytes, node.getPath().c_str()));
+	if (i == _entries.end() || i->_value.mtime != mtime || i->_value.size != size)
+		return false;
+
+	i->_value.used = true;
+	md5 = i->_value.md5;
+	return true;
+}
+
+void ADDetectionCache::store(const Common::FSNode &node, uint md5Bytes, int32 size, const Common::String &md5) {
+	load();
+
+	const uint32 mtime = node.getModificationTime();
+	if (mtime == 0)
+		return;
+
+	Entry &entry = _entries[Common::String::format("%u:%s", md5Bytes, node.getPath().c_str())];
+	entry.mtime = mtime;
+	entry.size = size;
+	entry.md5 = md5;
+	entry.used = true;
+	_dirty = true;
+}
+
+void ADDetectionCache::load() {
+	if (_loaded)
+		return;
+
+	_loaded = true;
+
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(kDetectionCacheName);
+	if (!in)
+		return;
+
+	int version = 0;
+	if (sscanf(in->readLine().c_str(), "%d", &version) != 1 || version != kDetectionCacheVersion) {
+		// Just start over, the cache is rebuilt on the next scan
+		delete in;
+		return;
+	}
+
+	while (!in->eos() && !in->err()) {
+		// <mtime> <size> <md5 bytes> <md5> <path>
+		Common::String line = in->readLine();
+		uint32 mtime, md5Bytes;
+		int32 size;
+		char md5[33];
+		int pathPos;
+
+		if (sscanf(line.c_str(), "%u %d %u %32s %n", &mtime, &size, &md5Bytes, md5, &pathPos) != 4)
+			continue;
+
+		Entry &entry = _entries[Common::String::format("%u:%s", md5Bytes, line.c_str() + pathPos)];
+		entry.mtime = mtime;
+		entry.size = size;
+		entry.md5 = md5;
+		entry.used = false;
+	}
+
+	delete in;
+}
+
+void ADDetectionCache::flush() {
+	if (!_dirty)
+		return;
+
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(kDetectionCacheName);
+	if (!out)
+		return;
+
+	const bool dropUnused = _entries.size() > kDetectionCacheMaxEntries;
+
+	out->writeString(Common::String::format("%d\n", kDetectionCacheVersion));
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (dropUnused && !i->_value.used)
+			continue;
+
+		const char *path = strchr(i->_key.c_str(), ':') + 1;
+		const uint md5Bytes = atoi(i->_key.c_str());
+		out->writeString(Common::String::format("%u %d %u %s %s\n", i->_value.mtime, i->_value.size, md5Bytes, i->_value.md5.c_str(), path));
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Failed to write the detection cache");
+	else
+		_dirty = false;
+
+	delete out;
+}
+
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
 	const char *title = 0;
 	const char *extra;
@@ -247,6 +366,7 @@ Common::Error AdvancedMetaEngine::createInstance(OSystem *syst, Engine **engine)
 
 	// Run the detector on this
 	ADGameDescList matches = detectGame(files.begin()->getParent(), allFiles, language, platform, extra);
+	ADDetectionCache::instance().flush();
 
 	if (cleanupPirated(matches))
 		return Common::kNoGameDataFoundError;
@@ -378,13 +498,25 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+	ADDetectionCache &cache = ADDetectionCache::instance();
+
+	// Unchanged files are not opened at all
+	const int32 size = node.getFileSize();
+	if (size >= 0 && cache.lookup(node, _md5Bytes, size, fileProps.md5)) {
+		fileProps.size = size;
+		return true;
+	}
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	cache.store(node, _md5Bytes, fileProps.size, fileProps.md5);
+
 	return true;
 }
 
@@ -29,12 +29,14 @@
 #include "engines/engine.h"
 
 #include "common/hash-str.h"
+#include "common/singleton.h"
 
 #include "common/gui_options.h" // FIXME: Temporary hack?
 
 namespace Common {
 class Error;
 class FSList;
+class FSNode;
 }
 
 /**
@@ -63,6 +65,59 @@ struct ADFileProperties {
  */
 typedef Common::HashMap<Common::String, ADFileProperties, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> ADFilePropertiesMap;
 
+/**
+ * A persistent cache of the properties of files examined while detecting,
+ * so that the MD5 sums of files which did not change since the last scan
+ * do not have to be computed again. A file is considered unchanged if its
+ * size and modification time are the same, thus only files for which the
+ * file system node reports a modification time are cached.
+ *
+ * The cache is stored in the savefile directory.
+ */
+class ADDetectionCache : public Common::Singleton<ADDetectionCache> {
+public:
+	/**
+	 * Look up the properties of a file.
+	 *
+	 * @param node     the file
+	 * @param md5Bytes the number of bytes the MD5 sum was computed of
+	 * @param size     the current size of the file
+	 * @param md5      receives the MD5 sum, if the file is in the cache
+	 * @return true if the file is cached and did not change, false otherwise
+	 */
+	bool lookup(const Common::FSNode &node, uint md5Bytes, int32 size, Common::String &md5);
+
+	/**
+	 * Add the properties of a file to the cache.
+	 */
+	void store(const Common::FSNode &node, uint md5Bytes, int32 size, const Common::String &md5);
+
+	/**
+	 * Write the cache to disk, if it has been changed since it was loaded.
+	 */
+	void flush();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	ADDetectionCache();
+
+	void load();
+
+	struct Entry {
+		uint32 mtime;
+		int32 size;
+		Common::String md5;
+		bool used;
+	};
+
+	/** Map of "md5Bytes:path" to the cached properties */
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+	EntryMap _entries;
+
+	bool _loaded;
+	bool _dirty;
+};
+
 /**
  * A shortcut to produce an empty ADGameFileDescription record. Used to mark
  * the end of a list of these.
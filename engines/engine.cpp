@@ -28,6 +28,7 @@
 #include "common/config-manager.h"
 #include "common/events.h"
 #include "common/file.h"
+#include "common/fs.h"
 #include "common/system.h"
 #include "common/str.h"
 #include "common/error.h"
@@ -179,7 +180,14 @@ Engine::~Engine() {
 }
 
 void Engine::initializePath(const Common::FSNode &gamePath) {
-	SearchMan.addDirectory(gamePath.getPath(), gamePath, 0, 4);
+	if (!gamePath.exists() || !gamePath.isDirectory())
+		return;
+
+	// Games may have thousands of files, so don't list all their directories
+	// again each time the game is started
+	Common::FSDirectory *dir = new Common::FSDirectory(gamePath, 4);
+	dir->enableIndex();
+	SearchMan.add(gamePath.getPath(), dir, 0);
 }
 
 void initCommonGFX(bool defaultTo1XScaler) {
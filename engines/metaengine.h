@@ -259,7 +259,15 @@ class EngineManager : public Common::Singleton<EngineManager> {
 public:
 	GameDescriptor findGameInLoadedPlugins(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
 	GameDescriptor findGame(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
-	GameList detectGames(const Common::FSList &fslist) const;
+	/**
+	 * Run the detectors of all engines on the given files.
+	 *
+	 * @param fslist     the files to examine
+	 * @param flushCache whether to write the detection cache to disk
+	 *                   afterwards; callers detecting many directories in a
+	 *                   row can flush it once at the end instead
+	 */
+	GameList detectGames(const Common::FSList &fslist, bool flushCache = true) const;
 	const EnginePlugin::List &getPlugins() const;
 };
 
@@ -0,0 +1,316 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/saveindex.h"
+#include "engines/metaengine.h"
+
+#include "common/algorithm.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/surface.h"
+#include "graphics/thumbnail.h"
+
+/** The version of the save state index format */
+static const uint32 kSaveIndexVersion = 1;
+
+static void writeIndexString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint16BE(str.size());
+	out.writeString(str);
+}
+
+static Common::String readIndexString(Common::ReadStream &in) {
+	const uint16 size = in.readUint16BE();
+
+	Common::String str;
+	for (uint i = 0; i < size && !in.eos(); i++)
+		str += (char)in.readByte();
+	return str;
+}
+
+SaveStateIndex::SaveStateIndex(const MetaEngine &metaEngine, const Common::String &target)
+	: _metaEngine(metaEngine), _target(target), _hasList(false), _dirty(false) {
+	_indexName = "saveindex-" + target + ".idx";
+	load();
+}
+
+SaveStateIndex::~SaveStateIndex() {
+	flush();
+}
+
+SaveStateList SaveStateIndex::listSaves() {
+	if (_hasList && isValid(_list))
+		return _list.saves;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::SavefileAccessLog log;
+	Common::SavefileAccessLog *oldLog = saveFileMan->setAccessLog(&log);
+	_list.saves = _metaEngine.listSaves(_target.c_str());
+	saveFileMan->setAccessLog(oldLog);
+
+	_hasList = fillEntry(_list, log);
+	_dirty = true;
+	return _list.saves;
+}
+
+SaveStateDescriptor SaveStateIndex::querySaveMetaInfos(int slot) {
+	SlotMap::iterator i = _slots.find(slot);
+	if (i != _slots.end() && isValid(i->_value))
+		return i->_value.saves.front();
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::SavefileAccessLog log;
+	Common::SavefileAccessLog *oldLog = saveFileMan->setAccessLog(&log);
+	const SaveStateDescriptor desc = _metaEngine.querySaveMetaInfos(_target.c_str(), slot);
+	saveFileMan->setAccessLog(oldLog);
+
+	Entry &entry = _slots[slot];
+	entry.saves.clear();
+	entry.saves.push_back(desc);
+	if (!fillEntry(entry, log))
+		_slots.erase(slot);
+
+	_dirty = true;
+	return desc;
+}
+
+bool SaveStateIndex::isValid(const Entry &entry) const {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+
+	for (uint i = 0; i < entry.files.size(); i++) {
+		if (saveFileMan->getSavefileStamp(entry.files[i].name) != entry.files[i].stamp)
+			return false;
+	}
+
+	// New savefiles may have been added, or old ones removed
+	for (uint i = 0; i < entry.patterns.size(); i++) {
+		Common::StringArray names = saveFileMan->listSavefiles(entry.patterns[i].pattern);
+		Common::sort(names.begin(), names.end());
+		if (names != entry.patterns[i].names)
+			return false;
+	}
+
+	return true;
+}
+
+bool SaveStateIndex::fillEntry(Entry &entry, const Common::SavefileAccessLog &log) const {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+
+	entry.files.clear();
+	entry.patterns.clear();
+
+	// Without any accessed savefiles, there is nothing to check the entry
+	// against later on
+	if (log.names.empty() && log.patterns.empty())
+		return false;
+
+	for (uint i = 0; i < log.names.size(); i++) {
+		bool known = false;
+		for (uint j = 0; j < entry.files.size() && !known; j++)
+			known = entry.files[j].name.equalsIgnoreCase(log.names[i]);
+		if (known)
+			continue;
+
+		FileStamp file;
+		file.name = log.names[i];
+		file.stamp = saveFileMan->getSavefileStamp(file.name);
+		if (file.stamp == 0)
+			return false;
+		entry.files.push_back(file);
+	}
+
+	for (uint i = 0; i < log.patterns.size(); i++) {
+		PatternList list;
+		list.pattern = log.patterns[i];
+		list.names = saveFileMan->listSavefiles(list.pattern);
+		Common::sort(list.names.begin(), list.names.end());
+		entry.patterns.push_back(list);
+	}
+
+	return true;
+}
+
+void SaveStateIndex::flush() {
+	if (!_dirty)
+		return;
+	_dirty = false;
+
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(_indexName);
+	if (!out)
+		return;
+
+	out->writeUint32BE(MKTAG('S','I','D','X'));
+	out->writeUint32BE(kSaveIndexVersion);
+	writeIndexString(*out, _target);
+
+	const bool hasList = _hasList && canSaveEntry(_list);
+	out->writeByte(hasList);
+	if (hasList)
+		saveEntry(*out, _list);
+
+	uint32 count = 0;
+	for (SlotMap::const_iterator i = _slots.begin(); i != _slots.end(); ++i) {
+		if (canSaveEntry(i->_value))
+			count++;
+	}
+
+	out->writeUint32BE(count);
+	for (SlotMap::const_iterator i = _slots.begin(); i != _slots.end(); ++i) {
+		if (canSaveEntry(i->_value)) {
+			out->writeSint32BE(i->_key);
+			saveEntry(*out, i->_value);
+		}
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("SaveStateIndex::flush: Failed to write '%s'", _indexName.c_str());
+
+	delete out;
+}
+
+void SaveStateIndex::load() {
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(_indexName);
+	if (!in)
+		return;
+
+	bool valid = (in->readUint32BE() == MKTAG('S','I','D','X') && in->readUint32BE() == kSaveIndexVersion &&
+	              readIndexString(*in) == _target);
+
+	if (valid) {
+		_hasList = (in->readByte() != 0);
+		if (_hasList)
+			valid = loadEntry(*in, _list);
+	}
+
+	const uint32 count = valid ? in->readUint32BE() : 0;
+	for (uint32 i = 0; i < count && valid; i++) {
+		const int slot = in->readSint32BE();
+		valid = loadEntry(*in, _slots[slot]);
+	}
+
+	if (!valid || in->err() || in->eos()) {
+		// Start over with a damaged or outdated index
+		_hasList = false;
+		_list = Entry();
+		_slots.clear();
+	}
+
+	delete in;
+}
+
+bool SaveStateIndex::loadEntry(Common::SeekableReadStream &in, Entry &entry) const {
+	const uint32 fileCount = in.readUint32BE();
+	for (uint32 i = 0; i < fileCount && !in.eos(); i++) {
+		FileStamp file;
+		file.name = readIndexString(in);
+		file.stamp = in.readUint32BE();
+		entry.files.push_back(file);
+	}
+
+	const uint32 patternCount = in.readUint32BE();
+	for (uint32 i = 0; i < patternCount && !in.eos(); i++) {
+		PatternList list;
+		list.pattern = readIndexString(in);
+		const uint32 nameCount = in.readUint32BE();
+		for (uint32 j = 0; j < nameCount && !in.eos(); j++)
+			list.names.push_back(readIndexString(in));
+		entry.patterns.push_back(list);
+	}
+
+	const uint32 saveCount = in.readUint32BE();
+	for (uint32 i = 0; i < saveCount && !in.eos(); i++) {
+		const int slot = in.readSint32BE();
+		SaveStateDescriptor desc(slot, readIndexString(in));
+		desc.setDeletableFlag(in.readByte() != 0);
+		desc.setWriteProtectedFlag(in.readByte() != 0);
+
+		// The dates and times are stored as they are formatted by the
+		// descriptor
+		const Common::String date = readIndexString(in);
+		const Common::String time = readIndexString(in);
+		const Common::String playTime = readIndexString(in);
+		int day, month, year, hours, minutes;
+		if (sscanf(date.c_str(), "%d.%d.%d", &day, &month, &year) == 3)
+			desc.setSaveDate(year, month, day);
+		if (sscanf(time.c_str(), "%d:%d", &hours, &minutes) == 2)
+			desc.setSaveTime(hours, minutes);
+		if (sscanf(playTime.c_str(), "%d:%d", &hours, &minutes) == 2)
+			desc.setPlayTime(hours, minutes);
+
+		if (in.readByte()) {
+			Graphics::Surface *thumbnail = Graphics::loadThumbnail(in);
+			if (!thumbnail)
+				return false;
+			desc.setThumbnail(thumbnail);
+		}
+
+		entry.saves.push_back(desc);
+	}
+
+	return !in.eos() && !in.err();
+}
+
+bool SaveStateIndex::canSaveEntry(const Entry &entry) const {
+	// Only thumbnails which can be stored without conversion are kept
+	for (uint i = 0; i < entry.saves.size(); i++) {
+		const Graphics::Surface *thumbnail = entry.saves[i].getThumbnail();
+		if (thumbnail && thumbnail->format.bytesPerPixel != 2 && thumbnail->format.bytesPerPixel != 4)
+			return false;
+	}
+
+	return true;
+}
+
+void SaveStateIndex::saveEntry(Common::WriteStream &out, const Entry &entry) const {
+	out.writeUint32BE(entry.files.size());
+	for (uint i = 0; i < entry.files.size(); i++) {
+		writeIndexString(out, entry.files[i].name);
+		out.writeUint32BE(entry.files[i].stamp);
+	}
+
+	out.writeUint32BE(entry.patterns.size());
+	for (uint i = 0; i < entry.patterns.size(); i++) {
+		writeIndexString(out, entry.patterns[i].pattern);
+		out.writeUint32BE(entry.patterns[i].names.size());
+		for (uint j = 0; j < entry.patterns[i].names.size(); j++)
+			writeIndexString(out, entry.patterns[i].names[j]);
+	}
+
+	out.writeUint32BE(entry.saves.size());
+	for (uint i = 0; i < entry.saves.size(); i++) {
+		const SaveStateDescriptor &desc = entry.saves[i];
+		out.writeSint32BE(desc.getSaveSlot());
+		writeIndexString(out, desc.getDescription());
+		out.writeByte(desc.getDeletableFlag());
+		out.writeByte(desc.getWriteProtectedFlag());
+		writeIndexString(out, desc.getSaveDate());
+		writeIndexString(out, desc.getSaveTime());
+		writeIndexString(out, desc.getPlayTime());
+
+		const Graphics::Surface *thumbnail = desc.getThumbnail();
+		out.writeByte(thumbnail != 0);
+		if (thumbnail)
+			Graphics::saveThumbnail(out, *thumbnail);
+	}
+}
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_SAVEINDEX_H
+#define ENGINES_SAVEINDEX_H
+
+#include "common/hashmap.h"
+#include "common/savefile.h"
+#include "common/str.h"
+
+#include "engines/savestate.h"
+
+class MetaEngine;
+
+namespace Common {
+class SeekableReadStream;
+class WriteStream;
+}
+
+/**
+ * An index of the save states of a target, kept next to its savefiles.
+ *
+ * Listing the save states of a target, and querying the meta information of
+ * a save state, usually means opening, decompressing and parsing savefiles.
+ * The index remembers the results of these MetaEngine queries, along with the
+ * savefiles each of them accessed. A result is used again as long as the
+ * stamps of these savefiles did not change, and the savefile patterns which
+ * were listed still give the same savefiles. Only the savefile directory has
+ * to be queried then.
+ *
+ * Results are only kept if the savefile manager provides stamps for the
+ * accessed savefiles.
+ */
+class SaveStateIndex {
+public:
+	SaveStateIndex(const MetaEngine &metaEngine, const Common::String &target);
+	~SaveStateIndex();
+
+	/** Cached version of MetaEngine::listSaves(). */
+	SaveStateList listSaves();
+
+	/** Cached version of MetaEngine::querySaveMetaInfos(). */
+	SaveStateDescriptor querySaveMetaInfos(int slot);
+
+	/** Write the index to the savefile directory, if it changed. */
+	void flush();
+
+private:
+	struct FileStamp {
+		Common::String name;
+		uint32 stamp;
+	};
+
+	struct PatternList {
+		Common::String pattern;
+		Common::StringArray names;
+	};
+
+	struct Entry {
+		Common::Array<FileStamp> files;
+		Common::Array<PatternList> patterns;
+		SaveStateList saves;
+	};
+
+	typedef Common::HashMap<int, Entry> SlotMap;
+
+	const MetaEngine &_metaEngine;
+	const Common::String _target;
+	Common::String _indexName;
+
+	bool _hasList;
+	Entry _list;
+	SlotMap _slots;
+	bool _dirty;
+
+	bool isValid(const Entry &entry) const;
+	bool fillEntry(Entry &entry, const Common::SavefileAccessLog &log) const;
+
+	void load();
+	bool loadEntry(Common::SeekableReadStream &in, Entry &entry) const;
+	bool canSaveEntry(const Entry &entry) const;
+	void saveEntry(Common::WriteStream &out, const Entry &entry) const;
+};
+
+#endif
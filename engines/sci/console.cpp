@@ -112,6 +112,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -356,6 +357,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows statistics of the resource cache, or changes its size\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -949,6 +951,43 @@ bool Console::cmdResourceInfo(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 2) {
+		debugPrintf("Shows statistics of the resource cache, or changes its size\n");
+		debugPrintf("Usage: %s [<size in KB> | reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!scumm_stricmp(argv[1], "reset")) {
+			resMan->resetCacheStats();
+			debugPrintf("Statistics reset\n");
+			return true;
+		}
+
+		int size = atoi(argv[1]);
+		if (size < 0) {
+			debugPrintf("Invalid size: %s\n", argv[1]);
+			return true;
+		}
+		resMan->setMaxMemory(size * 1024);
+	}
+
+	const ResourceCacheStats &stats = resMan->getCacheStats();
+	const uint32 requests = stats.hits + stats.misses;
+
+	debugPrintf("Cache size: %d KB, %d bytes in use, %d bytes locked\n",
+		resMan->getMaxMemory() / 1024, resMan->getMemoryLRU(), resMan->getMemoryLocked());
+	debugPrintf("Requests: %d, hits: %d (%d%%), misses: %d\n", requests, stats.hits,
+		requests ? stats.hits * 100 / requests : 0, stats.misses);
+	debugPrintf("Reloads of evicted resources: %d\n", stats.reloads);
+	debugPrintf("Evictions: %d (%d bytes)\n", stats.evictions, stats.evictedBytes);
+
+	return true;
+}
+
 bool Console::cmdResourceTypes(int argc, const char **argv) {
 	debugPrintf("The %d valid resource types are:\n", kResourceTypeInvalid);
 	for (int i = 0; i < kResourceTypeInvalid; i++) {
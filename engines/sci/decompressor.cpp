@@ -33,7 +33,7 @@
 #include "sci/resource.h"
 
 namespace Sci {
-int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+int Decompressor::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	uint32 chunk;
 	while (nPacked && !(src->eos() || src->err())) {
 		chunk = MIN<uint32>(1024, nPacked);
@@ -44,7 +44,7 @@ int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, ui
 	return (src->eos() || src->err()) ? 1 : 0;
 }
 
-void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
+void Decompressor::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
 	_src = src;
 	_dest = dest;
@@ -53,11 +53,37 @@ void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_nBits = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
+	_in = _inBuf;
+	_inPos = _inSize = 0;
+}
+
+byte Decompressor::fetchByte() {
+	if (_inPos == _inSize) {
+		// Everything buffered so far has been fetched, so _dwRead bytes of
+		// the packed data have been read
+		if (_dwRead < _szPacked) {
+			const byte *data = _src->getDataPtr();
+			if (data) {
+				// Take all of the remaining packed data at once
+				const int32 pos = _src->pos();
+				_in = data + pos;
+				_inSize = MIN<uint32>(_szPacked - _dwRead, MAX<int32>(_src->size() - pos, 0));
+				_src->skip(_inSize);
+			} else {
+				_in = _inBuf;
+				_inSize = _src->read(_inBuf, MIN<uint32>(kInputBufferSize, _szPacked - _dwRead));
+			}
+			_inPos = 0;
+		}
+		if (_inPos == _inSize)
+			return _src->readByte();
+	}
+	return _in[_inPos++];
 }
 
 void Decompressor::fetchBitsMSB() {
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
+		_dwBits |= ((uint32)fetchByte()) << (24 - _nBits);
 		_nBits += 8;
 		_dwRead++;
 	}
@@ -79,7 +105,7 @@ byte Decompressor::getByteMSB() {
 
 void Decompressor::fetchBitsLSB() {
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
+		_dwBits |= ((uint32)fetchByte()) << _nBits;
 		_nBits += 8;
 		_dwRead++;
 	}
@@ -105,7 +131,7 @@ void Decompressor::putByte(byte b) {
 //-------------------------------
 //  Huffman decompressor
 //-------------------------------
-int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorHuffman::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 	byte numnodes;
@@ -116,6 +142,7 @@ int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPac
 	terminator = _src->readByte() | 0x100;
 	_nodes = new byte [numnodes << 1];
 	_src->read(_nodes, numnodes << 1);
+	buildTable(numnodes);
 
 	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
 		putByte(c);
@@ -124,8 +151,61 @@ int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPac
 	return _dwWrote == _szUnpacked ? 0 : 1;
 }
 
+void DecompressorHuffman::buildTable(byte numnodes) {
+	// Walk the tree for every possible value of the next kLookupBits bits,
+	// so that most codes can be decoded with a single lookup
+	for (uint i = 0; i < ARRAYSIZE(_table); i++) {
+		HuffmanEntry &entry = _table[i];
+		uint node = 0;
+		byte bits = 0;
+
+		entry.type = kHuffmanNode;
+		while (node < numnodes && bits < kLookupBits) {
+			if (!_nodes[(node << 1) + 1]) {
+				entry.type = kHuffmanLeaf;
+				break;
+			}
+
+			byte next;
+			if ((i << bits) & (1 << (kLookupBits - 1))) {
+				next = _nodes[(node << 1) + 1] & 0x0F;
+				if (next == 0) {
+					bits++;
+					entry.type = kHuffmanEscape;
+					break;
+				}
+			} else
+				next = _nodes[(node << 1) + 1] >> 4;
+			node += next;
+			bits++;
+		}
+
+		// Broken trees lead past the last node, these are left to getc2()
+		if (node >= numnodes) {
+			entry.type = kHuffmanNode;
+			node = 0;
+			bits = 0;
+		}
+
+		entry.bits = bits;
+		entry.value = (entry.type == kHuffmanLeaf) ? _nodes[node << 1] : node;
+	}
+}
+
 int16 DecompressorHuffman::getc2() {
-	byte *node = _nodes;
+	if (_nBits < kLookupBits)
+		fetchBitsMSB();
+	const HuffmanEntry &entry = _table[_dwBits >> (32 - kLookupBits)];
+	_dwBits <<= entry.bits;
+	_nBits -= entry.bits;
+
+	if (entry.type == kHuffmanLeaf)
+		return entry.value;
+	if (entry.type == kHuffmanEscape)
+		return getByteMSB() | 0x100;
+
+	// The code is longer than the lookup bits, follow the tree bit by bit
+	byte *node = _nodes + (entry.value << 1);
 	int16 next;
 	while (node[1]) {
 		if (getBitsMSB(1)) {
@@ -142,7 +222,7 @@ int16 DecompressorHuffman::getc2() {
 //-------------------------------
 // LZW Decompressor for SCI0/01/1
 //-------------------------------
-void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+void DecompressorLZW::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	Decompressor::init(src, dest, nPacked, nUnpacked);
 
 	_numbits = 9;
@@ -150,7 +230,7 @@ void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_endtoken = 0x1ff;
 }
 
-int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	byte *buffer = NULL;
 
@@ -176,7 +256,7 @@ int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	return 0;
 }
 
-int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
@@ -252,7 +332,7 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
-int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
@@ -623,7 +703,7 @@ void DecompressorLZW::reorderView(byte *src, byte *dest) {
 // DCL decompressor for SCI1.1
 //----------------------------------------------
 
-int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorDCL::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                             uint32 nUnpacked) {
 	return Common::decompressDCL(src, dest, nPacked, nUnpacked) ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
@@ -634,7 +714,7 @@ int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 // STACpack/LZS decompressor for SCI32
 // Based on Andre Beck's code from http://micky.ibh.de/~beck/stuff/lzs4i4l/
 //----------------------------------------------
-int DecompressorLZS::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+int DecompressorLZS::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 	return unpackLZS();
 }
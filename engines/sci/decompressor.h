@@ -26,7 +26,7 @@
 #include "common/scummsys.h"
 
 namespace Common {
-class ReadStream;
+class SeekableReadStream;
 }
 
 namespace Sci {
@@ -55,7 +55,7 @@ public:
 	virtual ~Decompressor() {}
 
 
-	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	/**
@@ -66,7 +66,7 @@ protected:
 	 * @param nUnpacket	size of unpacked data
 	 * @return 0 on success, non-zero on error
 	 */
-	virtual void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	/**
 	 * Get a number of bits from _src stream, starting with the most
@@ -94,12 +94,20 @@ protected:
 	void fetchBitsMSB();
 	void fetchBitsLSB();
 
+	/**
+	 * Get the next byte of the packed data for the bits buffer. The packed
+	 * data is read from _src in blocks, any bytes past it one at a time.
+	 * If _src keeps its data in memory (e.g. a memory mapped volume), the
+	 * packed data is used in place instead.
+	 * @return byte
+	 */
+	byte fetchByte();
+
 	/**
 	 * Write one byte into _dest stream
 	 * @param b byte to put
 	 */
-
-	virtual void putByte(byte b);
+	void putByte(byte b);
 
 	/**
 	 * Returns true if all expected data has been unpacked to _dest
@@ -115,8 +123,17 @@ protected:
 	uint32 _szUnpacked;	///< size of the decompressed data
 	uint32 _dwRead;		///< number of bytes read from _src
 	uint32 _dwWrote;	///< number of bytes written to _dest
-	Common::ReadStream *_src;
+	Common::SeekableReadStream *_src;
 	byte *_dest;
+
+	enum {
+		kInputBufferSize = 1024
+	};
+
+	byte _inBuf[kInputBufferSize];	///< block of packed data read from _src
+	const byte *_in;	///< the packed data being fetched, in _inBuf or in the data of _src
+	uint32 _inPos;		///< number of bytes of _in already fetched
+	uint32 _inSize;		///< number of valid bytes in _in
 };
 
 /**
@@ -124,12 +141,32 @@ protected:
  */
 class DecompressorHuffman : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	int16 getc2();
+	void buildTable(byte numnodes);
 
 	byte *_nodes;
+
+	enum HuffmanEntryType {
+		kHuffmanLeaf,	///< a full code, value is the decoded character
+		kHuffmanEscape,	///< an escape code, a literal byte follows
+		kHuffmanNode	///< a code longer than the lookup bits, value is the node to go on from
+	};
+
+	enum {
+		kLookupBits = 8
+	};
+
+	/** Result of decoding kLookupBits bits at once */
+	struct HuffmanEntry {
+		uint16 value;
+		byte bits;	///< number of bits used
+		byte type;	///< a HuffmanEntryType
+	};
+
+	HuffmanEntry _table[1 << kLookupBits];
 };
 
 /**
@@ -141,8 +178,8 @@ public:
 	DecompressorLZW(int nCompression) {
 		_compression = nCompression;
 	}
-	void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	enum {
@@ -152,8 +189,8 @@ protected:
 	};
 	// unpacking procedures
 	// TODO: unpackLZW and unpackLZW1 are similar and should be merged
-	int unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	// functions to post-process view and pic resources
 	void reorderPic(byte *src, byte *dest, int dsize);
@@ -177,7 +214,7 @@ protected:
  */
 class DecompressorDCL : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 };
 
 #ifdef ENABLE_SCI32
@@ -186,7 +223,7 @@ public:
  */
 class DecompressorLZS : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 protected:
 	int unpackLZS();
 	uint32 getCompLen();
@@ -22,6 +22,8 @@
 
 // Resource library
 
+#include "common/bufferedstream.h"
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
@@ -191,6 +193,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_protected = false;
+	_evicted = false;
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
@@ -332,41 +336,56 @@ bool Resource::loadFromPatchFile() {
 }
 
 Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *source) {
-	Common::List<Common::File *>::iterator it = _volumeFiles.begin();
-	Common::File *file;
+	Common::List<VolumeFile>::iterator it = _volumeFiles.begin();
 
 	if (source->_resourceFile)
 		return source->_resourceFile->createReadStream();
 
-	const char *filename = source->getLocationName().c_str();
+	const Common::String &filename = source->getLocationName();
 
 	// check if file is already opened
 	while (it != _volumeFiles.end()) {
-		file = *it;
-		if (scumm_stricmp(file->getName(), filename) == 0) {
+		if (it->name.equalsIgnoreCase(filename)) {
 			// move file to top
 			if (it != _volumeFiles.begin()) {
+				VolumeFile volume = *it;
 				_volumeFiles.erase(it);
-				_volumeFiles.push_front(file);
+				_volumeFiles.push_front(volume);
 			}
-			return file;
+			return _volumeFiles.front().stream;
 		}
 		++it;
 	}
-	// adding a new file
-	file = new Common::File;
-	if (file->open(filename)) {
-		if (_volumeFiles.size() == MAX_OPENED_VOLUMES) {
-			it = --_volumeFiles.end();
-			delete *it;
-			_volumeFiles.erase(it);
+	// adding a new file. Volumes are read many times and never written to,
+	// so they are memory mapped where possible, and the decompressors use
+	// the resource data in place.
+	Common::SeekableReadStream *stream = SearchMan.createMappedReadStreamForMember(filename);
+	if (!stream) {
+		Common::File *file = new Common::File;
+		if (!file->open(filename)) {
+			// failed
+			delete file;
+			return NULL;
 		}
-		_volumeFiles.push_front(file);
-		return file;
+		stream = file;
 	}
-	// failed
-	delete file;
-	return NULL;
+
+	if (_volumeFiles.size() >= _maxOpenedVolumes) {
+		it = --_volumeFiles.end();
+		delete it->stream;
+		_volumeFiles.erase(it);
+	}
+
+	VolumeFile volume;
+	volume.name = filename;
+	// Resources are read with many small reads (headers, map entries), so
+	// keep a read window for every volume. Mapped volumes don't need one.
+	if (stream->getDataPtr())
+		volume.stream = stream;
+	else
+		volume.stream = Common::wrapBufferedSeekableReadStream(stream, VOLUME_BUFFER_SIZE, DisposeAfterUse::YES);
+	_volumeFiles.push_front(volume);
+	return volume.stream;
 }
 
 void ResourceManager::loadResource(Resource *res) {
@@ -858,12 +877,26 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager() {
+	// SCI32 games interleave reads from several resource and audio volumes,
+	// so allow keeping more of them open if needed
+	_maxOpenedVolumes = DEFAULT_OPENED_VOLUMES;
+	if (ConfMan.hasKey("max_opened_volumes"))
+		_maxOpenedVolumes = MAX(ConfMan.getInt("max_opened_volumes"), 1);
+
+	// Machines with little memory may want a smaller resource cache, others
+	// a larger one, to avoid reloading resources
+	_maxMemory = MAX_MEMORY;
+	if (ConfMan.hasKey("resource_cache_size"))
+		_maxMemory = MAX(ConfMan.getInt("resource_cache_size"), 0) * 1024;
 }
 
 void ResourceManager::init() {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_memoryProtected = 0;
 	_LRU.clear();
+	_protectedLRU.clear();
+	resetCacheStats();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -949,7 +982,10 @@ void ResourceManager::initForDetection() {
 
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_memoryProtected = 0;
 	_LRU.clear();
+	_protectedLRU.clear();
+	resetCacheStats();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -969,9 +1005,9 @@ ResourceManager::~ResourceManager() {
 	}
 	freeResourceSources();
 
-	Common::List<Common::File *>::iterator it = _volumeFiles.begin();
+	Common::List<VolumeFile>::iterator it = _volumeFiles.begin();
 	while (it != _volumeFiles.end()) {
-		delete *it;
+		delete it->stream;
 		++it;
 	}
 }
@@ -981,7 +1017,12 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	if (res->_protected) {
+		_protectedLRU.remove(res);
+		_memoryProtected -= res->size;
+	} else {
+		_LRU.remove(res);
+	}
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -991,7 +1032,21 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+
+	// Resources which were used more than once go to the protected segment,
+	// unless they would take more than half of it. The protected segment
+	// may use up to three quarters of the memory, its least recently used
+	// resources are moved back to the other segment.
+	if (res->_protected && (int)res->size > _maxMemory / 4 * 3 / 2)
+		res->_protected = false;
+
+	if (res->_protected) {
+		_protectedLRU.push_front(res);
+		_memoryProtected += res->size;
+		shrinkProtectedLRU();
+	} else {
+		_LRU.push_front(res);
+	}
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1004,32 +1059,70 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
+	Common::List<Resource *>::iterator it;
 	Resource *res;
 
-	while (it != _LRU.end()) {
+	for (it = _protectedLRU.begin(); it != _protectedLRU.end(); ++it) {
+		res = *it;
+		debug("\t%s: %d bytes (protected)", res->_id.toString().c_str(), res->size);
+		mem += res->size;
+		++entries;
+	}
+
+	for (it = _LRU.begin(); it != _LRU.end(); ++it) {
 		res = *it;
 		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
 		mem += res->size;
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+	while (_maxMemory < _memoryLRU) {
+		// Resources used only once are freed first
+		Resource *goner;
+		if (!_LRU.empty()) {
+			goner = *_LRU.reverse_begin();
+		} else {
+			assert(!_protectedLRU.empty());
+			goner = *_protectedLRU.reverse_begin();
+		}
 		removeFromLRU(goner);
 		goner->unalloc();
+		goner->_protected = false;
+		goner->_evicted = true;
+		_cacheStats.evictions++;
+		_cacheStats.evictedBytes += goner->size;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
 	}
 }
 
+void ResourceManager::setMaxMemory(int maxMemory) {
+	_maxMemory = maxMemory;
+
+	shrinkProtectedLRU();
+	freeOldResources();
+}
+
+void ResourceManager::shrinkProtectedLRU() {
+	while (_memoryProtected > _maxMemory / 4 * 3) {
+		assert(!_protectedLRU.empty());
+		Resource *demoted = *_protectedLRU.reverse_begin();
+		_protectedLRU.pop_back();
+		_memoryProtected -= demoted->size;
+		demoted->_protected = false;
+		_LRU.push_front(demoted);
+	}
+}
+
+void ResourceManager::resetCacheStats() {
+	memset(&_cacheStats, 0, sizeof(_cacheStats));
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1049,10 +1142,18 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
+		if (retval->_evicted)
+			_cacheStats.reloads++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		_cacheStats.hits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+		// Keep resources which are used again longer than others
+		retval->_protected = true;
+	}
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
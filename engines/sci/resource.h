@@ -68,7 +68,8 @@ enum ResourceErrorCodes {
 };
 
 enum {
-	MAX_OPENED_VOLUMES = 5 ///< Max number of simultaneously opened volumes
+	DEFAULT_OPENED_VOLUMES = 16, ///< Default max number of simultaneously opened volumes
+	VOLUME_BUFFER_SIZE = 8192 ///< Size of the read window kept for each opened volume
 };
 
 enum ResourceType {
@@ -271,6 +272,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _protected; /**< Requested more than once, kept in the protected LRU segment */
+	bool _evicted; /**< Freed by the LRU before, so loading it again is a reload */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -285,6 +288,15 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+/** Counters of the resource manager's LRU cache, shown by the "resource_cache" console command */
+struct ResourceCacheStats {
+	uint32 hits; /**< Requests for resources which were still in memory */
+	uint32 misses; /**< Requests which had to load the resource */
+	uint32 reloads; /**< Misses for resources which had been evicted before */
+	uint32 evictions; /**< Resources freed to stay below the memory cap */
+	uint32 evictedBytes; /**< Total size of the evicted resources */
+};
+
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
 	// ease transition to the ResourceSource class system.
@@ -367,6 +379,18 @@ public:
 	 */
 	Common::List<ResourceId> listResources(ResourceType type, int mapNumber = -1);
 
+	/**
+	 * Sets the number of bytes unlocked resources may use before they are
+	 * freed again. Defaults to MAX_MEMORY, and can be set with the
+	 * "resource_cache_size" config key (in KB).
+	 */
+	void setMaxMemory(int maxMemory);
+	int getMaxMemory() const { return _maxMemory; }
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMemoryLocked() const { return _memoryLocked; }
+	const ResourceCacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats();
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(Common::String path);
@@ -422,7 +446,7 @@ public:
 	ResourceType convertResType(byte type);
 
 protected:
-	// Maximum number of bytes to allow being allocated for resources
+	// Default maximum number of bytes to allow being allocated for resources
 	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
@@ -432,11 +456,22 @@ protected:
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
+	int _maxMemory;		///< Amount of resource bytes allowed under LRU control
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	int _memoryProtected;	///< Amount of resource bytes in the protected LRU segment
+	Common::List<Resource *> _LRU; ///< Last Resource Used list, for resources used once
+	Common::List<Resource *> _protectedLRU; ///< Last Resource Used list, for resources used again
+	ResourceCacheStats _cacheStats;
 	ResourceMap _resMap;
-	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
+
+	struct VolumeFile {
+		Common::String name;
+		Common::SeekableReadStream *stream;
+	};
+
+	Common::List<VolumeFile> _volumeFiles; ///< list of opened volume files, most recently used first
+	uint _maxOpenedVolumes; ///< Max number of simultaneously opened volumes
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
 	ResVersion _volVersion; ///< resource.0xx version
 	ResVersion _mapVersion; ///< resource.map version
@@ -554,6 +589,7 @@ protected:
 	void printLRU();
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
+	void shrinkProtectedLRU();
 
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
@@ -38,6 +38,7 @@
 #include "graphics/transparent_surface.h"
 #include "common/queue.h"
 #include "common/config-manager.h"
+#include "common/threadpool.h"
 
 #define DIRTY_RECT_LIMIT 800
 
@@ -62,6 +63,20 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 	if (ConfMan.hasKey("dirty_rects")) {
 		_disableDirtyRects = !ConfMan.getBool("dirty_rects");
 	}
+	_bilinearFiltering = false;
+	if (ConfMan.hasKey("bilinear_filtering")) {
+		_bilinearFiltering = ConfMan.getBool("bilinear_filtering");
+	}
+
+	// Large scaled and rotated sprites are transformed on all cores
+	_transformPool = nullptr;
+	if (g_system->getCPUCount() > 1) {
+		_transformPool = new Common::ThreadPool(g_system->getCPUCount() - 1, "WMETransform");
+		if (_transformPool->getThreadCount() == 0) {
+			delete _transformPool;
+			_transformPool = nullptr;
+		}
+	}
 
 	_lastScreenChangeID = g_system->getScreenChangeID();
 }
@@ -76,6 +91,7 @@ BaseRenderOSystem::~BaseRenderOSystem() {
 	}
 
 	delete _dirtyRect;
+	delete _transformPool;
 
 	_renderSurface->free();
 	delete _renderSurface;
@@ -271,7 +287,7 @@ Graphics::PixelFormat BaseRenderOSystem::getPixelFormat() const {
 void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform) {
 
 	if (_disableDirtyRects) {
-		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, _bilinearFiltering, _transformPool);
 		ticket->_wantsDraw = true;
 		_renderQueue.push_back(ticket);
 		drawFromSurface(ticket);
@@ -303,7 +319,7 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 			}
 		}
 	}
-	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, _bilinearFiltering, _transformPool);
 	if (!_disableDirtyRects) {
 		drawFromTicket(ticket);
 	} else {
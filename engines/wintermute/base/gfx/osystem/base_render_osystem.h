@@ -35,6 +35,10 @@
 #include "common/list.h"
 #include "graphics/transform_struct.h"
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace Wintermute {
 class BaseSurfaceOSystem;
 class RenderTicket;
@@ -141,6 +145,8 @@ private:
 	int _borderBottom;
 
 	bool _disableDirtyRects;
+	bool _bilinearFiltering; // scale and rotate sprites with bilinear filtering
+	Common::ThreadPool *_transformPool; // threads for transforming large sprites, or nullptr
 	float _ratioX;
 	float _ratioY;
 	uint32 _clearColor;
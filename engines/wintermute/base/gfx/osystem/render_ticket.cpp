@@ -34,7 +34,7 @@
 
 namespace Wintermute {
 
-RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform) :
+RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, bool filtering, Common::ThreadPool *pool) :
 	_owner(owner),
 	_srcRect(*srcRect),
 	_dstRect(*dstRect),
@@ -59,7 +59,7 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 		// TransformTools.)
 		if (_transform._angle != Graphics::kDefaultAngle) {
 			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.rotoscale(transform);
+			Graphics::Surface *temp = src.rotoscale(transform, filtering, pool);
 			_surface->free();
 			delete _surface;
 			_surface = temp;
@@ -67,7 +67,7 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 					dstRect->height() != srcRect->height()) &&
 					_transform._numTimesX * _transform._numTimesY == 1) {
 			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height());
+			Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height(), filtering, pool);
 			_surface->free();
 			delete _surface;
 			_surface = temp;
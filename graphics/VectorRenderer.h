@@ -273,6 +273,13 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the active drawing surface.
+	 */
+	Surface *getActiveSurface() const {
+		return _activeSurface;
+	}
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -427,6 +434,16 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets up the colors and drawing properties of the specified draw step,
+	 * without drawing anything. This leaves the renderer in the same state
+	 * as drawStep() does.
+	 *
+	 * @param step Pointer to a DrawStep struct.
+	 * @param extra Dynamic data of the step.
+	 */
+	void applyStepState(const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -483,6 +500,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsEnabled() const { return !_disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
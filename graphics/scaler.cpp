@@ -20,14 +20,39 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
+// SSE2 is always available on x86-64 and NEON is always available on
+// AArch64; on other CPUs, the compiler has to be told to use them.
+#if defined(USE_HQ_SCALERS) && defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_HQ_SSE2
+#elif defined(USE_HQ_SCALERS) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define USE_HQ_NEON
+#endif
+
 int gBitFormat = 565;
 
+bool gScalerSIMD = true;
+
+void SetScalerSIMD(bool enable) {
+	gScalerSIMD = enable;
+}
+
+bool IsScalerReentrant(ScalerProc *scalerProc) {
+#if defined(USE_SCALERS) && defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	if (scalerProc == HQ2x || scalerProc == HQ3x)
+		return false;
+#endif
+	return true;
+}
+
 #ifdef USE_HQ_SCALERS
 // RGB-to-YUV lookup table
 extern "C" {
@@ -117,6 +142,103 @@ void InitLUT(Graphics::PixelFormat format) {
 	hqx_green_redBlue_Mask = (hqx_greenMask << 16) | hqx_redBlueMask;
 #endif
 }
+
+/** The number of YUV values the pattern masks handle at once */
+#if defined(USE_HQ_SSE2) || defined(USE_HQ_NEON)
+static const int kYUVStep = 4;
+#endif
+
+#if defined(USE_HQ_SSE2)
+/**
+ * Check four pixels against one of their neighbours each, like diffYUV, and
+ * return the given pattern bit in each lane where they differ.
+ */
+static inline __m128i diffYUVMask(__m128i yuv5, const uint32 *neighbours, __m128i threshold, uint32 bit) {
+	const __m128i yuv = _mm_loadu_si128((const __m128i *)neighbours);
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(yuv5, yuv), _mm_subs_epu8(yuv, yuv5));
+	const __m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, threshold), _mm_setzero_si128());
+	return _mm_andnot_si128(same, _mm_set1_epi32(bit));
+}
+#elif defined(USE_HQ_NEON)
+static inline uint32x4_t diffYUVMask(uint8x16_t yuv5, const uint32 *neighbours, uint8x16_t threshold, uint32 bit) {
+	const uint8x16_t diff = vabdq_u8(yuv5, vreinterpretq_u8_u32(vld1q_u32(neighbours)));
+	const uint32x4_t above = vreinterpretq_u32_u8(vcgtq_u8(diff, threshold));
+	return vandq_u32(vtstq_u32(above, above), vdupq_n_u32(bit));
+}
+#endif
+
+void computeHQPatterns(const uint16 *p, uint32 nextlineSrc, int width, uint8 *patterns) {
+	assert(width <= kHQPatternChunk);
+
+	// Look up every pixel once, instead of once for each of its neighbours
+	uint32 yuvAbove[kHQPatternChunk + 2], yuvRow[kHQPatternChunk + 2], yuvBelow[kHQPatternChunk + 2];
+	for (int x = -1; x <= width; x++) {
+		yuvAbove[x + 1] = RGBtoYUV[*(p + x - nextlineSrc)];
+		yuvRow[x + 1] = RGBtoYUV[*(p + x)];
+		yuvBelow[x + 1] = RGBtoYUV[*(p + x + nextlineSrc)];
+	}
+
+	int x = 0;
+
+	// Equal pixels have equal YUV values, so unlike the scalers used to,
+	// the pixels themselves don't need to be compared first. The thresholds
+	// of diffYUV are checked per component; the unused top byte of each
+	// YUV value is never above its threshold.
+#if defined(USE_HQ_SSE2)
+	if (gScalerSIMD) {
+		const __m128i threshold = _mm_set1_epi32(0xFF300706);
+		for (; x + kYUVStep <= width; x += kYUVStep) {
+			const __m128i yuv5 = _mm_loadu_si128((const __m128i *)&yuvRow[x + 1]);
+			__m128i pattern = diffYUVMask(yuv5, &yuvAbove[x], threshold, 0x01);
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvAbove[x + 1], threshold, 0x02));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvAbove[x + 2], threshold, 0x04));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvRow[x], threshold, 0x08));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvRow[x + 2], threshold, 0x10));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvBelow[x], threshold, 0x20));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvBelow[x + 1], threshold, 0x40));
+			pattern = _mm_or_si128(pattern, diffYUVMask(yuv5, &yuvBelow[x + 2], threshold, 0x80));
+
+			pattern = _mm_packs_epi32(pattern, pattern);
+			pattern = _mm_packus_epi16(pattern, pattern);
+			const uint32 packed = _mm_cvtsi128_si32(pattern);
+			memcpy(patterns + x, &packed, kYUVStep);
+		}
+	}
+#elif defined(USE_HQ_NEON)
+	if (gScalerSIMD) {
+		const uint8x16_t threshold = vreinterpretq_u8_u32(vdupq_n_u32(0xFF300706));
+		for (; x + kYUVStep <= width; x += kYUVStep) {
+			const uint8x16_t yuv5 = vreinterpretq_u8_u32(vld1q_u32(&yuvRow[x + 1]));
+			uint32x4_t pattern = diffYUVMask(yuv5, &yuvAbove[x], threshold, 0x01);
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvAbove[x + 1], threshold, 0x02));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvAbove[x + 2], threshold, 0x04));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvRow[x], threshold, 0x08));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvRow[x + 2], threshold, 0x10));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvBelow[x], threshold, 0x20));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvBelow[x + 1], threshold, 0x40));
+			pattern = vorrq_u32(pattern, diffYUVMask(yuv5, &yuvBelow[x + 2], threshold, 0x80));
+
+			const uint16x4_t narrow = vmovn_u32(pattern);
+			const uint8x8_t packed = vmovn_u16(vcombine_u16(narrow, narrow));
+			vst1_lane_u32((uint32 *)(patterns + x), vreinterpret_u32_u8(packed), 0);
+		}
+	}
+#endif
+
+	for (; x < width; x++) {
+		const int yuv5 = yuvRow[x + 1];
+		int pattern = 0;
+		if (diffYUV(yuv5, yuvAbove[x])) pattern |= 0x0001;
+		if (diffYUV(yuv5, yuvAbove[x + 1])) pattern |= 0x0002;
+		if (diffYUV(yuv5, yuvAbove[x + 2])) pattern |= 0x0004;
+		if (diffYUV(yuv5, yuvRow[x])) pattern |= 0x0008;
+		if (diffYUV(yuv5, yuvRow[x + 2])) pattern |= 0x0010;
+		if (diffYUV(yuv5, yuvBelow[x])) pattern |= 0x0020;
+		if (diffYUV(yuv5, yuvBelow[x + 1])) pattern |= 0x0040;
+		if (diffYUV(yuv5, yuvBelow[x + 2])) pattern |= 0x0080;
+		patterns[x] = pattern;
+	}
+}
 #endif
 
 
@@ -29,9 +29,23 @@
 extern void InitScalers(uint32 BitFormat);
 extern void DestroyScalers();
 
+/**
+ * Enable or disable the SSE2/NEON code paths of the scalers, where the CPU
+ * has them. They are enabled by default; disabling them is only useful to
+ * compare their results with the generic code.
+ */
+extern void SetScalerSIMD(bool enable);
+
 typedef void ScalerProc(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
+/**
+ * Return whether a scaler may run on several threads at once, e.g. on
+ * different bands of the same screen. This is not the case for the
+ * assembly versions of the HQ scalers, which keep their state in globals.
+ */
+extern bool IsScalerReentrant(ScalerProc *scalerProc);
+
 #define DECLARE_SCALER(x)	\
 	extern void x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, \
 					uint32 dstPitch, int width, int height)
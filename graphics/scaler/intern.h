@@ -24,6 +24,7 @@
 #define GRAPHICS_SCALER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/util.h"
 #include "graphics/colormasks.h"
 
 
@@ -218,4 +219,22 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+#ifdef USE_HQ_SCALERS
+
+/** The largest number of pixels computeHQPatterns() handles per call. */
+enum {
+	kHQPatternChunk = 256
+};
+
+/**
+ * Compute the neighbour patterns used by the hq scaler family for a run of
+ * pixels: bit n is set when the pixel differs from its n-th neighbour
+ * (in the order top left, top, top right, left, right, bottom left, bottom,
+ * bottom right) according to diffYUV. The row above and below p, and one
+ * pixel on each side of the run, have to be readable.
+ */
+void computeHQPatterns(const uint16 *p, uint32 nextlineSrc, int width, uint8 *patterns);
+
+#endif
+
 #endif
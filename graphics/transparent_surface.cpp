@@ -33,11 +33,22 @@
 #include "common/rect.h"
 #include "common/math.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
 
-//#define ENABLE_BILINEAR
+// The SIMD versions of the blitting loops assume the little endian pixel
+// layout, with alpha in the lowest byte of each pixel.
+#ifdef SCUMM_LITTLE_ENDIAN
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_BLIT_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define USE_BLIT_NEON
+#endif
+#endif
 
 namespace Graphics {
 
@@ -82,6 +93,260 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 	}
 }
 
+#if defined(USE_BLIT_SSE2) || defined(USE_BLIT_NEON)
+
+/*
+ * SIMD versions of the innermost loops of the blitters below. Each of them
+ * handles as many pixels of a row as it can in blocks of four, and returns
+ * how many pixels it handled; the rest is left to the generic code. They
+ * produce exactly the same results as the generic code, and require the
+ * input pixels to be contiguous.
+ */
+
+#if defined(USE_BLIT_SSE2)
+
+static inline __m128i broadcastAlpha(__m128i pixels) {
+	__m128i alpha = _mm_and_si128(pixels, _mm_set1_epi32(0xFF));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+	return _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+}
+
+static inline __m128i selectPixels(__m128i mask, __m128i ifSet, __m128i ifClear) {
+	return _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear));
+}
+
+static uint32 blitBinarySIMD(const byte *in, byte *out, uint32 width) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		__m128i src = _mm_loadu_si128((const __m128i *)in);
+		__m128i dst = _mm_loadu_si128((const __m128i *)out);
+		__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), _mm_setzero_si128());
+		_mm_storeu_si128((__m128i *)out, selectPixels(transparent, dst, _mm_or_si128(src, alphaMask)));
+	}
+
+	return j;
+}
+
+static uint32 blitAlphaBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i max = _mm_set1_epi16(255);
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		__m128i src = _mm_loadu_si128((const __m128i *)in);
+		__m128i dst = _mm_loadu_si128((const __m128i *)out);
+		__m128i alpha = broadcastAlpha(src);
+		__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), zero);
+
+		__m128i alphaLo = _mm_unpacklo_epi8(alpha, zero);
+		__m128i alphaHi = _mm_unpackhi_epi8(alpha, zero);
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), alphaLo),
+		                           _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(max, alphaLo)));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), alphaHi),
+		                           _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(max, alphaHi)));
+		__m128i result = _mm_or_si128(_mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)), alphaMask);
+
+		_mm_storeu_si128((__m128i *)out, selectPixels(transparent, dst, result));
+	}
+
+	return j;
+}
+
+static uint32 blitAlphaBlendSIMD(const byte *in, byte *out, uint32 width, byte ca, byte cr, byte cg, byte cb) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i alphaMod = _mm_set1_epi16(ca);
+	const __m128i colorMod = _mm_unpacklo_epi8(_mm_set1_epi32(((uint32)cb << 8) | ((uint32)cg << 16) | ((uint32)cr << 24)), zero);
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		__m128i src = _mm_loadu_si128((const __m128i *)in);
+		__m128i dst = _mm_loadu_si128((const __m128i *)out);
+		__m128i alpha = broadcastAlpha(src);
+
+		__m128i alphaLo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(alpha, zero), alphaMod), 8);
+		__m128i alphaHi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(alpha, zero), alphaMod), 8);
+		__m128i lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(max, alphaLo)), 8),
+		                           _mm_mulhi_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), colorMod), alphaLo));
+		__m128i hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(max, alphaHi)), 8),
+		                           _mm_mulhi_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), colorMod), alphaHi));
+
+		_mm_storeu_si128((__m128i *)out, _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask));
+	}
+
+	return j;
+}
+
+static uint32 blitAdditiveBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i colorMask = _mm_set1_epi32(0xFFFFFF00);
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		__m128i src = _mm_loadu_si128((const __m128i *)in);
+		__m128i dst = _mm_loadu_si128((const __m128i *)out);
+		__m128i alpha = broadcastAlpha(src);
+
+		__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(alpha, zero)), 8);
+		__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(alpha, zero)), 8);
+		__m128i add = _mm_and_si128(_mm_packus_epi16(lo, hi), colorMask);
+
+		_mm_storeu_si128((__m128i *)out, _mm_adds_epu8(dst, add));
+	}
+
+	return j;
+}
+
+static uint32 blitSubtractiveBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i colorMask = _mm_set1_epi32(0xFFFFFF00);
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		__m128i src = _mm_loadu_si128((const __m128i *)in);
+		__m128i dst = _mm_loadu_si128((const __m128i *)out);
+		__m128i alpha = broadcastAlpha(src);
+
+		__m128i lo = _mm_mulhi_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero)), _mm_unpacklo_epi8(alpha, zero));
+		__m128i hi = _mm_mulhi_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero)), _mm_unpackhi_epi8(alpha, zero));
+		__m128i sub = _mm_and_si128(_mm_packus_epi16(lo, hi), colorMask);
+
+		_mm_storeu_si128((__m128i *)out, _mm_subs_epu8(dst, sub));
+	}
+
+	return j;
+}
+
+#elif defined(USE_BLIT_NEON)
+
+static inline uint8x16_t broadcastAlpha(uint8x16_t pixels) {
+	uint32x4_t alpha = vandq_u32(vreinterpretq_u32_u8(pixels), vdupq_n_u32(0xFF));
+	alpha = vorrq_u32(alpha, vshlq_n_u32(alpha, 8));
+	return vreinterpretq_u8_u32(vorrq_u32(alpha, vshlq_n_u32(alpha, 16)));
+}
+
+static inline uint8x16_t opaquePixels(uint8x16_t pixels) {
+	return vreinterpretq_u8_u32(vtstq_u32(vreinterpretq_u32_u8(pixels), vdupq_n_u32(0xFF)));
+}
+
+static uint32 blitBinarySIMD(const byte *in, byte *out, uint32 width) {
+	const uint8x16_t alphaMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFF));
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		uint8x16_t src = vld1q_u8(in);
+		uint8x16_t dst = vld1q_u8(out);
+
+		vst1q_u8(out, vbslq_u8(opaquePixels(src), vorrq_u8(src, alphaMask), dst));
+	}
+
+	return j;
+}
+
+static uint32 blitAlphaBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const uint8x16_t alphaMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFF));
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		uint8x16_t src = vld1q_u8(in);
+		uint8x16_t dst = vld1q_u8(out);
+		uint8x16_t alpha = broadcastAlpha(src);
+		uint8x16_t invAlpha = vmvnq_u8(alpha);
+
+		uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(src), vget_low_u8(alpha)), vget_low_u8(dst), vget_low_u8(invAlpha));
+		uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(src), vget_high_u8(alpha)), vget_high_u8(dst), vget_high_u8(invAlpha));
+		uint8x16_t result = vorrq_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)), alphaMask);
+
+		vst1q_u8(out, vbslq_u8(opaquePixels(src), result, dst));
+	}
+
+	return j;
+}
+
+static inline uint8x8_t modulateAlphaBlend(uint8x8_t src, uint8x8_t dst, uint8x8_t alpha, uint8x8_t alphaMod, uint8x8_t colorMod) {
+	uint8x8_t ina = vshrn_n_u16(vmull_u8(alpha, alphaMod), 8);
+	uint8x8_t faded = vshrn_n_u16(vmull_u8(dst, vmvn_u8(ina)), 8);
+	uint16x8_t color = vmull_u8(src, colorMod);
+	uint16x8_t ina16 = vmovl_u8(ina);
+	uint16x4_t addLo = vshrn_n_u32(vmull_u16(vget_low_u16(color), vget_low_u16(ina16)), 16);
+	uint16x4_t addHi = vshrn_n_u32(vmull_u16(vget_high_u16(color), vget_high_u16(ina16)), 16);
+	return vadd_u8(faded, vmovn_u16(vcombine_u16(addLo, addHi)));
+}
+
+static uint32 blitAlphaBlendSIMD(const byte *in, byte *out, uint32 width, byte ca, byte cr, byte cg, byte cb) {
+	const uint8x16_t alphaMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFF));
+	const uint8x8_t alphaMod = vdup_n_u8(ca);
+	const uint8x8_t colorMod = vreinterpret_u8_u32(vdup_n_u32(((uint32)cb << 8) | ((uint32)cg << 16) | ((uint32)cr << 24)));
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		uint8x16_t src = vld1q_u8(in);
+		uint8x16_t dst = vld1q_u8(out);
+		uint8x16_t alpha = broadcastAlpha(src);
+
+		uint8x8_t lo = modulateAlphaBlend(vget_low_u8(src), vget_low_u8(dst), vget_low_u8(alpha), alphaMod, colorMod);
+		uint8x8_t hi = modulateAlphaBlend(vget_high_u8(src), vget_high_u8(dst), vget_high_u8(alpha), alphaMod, colorMod);
+
+		vst1q_u8(out, vorrq_u8(vcombine_u8(lo, hi), alphaMask));
+	}
+
+	return j;
+}
+
+static uint32 blitAdditiveBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const uint8x16_t colorMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFFFFFF00));
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		uint8x16_t src = vld1q_u8(in);
+		uint8x16_t dst = vld1q_u8(out);
+		uint8x16_t alpha = broadcastAlpha(src);
+
+		uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(src), vget_low_u8(alpha)), 8);
+		uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(src), vget_high_u8(alpha)), 8);
+
+		vst1q_u8(out, vqaddq_u8(dst, vandq_u8(vcombine_u8(lo, hi), colorMask)));
+	}
+
+	return j;
+}
+
+static inline uint8x8_t subtractiveAmount(uint8x8_t src, uint8x8_t dst, uint8x8_t alpha) {
+	uint16x8_t color = vmull_u8(src, dst);
+	uint16x8_t alpha16 = vmovl_u8(alpha);
+	uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(color), vget_low_u16(alpha16)), 16);
+	uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(color), vget_high_u16(alpha16)), 16);
+	return vmovn_u16(vcombine_u16(lo, hi));
+}
+
+static uint32 blitSubtractiveBlendSIMD(const byte *in, byte *out, uint32 width) {
+	const uint8x16_t colorMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFFFFFF00));
+	uint32 j = 0;
+
+	for (; j + 4 <= width; j += 4, in += 16, out += 16) {
+		uint8x16_t src = vld1q_u8(in);
+		uint8x16_t dst = vld1q_u8(out);
+		uint8x16_t alpha = broadcastAlpha(src);
+
+		uint8x8_t lo = subtractiveAmount(vget_low_u8(src), vget_low_u8(dst), vget_low_u8(alpha));
+		uint8x8_t hi = subtractiveAmount(vget_high_u8(src), vget_high_u8(dst), vget_high_u8(alpha));
+
+		vst1q_u8(out, vqsubq_u8(dst, vandq_u8(vcombine_u8(lo, hi), colorMask)));
+	}
+
+	return j;
+}
+
+#endif
+
+#define USE_BLIT_SIMD
+
+#endif
+
 /**
  * Optimized version of doBlit to be used w/opaque blitting (no alpha).
  */
@@ -114,7 +379,15 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#ifdef USE_BLIT_SIMD
+		if (inStep == 4) {
+			j = blitBinarySIMD(in, out, width);
+			in += j * 4;
+			out += j * 4;
+		}
+#endif
+		for (; j < width; j++) {
 			uint32 pix = *(uint32 *)in;
 			int a = in[kAIndex];
 
@@ -150,7 +423,15 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#ifdef USE_BLIT_SIMD
+			if (inStep == 4) {
+				j = blitAlphaBlendSIMD(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kAIndex] = 255;
@@ -175,7 +456,15 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#ifdef USE_BLIT_SIMD
+			if (inStep == 4) {
+				j = blitAlphaBlendSIMD(in, out, width, ca, cr, cg, cb);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 				out[kAIndex] = 255;
@@ -208,7 +497,15 @@ void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#ifdef USE_BLIT_SIMD
+			if (inStep == 4) {
+				j = blitAdditiveBlendSIMD(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
@@ -275,7 +572,15 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#ifdef USE_BLIT_SIMD
+			if (inStep == 4) {
+				j = blitSubtractiveBlendSIMD(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
@@ -544,204 +849,235 @@ systems.
 
 
 
-TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform) const {
-
-	assert(transform._angle != 0); // This would not be ideal; rotoscale() should never be called in conditional branches where angle = 0 anyway.
-
-	Common::Point newHotspot;
-	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
-	Common::Rect rect = TransformTools::newRect(Common::Rect(srcRect), transform, &newHotspot);
-	Common::Rect dstRect(0, 0, (int16)(rect.right - rect.left), (int16)(rect.bottom - rect.top));
+// NB: The actual order of these bytes may not be correct, but since all
+// values are treated equal, that does not matter.
+struct tColorRGBA { byte r; byte g; byte b; byte a; };
 
-	TransparentSurface *target = new TransparentSurface();
-	assert(format.bytesPerPixel == 4);
+enum {
+	// The fewest destination pixels worth handing to another thread
+	kMinBandPixels = 16384
+};
 
-	int srcW = w;
-	int srcH = h;
-	int dstW = dstRect.width();
-	int dstH = dstRect.height();
-
-	target->create((uint16)dstW, (uint16)dstH, this->format);
-
-	if (transform._zoom.x == 0 || transform._zoom.y == 0) {
-		return target;
+/**
+ * A band of destination rows of a transformation, run on a thread of the
+ * pool passed to rotoscale() or scale().
+ */
+template<class Params>
+class TransformBandJob : public Common::ThreadJob {
+public:
+	typedef void (*RowsProc)(const Params &params, int yStart, int yEnd);
+
+	TransformBandJob() : _proc(0), _params(0), _yStart(0), _yEnd(0) {}
+
+	void set(RowsProc proc, const Params *params, int yStart, int yEnd) {
+		_proc = proc;
+		_params = params;
+		_yStart = yStart;
+		_yEnd = yEnd;
 	}
 
-	uint32 invAngle = 360 - (transform._angle % 360);
-	float invCos = cos(invAngle * M_PI / 180.0);
-	float invSin = sin(invAngle * M_PI / 180.0);
-
-	struct tColorRGBA { byte r; byte g; byte b; byte a; };
-	int icosx = (int)(invCos * (65536.0f * kDefaultZoomX / transform._zoom.x));
-	int isinx = (int)(invSin * (65536.0f * kDefaultZoomX / transform._zoom.x));
-	int icosy = (int)(invCos * (65536.0f * kDefaultZoomY / transform._zoom.y));
-	int isiny = (int)(invSin * (65536.0f * kDefaultZoomY / transform._zoom.y));
+	virtual void run() { _proc(*_params, _yStart, _yEnd); }
 
+private:
+	RowsProc _proc;
+	const Params *_params;
+	int _yStart;
+	int _yEnd;
+};
 
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
-
-	int xd = (srcRect.left + transform._hotspot.x) << 16;
-	int yd = (srcRect.top + transform._hotspot.y) << 16;
-	int cx = newHotspot.x;
-	int cy = newHotspot.y;
+/**
+ * Transform all rows of the target, split into bands over the threads of
+ * the pool. The rows of every transformation only depend on their own
+ * position, so the bands can be computed in any order. The first band is
+ * computed on the calling thread meanwhile.
+ */
+template<class Params>
+static void transformRows(Common::ThreadPool *pool, void (*proc)(const Params &, int, int), const Params &params, int dstW, int dstH) {
+	int numBands = 1;
+	if (pool && pool->getThreadCount() > 0)
+		numBands = CLIP<int>(dstW * dstH / kMinBandPixels, 1, MIN<int>(pool->getThreadCount() + 1, dstH));
+
+	if (numBands == 1) {
+		proc(params, 0, dstH);
+		return;
+	}
 
-	int ax = -icosx * cx;
-	int ay = -isiny * cx;
-	int sw = srcW - 1;
-	int sh = srcH - 1;
+	TransformBandJob<Params> *jobs = new TransformBandJob<Params>[numBands - 1];
+	for (int i = 1; i < numBands; i++) {
+		jobs[i - 1].set(proc, &params, dstH * i / numBands, dstH * (i + 1) / numBands);
+		pool->addJob(&jobs[i - 1]);
+	}
 
-	tColorRGBA *pc = (tColorRGBA*)target->getBasePtr(0, 0);
+	proc(params, 0, dstH / numBands);
+	pool->wait();
+	delete[] jobs;
+}
 
-	for (int y = 0; y < dstH; y++) {
-		int t = cy - y;
-		int sdx = ax + (isinx * t) + xd;
-		int sdy = ay - (icosy * t) + yd;
+struct RotoscaleParams {
+	const TransparentSurface *src;
+	TransparentSurface *dst;
+	bool filtering;
+	bool flipx, flipy;
+	int icosx, isinx, icosy, isiny;
+	int xd, yd, cy, ax, ay;
+};
+
+static void rotoscaleRows(const RotoscaleParams &p, int yStart, int yEnd) {
+	const int srcW = p.src->w;
+	const int srcH = p.src->h;
+	const int sw = srcW - 1;
+	const int sh = srcH - 1;
+	const int dstW = p.dst->w;
+
+	for (int y = yStart; y < yEnd; y++) {
+		tColorRGBA *pc = (tColorRGBA *)p.dst->getBasePtr(0, y);
+		int t = p.cy - y;
+		int sdx = p.ax + (p.isinx * t) + p.xd;
+		int sdy = p.ay - (p.icosy * t) + p.yd;
 		for (int x = 0; x < dstW; x++) {
 			int dx = (sdx >> 16);
 			int dy = (sdy >> 16);
-			if (flipx) {
+			if (p.flipx) {
 				dx = sw - dx;
 			}
-			if (flipy) {
+			if (p.flipy) {
 				dy = sh - dy;
 			}
 
-#ifdef ENABLE_BILINEAR
-			if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				tColorRGBA c00, c01, c10, c11, cswap;
-				c00 = *sp;
-				sp += 1;
-				c01 = *sp;
-				sp += (this->pitch / 4);
-				c11 = *sp;
-				sp -= 1;
-				c10 = *sp;
-				if (flipx) {
-					cswap = c00; c00=c01; c01=cswap;
-					cswap = c10; c10=c11; c11=cswap;
+			if (p.filtering) {
+				if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
+					const tColorRGBA *sp = (const tColorRGBA *)p.src->getBasePtr(dx, dy);
+					tColorRGBA c00, c01, c10, c11, cswap;
+					c00 = *sp;
+					sp += 1;
+					c01 = *sp;
+					sp += (p.src->pitch / 4);
+					c11 = *sp;
+					sp -= 1;
+					c10 = *sp;
+					if (p.flipx) {
+						cswap = c00; c00=c01; c01=cswap;
+						cswap = c10; c10=c11; c11=cswap;
+					}
+					if (p.flipy) {
+						cswap = c00; c00=c10; c10=cswap;
+						cswap = c01; c01=c11; c11=cswap;
+					}
+					/*
+					* Interpolate colors
+					*/
+					int ex = (sdx & 0xffff);
+					int ey = (sdy & 0xffff);
+					int t1, t2;
+					t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
+					t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
+					pc->r = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
+					t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
+					pc->g = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
+					t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
+					pc->b = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
+					t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
+					pc->a = (((t2 - t1) * ey) >> 16) + t1;
 				}
-				if (flipy) {
-					cswap = c00; c00=c10; c10=cswap;
-					cswap = c01; c01=c11; c11=cswap;
+			} else {
+				if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
+					const tColorRGBA *sp = (const tColorRGBA *)p.src->getBasePtr(dx, dy);
+					*pc = *sp;
 				}
-				/*
-				* Interpolate colors
-				*/
-				int ex = (sdx & 0xffff);
-				int ey = (sdy & 0xffff);
-				int t1, t2;
-				t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-				t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-				pc->r = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-				t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-				pc->g = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-				t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-				pc->b = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-				t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-				pc->a = (((t2 - t1) * ey) >> 16) + t1;
-			}
-#else
-			if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				*pc = *sp;
 			}
-#endif
-			sdx += icosx;
-			sdy += isiny;
+			sdx += p.icosx;
+			sdy += p.isiny;
 			pc++;
 		}
 	}
-	return target;
 }
 
-TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight) const {
+TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform, bool filtering, Common::ThreadPool *pool) const {
+
+	assert(transform._angle != 0); // This would not be ideal; rotoscale() should never be called in conditional branches where angle = 0 anyway.
 
+	Common::Point newHotspot;
 	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
-	Common::Rect dstRect(0, 0, (int16)newWidth, (int16)newHeight);
+	Common::Rect rect = TransformTools::newRect(Common::Rect(srcRect), transform, &newHotspot);
+	Common::Rect dstRect(0, 0, (int16)(rect.right - rect.left), (int16)(rect.bottom - rect.top));
 
 	TransparentSurface *target = new TransparentSurface();
-
 	assert(format.bytesPerPixel == 4);
 
-	int srcW = srcRect.width();
-	int srcH = srcRect.height();
 	int dstW = dstRect.width();
 	int dstH = dstRect.height();
 
 	target->create((uint16)dstW, (uint16)dstH, this->format);
 
-#ifdef ENABLE_BILINEAR
-
-	// NB: The actual order of these bytes may not be correct, but
-	// since all values are treated equal, that does not matter.
-	struct tColorRGBA { byte r; byte g; byte b; byte a; };
-
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
-
-
-	int *sax = new int[dstW + 1];
-	int *say = new int[dstH + 1];
-	assert(sax && say);
-
-	/*
-	* Precalculate row increments
-	*/
-	int spixelw = (srcW - 1);
-	int spixelh = (srcH - 1);
-	int sx = (int) (65536.0f * (float) spixelw / (float) (dstW - 1));
-	int sy = (int) (65536.0f * (float) spixelh / (float) (dstH - 1));
-
-	/* Maximum scaled source size */
-	int ssx = (srcW << 16) - 1;
-	int ssy = (srcH << 16) - 1;
-
-	/* Precalculate horizontal row increments */
-	int csx = 0;
-	int *csax = sax;
-	for (int x = 0; x <= dstW; x++) {
-		*csax = csx;
-		csax++;
-		csx += sx;
-
-		/* Guard from overflows */
-		if (csx > ssx) {
-			csx = ssx;
-		}
+	if (transform._zoom.x == 0 || transform._zoom.y == 0) {
+		return target;
 	}
 
-	/* Precalculate vertical row increments */
-	int csy = 0;
-	int *csay = say;
-	for (int y = 0; y <= dstH; y++) {
-		*csay = csy;
-		csay++;
-		csy += sy;
-
-		/* Guard from overflows */
-		if (csy > ssy) {
-			csy = ssy;
-		}
-	}
+	uint32 invAngle = 360 - (transform._angle % 360);
+	float invCos = cos(invAngle * M_PI / 180.0);
+	float invSin = sin(invAngle * M_PI / 180.0);
 
-	const tColorRGBA *sp = (const tColorRGBA *) getBasePtr(0, 0);
-	tColorRGBA *dp = (tColorRGBA *) target->getBasePtr(0, 0);
-	int spixelgap = srcW;
+	RotoscaleParams params;
+	params.src = this;
+	params.dst = target;
+	params.filtering = filtering;
+	params.flipx = false; // TODO: See mirroring comment in RenderTicket ctor
+	params.flipy = false;
+
+	params.icosx = (int)(invCos * (65536.0f * kDefaultZoomX / transform._zoom.x));
+	params.isinx = (int)(invSin * (65536.0f * kDefaultZoomX / transform._zoom.x));
+	params.icosy = (int)(invCos * (65536.0f * kDefaultZoomY / transform._zoom.y));
+	params.isiny = (int)(invSin * (65536.0f * kDefaultZoomY / transform._zoom.y));
+
+	params.xd = (srcRect.left + transform._hotspot.x) << 16;
+	params.yd = (srcRect.top + transform._hotspot.y) << 16;
+	params.cy = newHotspot.y;
+	params.ax = -params.icosx * newHotspot.x;
+	params.ay = -params.isiny * newHotspot.x;
+
+	transformRows(pool, rotoscaleRows, params, dstW, dstH);
+	return target;
+}
 
-	if (flipx) {
-		sp += spixelw;
+struct ScaleParams {
+	const TransparentSurface *src;
+	TransparentSurface *dst;
+	bool flipx, flipy;
+	/** The fixed point source position of every destination column and row, plus one */
+	const int *sax;
+	const int *say;
+};
+
+static void scaleBilinearRows(const ScaleParams &p, int yStart, int yEnd) {
+	const int spixelw = p.src->w - 1;
+	const int spixelh = p.src->h - 1;
+	const int spixelgap = p.src->pitch / 4;
+	const int dstW = p.dst->w;
+
+	const tColorRGBA *sp0 = (const tColorRGBA *) p.src->getBasePtr(0, 0);
+	if (p.flipx) {
+		sp0 += spixelw;
 	}
-	if (flipy) {
-		sp += spixelgap * spixelh;
+	if (p.flipy) {
+		sp0 += spixelgap * spixelh;
 	}
 
-	csay = say;
-	for (int y = 0; y < dstH; y++) {
-		const tColorRGBA *csp = sp;
-		csax = sax;
+	const int *csay = p.say + yStart;
+	for (int y = yStart; y < yEnd; y++) {
+		// The source row, which the original loop reached by adding up
+		// the steps between the rows above
+		const tColorRGBA *sp = sp0;
+		if (p.flipy) {
+			sp -= (*csay >> 16) * spixelgap;
+		} else {
+			sp += (*csay >> 16) * spixelgap;
+		}
+
+		tColorRGBA *dp = (tColorRGBA *) p.dst->getBasePtr(0, y);
+		const int *csax = p.sax;
 		for (int x = 0; x < dstW; x++) {
 			/*
 			* Setup color source pointers
@@ -756,7 +1092,7 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 			c01 = sp;
 			c10 = sp;
 			if (cy < spixelh) {
-				if (flipy) {
+				if (p.flipy) {
 					c10 -= spixelgap;
 				} else {
 					c10 += spixelgap;
@@ -764,7 +1100,7 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 			}
 			c11 = c10;
 			if (cx < spixelw) {
-				if (flipx) {
+				if (p.flipx) {
 					c01--;
 					c11--;
 				} else {
@@ -793,10 +1129,10 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 			/*
 			* Advance source pointer x
 			*/
-			int *salastx = csax;
+			const int *salastx = csax;
 			csax++;
 			int sstepx = (*csax >> 16) - (*salastx >> 16);
-			if (flipx) {
+			if (p.flipx) {
 				sp -= sstepx;
 			} else {
 				sp += sstepx;
@@ -807,40 +1143,109 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 			*/
 			dp++;
 		}
-		/*
-		* Advance source pointer y
-		*/
-		int *salasty = csay;
 		csay++;
-		int sstepy = (*csay >> 16) - (*salasty >> 16);
-		sstepy *= spixelgap;
-		if (flipy) {
-			sp = csp - sstepy;
-		} else {
-			sp = csp + sstepy;
+	}
+}
+
+static void scaleNearestRows(const ScaleParams &p, int yStart, int yEnd) {
+	const int srcH = p.src->h;
+	const int dstW = p.dst->w;
+	const int dstH = p.dst->h;
+
+	for (int y = yStart; y < yEnd; y++) {
+		uint32 *destP = (uint32 *)p.dst->getBasePtr(0, y);
+		const uint32 *srcP = (const uint32 *)p.src->getBasePtr(0, (y * srcH) / dstH);
+		for (int x = 0; x < dstW; x++) {
+			*destP++ = srcP[p.sax[x]];
 		}
 	}
+}
 
-	delete[] sax;
-	delete[] say;
+TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight, bool filtering, Common::ThreadPool *pool) const {
 
-#else
+	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
+	Common::Rect dstRect(0, 0, (int16)newWidth, (int16)newHeight);
 
-	int *scaleCacheX = new int[dstW];
-	for (int x = 0; x < dstW; x++) {
-		scaleCacheX[x] = (x * srcW) / dstW;
-	}
+	TransparentSurface *target = new TransparentSurface();
+
+	assert(format.bytesPerPixel == 4);
+
+	int srcW = srcRect.width();
+	int srcH = srcRect.height();
+	int dstW = dstRect.width();
+	int dstH = dstRect.height();
+
+	target->create((uint16)dstW, (uint16)dstH, this->format);
+
+	ScaleParams params;
+	params.src = this;
+	params.dst = target;
+	params.flipx = false; // TODO: See mirroring comment in RenderTicket ctor
+	params.flipy = false;
+
+	if (filtering) {
+		int *sax = new int[dstW + 1];
+		int *say = new int[dstH + 1];
+		assert(sax && say);
+
+		/*
+		* Precalculate row increments
+		*/
+		int spixelw = (srcW - 1);
+		int spixelh = (srcH - 1);
+		int sx = (int) (65536.0f * (float) spixelw / (float) MAX(dstW - 1, 1));
+		int sy = (int) (65536.0f * (float) spixelh / (float) MAX(dstH - 1, 1));
+
+		/* Maximum scaled source size */
+		int ssx = (srcW << 16) - 1;
+		int ssy = (srcH << 16) - 1;
+
+		/* Precalculate horizontal row increments */
+		int csx = 0;
+		int *csax = sax;
+		for (int x = 0; x <= dstW; x++) {
+			*csax = csx;
+			csax++;
+			csx += sx;
+
+			/* Guard from overflows */
+			if (csx > ssx) {
+				csx = ssx;
+			}
+		}
+
+		/* Precalculate vertical row increments */
+		int csy = 0;
+		int *csay = say;
+		for (int y = 0; y <= dstH; y++) {
+			*csay = csy;
+			csay++;
+			csy += sy;
+
+			/* Guard from overflows */
+			if (csy > ssy) {
+				csy = ssy;
+			}
+		}
 
-	for (int y = 0; y < dstH; y++) {
-		uint32 *destP = (uint32 *)target->getBasePtr(0, y);
-		const uint32 *srcP = (const uint32 *)getBasePtr(0, (y * srcH) / dstH);
+		params.sax = sax;
+		params.say = say;
+		transformRows(pool, scaleBilinearRows, params, dstW, dstH);
+
+		delete[] sax;
+		delete[] say;
+	} else {
+		int *scaleCacheX = new int[dstW];
 		for (int x = 0; x < dstW; x++) {
-			*destP++ = srcP[scaleCacheX[x]];
+			scaleCacheX[x] = (x * srcW) / dstW;
 		}
-	}
-	delete[] scaleCacheX;
 
-#endif
+		params.sax = scaleCacheX;
+		params.say = 0;
+		transformRows(pool, scaleNearestRows, params, dstW, dstH);
+
+		delete[] scaleCacheX;
+	}
 
 	return target;
 
@@ -43,6 +43,10 @@
 #define TS_ARGB(A,R,G,B)    (((R) << 24) | ((G) << 16) | ((B) << 8) | (A))
 #endif
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace Graphics {
 
 // Enums
@@ -131,18 +135,22 @@ struct TransparentSurface : public Graphics::Surface {
 	 *
 	 * @param newWidth the resulting width.
 	 * @param newHeight the resulting height.
+	 * @param filtering whether to use bilinear filtering instead of nearest neighbour sampling.
+	 * @param pool a thread pool to split large surfaces into bands over, or 0 to use only the calling thread.
 	 * @see TransformStruct
 	 */
-	TransparentSurface *scale(uint16 newWidth, uint16 newHeight) const;
+	TransparentSurface *scale(uint16 newWidth, uint16 newHeight, bool filtering = false, Common::ThreadPool *pool = 0) const;
 
 	/**
 	 * @brief Rotoscale function; this returns a transformed version of this surface after rotation and
 	 * scaling. Please do not use this if angle == 0, use plain old scaling function.
 	 *
 	 * @param transform a TransformStruct wrapping the required info. @see TransformStruct
+	 * @param filtering whether to use bilinear filtering instead of nearest neighbour sampling.
+	 * @param pool a thread pool to split large surfaces into bands over, or 0 to use only the calling thread.
 	 *
 	 */
-	TransparentSurface *rotoscale(const TransformStruct &transform) const;
+	TransparentSurface *rotoscale(const TransformStruct &transform, bool filtering = false, Common::ThreadPool *pool = 0) const;
 	AlphaType getAlphaMode() const;
 	void setAlphaMode(AlphaType);
 private:
@@ -86,6 +86,16 @@
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+// SSE2 is always available on x86-64 and NEON is always available on
+// AArch64; on other CPUs, the compiler has to be told to use them.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_YUV_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define USE_YUV_NEON
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -159,6 +169,7 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_useSIMD = true;
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -192,6 +203,301 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#if defined(USE_YUV_SSE2) || defined(USE_YUV_NEON)
+
+// The SIMD versions work on rows of pixels. Each chroma sample is first turned
+// into the offsets the lookup tables would add to the luminance for each of the
+// components, which keeps the results identical to the lookup table versions.
+//
+// The offsets are relative to the start of each component's lookup table:
+//   r = clamp(y + rOff), g = clamp(y + gOff), b = clamp(y + bOff)
+// For kScaleITU, clamping is to [16, 235] and the result is scaled afterwards.
+
+static inline void getYUVOffsets(const int16 *colorTab, byte u, byte v, int16 &rOff, int16 &gOff, int16 &bOff) {
+	rOff = colorTab[v] - (0 * 768 + 256);
+	gOff = colorTab[256 + v] + colorTab[512 + u] - (1 * 768 + 256);
+	bOff = colorTab[768 + u] - (2 * 768 + 256);
+}
+
+/**
+ * Convert a single pixel from its offsets with the lookup tables. Used for the
+ * pixels left over at the end of a row.
+ */
+template<typename PixelInt>
+static inline void putYUVPixel(PixelInt *dst, const uint32 *rgbToPix, byte y, int16 rOff, int16 gOff, int16 bOff) {
+	const uint32 *L = &rgbToPix[y];
+	*dst = (PixelInt)(L[rOff + 0 * 768 + 256] | L[gOff + 1 * 768 + 256] | L[bOff + 2 * 768 + 256]);
+}
+
+// For kScaleITU, (x - 16) * 255 / 219 is computed as ((x - 16) * 9539) >> 13,
+// which gives the same result for all x in [16, 235].
+#define YUV_ITU_MULTIPLIER 9539
+#define YUV_ITU_SHIFT      13
+
+#endif
+
+#ifdef USE_YUV_SSE2
+
+struct YUVPixelPacker {
+	YUVPixelPacker(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+		rLoss = _mm_cvtsi32_si128(format.rLoss);
+		gLoss = _mm_cvtsi32_si128(format.gLoss);
+		bLoss = _mm_cvtsi32_si128(format.bLoss);
+		rShift = _mm_cvtsi32_si128(format.rShift);
+		gShift = _mm_cvtsi32_si128(format.gShift);
+		bShift = _mm_cvtsi32_si128(format.bShift);
+		alpha16 = _mm_set1_epi16((int16)((0xFF >> format.aLoss) << format.aShift));
+		alpha32 = _mm_set1_epi32((int32)((0xFF >> format.aLoss) << format.aShift));
+		itu = (scale == YUVToRGBManager::kScaleITU);
+	}
+
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+	__m128i alpha16, alpha32;
+	bool itu;
+};
+
+static inline __m128i clampYUVComponent(__m128i value, bool itu) {
+	if (!itu)
+		return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+	value = _mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+	value = _mm_slli_epi16(_mm_sub_epi16(value, _mm_set1_epi16(16)), 16 - YUV_ITU_SHIFT);
+	return _mm_mulhi_epu16(value, _mm_set1_epi16(YUV_ITU_MULTIPLIER));
+}
+
+static inline __m128i loadYUVOffsets(const int16 *src, int xShift) {
+	if (xShift == 0)
+		return _mm_loadu_si128((const __m128i *)src);
+
+	// Each offset is used for two horizontal pixels
+	__m128i offsets = _mm_loadl_epi64((const __m128i *)src);
+	return _mm_unpacklo_epi16(offsets, offsets);
+}
+
+static inline void storeYUVPixels(uint16 *dst, const YUVPixelPacker &packer, __m128i r, __m128i g, __m128i b) {
+	__m128i pixels = packer.alpha16;
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(r, packer.rLoss), packer.rShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(g, packer.gLoss), packer.gShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(b, packer.bLoss), packer.bShift));
+	_mm_storeu_si128((__m128i *)dst, pixels);
+}
+
+static inline __m128i packYUVPixels32(const YUVPixelPacker &packer, __m128i r, __m128i g, __m128i b) {
+	__m128i pixels = packer.alpha32;
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(r, packer.rLoss), packer.rShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(g, packer.gLoss), packer.gShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(b, packer.bLoss), packer.bShift));
+	return pixels;
+}
+
+static inline void storeYUVPixels(uint32 *dst, const YUVPixelPacker &packer, __m128i r, __m128i g, __m128i b) {
+	__m128i zero = _mm_setzero_si128();
+	_mm_storeu_si128((__m128i *)dst, packYUVPixels32(packer, _mm_unpacklo_epi16(r, zero), _mm_unpacklo_epi16(g, zero), _mm_unpacklo_epi16(b, zero)));
+	_mm_storeu_si128((__m128i *)(dst + 4), packYUVPixels32(packer, _mm_unpackhi_epi16(r, zero), _mm_unpackhi_epi16(g, zero), _mm_unpackhi_epi16(b, zero)));
+}
+
+/**
+ * Convert a row of pixels, where each set of offsets is used for
+ * (1 << xShift) pixels.
+ */
+template<typename PixelInt, int xShift>
+static void convertYUVRow(PixelInt *dst, const YUVPixelPacker &packer, const uint32 *rgbToPix, const byte *ySrc, const int16 *rOff, const int16 *gOff, const int16 *bOff, int width) {
+	__m128i zero = _mm_setzero_si128();
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		__m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+		__m128i r = clampYUVComponent(_mm_add_epi16(y, loadYUVOffsets(rOff + (x >> xShift), xShift)), packer.itu);
+		__m128i g = clampYUVComponent(_mm_add_epi16(y, loadYUVOffsets(gOff + (x >> xShift), xShift)), packer.itu);
+		__m128i b = clampYUVComponent(_mm_add_epi16(y, loadYUVOffsets(bOff + (x >> xShift), xShift)), packer.itu);
+		storeYUVPixels(dst + x, packer, r, g, b);
+	}
+
+	for (; x < width; x++)
+		putYUVPixel<PixelInt>(dst + x, rgbToPix, ySrc[x], rOff[x >> xShift], gOff[x >> xShift], bOff[x >> xShift]);
+}
+
+#endif // USE_YUV_SSE2
+
+#ifdef USE_YUV_NEON
+
+struct YUVPixelPacker {
+	YUVPixelPacker(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+		// NEON shifts right by shifting left by a negative amount
+		rLoss = -format.rLoss;
+		gLoss = -format.gLoss;
+		bLoss = -format.bLoss;
+		rShift = format.rShift;
+		gShift = format.gShift;
+		bShift = format.bShift;
+		alpha = (0xFF >> format.aLoss) << format.aShift;
+		itu = (scale == YUVToRGBManager::kScaleITU);
+	}
+
+	int rLoss, gLoss, bLoss;
+	int rShift, gShift, bShift;
+	uint32 alpha;
+	bool itu;
+};
+
+static inline uint16x8_t clampYUVComponent(int16x8_t value, bool itu) {
+	if (!itu)
+		return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255)));
+
+	uint16x8_t clamped = vreinterpretq_u16_s16(vsubq_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(16)), vdupq_n_s16(235)), vdupq_n_s16(16)));
+	uint16x4_t low = vshrn_n_u32(vmull_u16(vget_low_u16(clamped), vdup_n_u16(YUV_ITU_MULTIPLIER)), YUV_ITU_SHIFT);
+	uint16x4_t high = vshrn_n_u32(vmull_u16(vget_high_u16(clamped), vdup_n_u16(YUV_ITU_MULTIPLIER)), YUV_ITU_SHIFT);
+	return vcombine_u16(low, high);
+}
+
+static inline int16x8_t loadYUVOffsets(const int16 *src, int xShift) {
+	if (xShift == 0)
+		return vld1q_s16(src);
+
+	// Each offset is used for two horizontal pixels
+	int16x4x2_t offsets = vzip_s16(vld1_s16(src), vld1_s16(src));
+	return vcombine_s16(offsets.val[0], offsets.val[1]);
+}
+
+static inline void storeYUVPixels(uint16 *dst, const YUVPixelPacker &packer, uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+	uint16x8_t pixels = vdupq_n_u16((uint16)packer.alpha);
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(r, vdupq_n_s16(packer.rLoss)), vdupq_n_s16(packer.rShift)));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(g, vdupq_n_s16(packer.gLoss)), vdupq_n_s16(packer.gShift)));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(b, vdupq_n_s16(packer.bLoss)), vdupq_n_s16(packer.bShift)));
+	vst1q_u16(dst, pixels);
+}
+
+static inline uint32x4_t packYUVPixels32(const YUVPixelPacker &packer, uint32x4_t r, uint32x4_t g, uint32x4_t b) {
+	uint32x4_t pixels = vdupq_n_u32(packer.alpha);
+	pixels = vorrq_u32(pixels, vshlq_u32(vshlq_u32(r, vdupq_n_s32(packer.rLoss)), vdupq_n_s32(packer.rShift)));
+	pixels = vorrq_u32(pixels, vshlq_u32(vshlq_u32(g, vdupq_n_s32(packer.gLoss)), vdupq_n_s32(packer.gShift)));
+	pixels = vorrq_u32(pixels, vshlq_u32(vshlq_u32(b, vdupq_n_s32(packer.bLoss)), vdupq_n_s32(packer.bShift)));
+	return pixels;
+}
+
+static inline void storeYUVPixels(uint32 *dst, const YUVPixelPacker &packer, uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+	vst1q_u32(dst, packYUVPixels32(packer, vmovl_u16(vget_low_u16(r)), vmovl_u16(vget_low_u16(g)), vmovl_u16(vget_low_u16(b))));
+	vst1q_u32(dst + 4, packYUVPixels32(packer, vmovl_u16(vget_high_u16(r)), vmovl_u16(vget_high_u16(g)), vmovl_u16(vget_high_u16(b))));
+}
+
+/**
+ * Convert a row of pixels, where each set of offsets is used for
+ * (1 << xShift) pixels.
+ */
+template<typename PixelInt, int xShift>
+static void convertYUVRow(PixelInt *dst, const YUVPixelPacker &packer, const uint32 *rgbToPix, const byte *ySrc, const int16 *rOff, const int16 *gOff, const int16 *bOff, int width) {
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + x)));
+		uint16x8_t r = clampYUVComponent(vaddq_s16(y, loadYUVOffsets(rOff + (x >> xShift), xShift)), packer.itu);
+		uint16x8_t g = clampYUVComponent(vaddq_s16(y, loadYUVOffsets(gOff + (x >> xShift), xShift)), packer.itu);
+		uint16x8_t b = clampYUVComponent(vaddq_s16(y, loadYUVOffsets(bOff + (x >> xShift), xShift)), packer.itu);
+		storeYUVPixels(dst + x, packer, r, g, b);
+	}
+
+	for (; x < width; x++)
+		putYUVPixel<PixelInt>(dst + x, rgbToPix, ySrc[x], rOff[x >> xShift], gOff[x >> xShift], bOff[x >> xShift]);
+}
+
+#endif // USE_YUV_NEON
+
+#if defined(USE_YUV_SSE2) || defined(USE_YUV_NEON)
+
+template<typename PixelInt>
+void convertYUV444ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, YUVToRGBManager::LuminanceScale scale, const int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	YUVPixelPacker packer(lookup->getFormat(), scale);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+
+	int16 *offsets = new int16[yWidth * 3];
+	int16 *rOff = offsets;
+	int16 *gOff = offsets + yWidth;
+	int16 *bOff = offsets + yWidth * 2;
+
+	for (int h = 0; h < yHeight; h++) {
+		for (int w = 0; w < yWidth; w++)
+			getYUVOffsets(colorTab, uSrc[w], vSrc[w], rOff[w], gOff[w], bOff[w]);
+
+		convertYUVRow<PixelInt, 0>((PixelInt *)dstPtr, packer, rgbToPix, ySrc, rOff, gOff, bOff, yWidth);
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	delete[] offsets;
+}
+
+template<typename PixelInt>
+void convertYUV420ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, YUVToRGBManager::LuminanceScale scale, const int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	YUVPixelPacker packer(lookup->getFormat(), scale);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+	int halfWidth = yWidth >> 1;
+
+	int16 *offsets = new int16[halfWidth * 3];
+	int16 *rOff = offsets;
+	int16 *gOff = offsets + halfWidth;
+	int16 *bOff = offsets + halfWidth * 2;
+
+	for (int h = 0; h < (yHeight >> 1); h++) {
+		for (int w = 0; w < halfWidth; w++)
+			getYUVOffsets(colorTab, uSrc[w], vSrc[w], rOff[w], gOff[w], bOff[w]);
+
+		// Both rows share the chroma samples
+		convertYUVRow<PixelInt, 1>((PixelInt *)dstPtr, packer, rgbToPix, ySrc, rOff, gOff, bOff, yWidth);
+		convertYUVRow<PixelInt, 1>((PixelInt *)(dstPtr + dstPitch), packer, rgbToPix, ySrc + yPitch, rOff, gOff, bOff, yWidth);
+
+		dstPtr += dstPitch << 1;
+		ySrc += yPitch << 1;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	delete[] offsets;
+}
+
+template<typename PixelInt>
+void convertYUV410ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, YUVToRGBManager::LuminanceScale scale, const int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	YUVPixelPacker packer(lookup->getFormat(), scale);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+
+	int16 *offsets = new int16[yWidth * 3];
+	int16 *rOff = offsets;
+	int16 *gOff = offsets + yWidth;
+	int16 *bOff = offsets + yWidth * 2;
+
+	for (int y = 0; y < yHeight; y++) {
+		// Perform the same bilinear interpolation on the chroma values
+		// as convertYUV410ToRGB()
+		int yDiff = y & 3;
+		const byte *uRow = uSrc + (y >> 2) * uvPitch;
+		const byte *vRow = vSrc + (y >> 2) * uvPitch;
+
+		for (int x = 0; x < yWidth; x++) {
+			int index = x >> 2;
+			int xDiff = x & 3;
+
+			byte u = (uRow[index] * (4 - xDiff) * (4 - yDiff) + uRow[index + 1] * xDiff * (4 - yDiff) +
+					uRow[index + uvPitch] * yDiff * (4 - xDiff) + uRow[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+			byte v = (vRow[index] * (4 - xDiff) * (4 - yDiff) + vRow[index + 1] * xDiff * (4 - yDiff) +
+					vRow[index + uvPitch] * yDiff * (4 - xDiff) + vRow[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+
+			getYUVOffsets(colorTab, u, v, rOff[x], gOff[x], bOff[x]);
+		}
+
+		convertYUVRow<PixelInt, 0>((PixelInt *)dstPtr, packer, rgbToPix, ySrc, rOff, gOff, bOff, yWidth);
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+
+	delete[] offsets;
+}
+
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -235,6 +541,17 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(USE_YUV_SSE2) || defined(USE_YUV_NEON)
+	if (_useSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV444ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV444ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -291,6 +608,17 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(USE_YUV_SSE2) || defined(USE_YUV_NEON)
+	if (_useSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV420ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV420ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -376,6 +704,17 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(USE_YUV_SSE2) || defined(USE_YUV_NEON)
+	if (_useSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV410ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV410ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, scale, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -105,6 +105,13 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Set whether the SSE2/NEON conversion functions should be used, if
+	 * they were compiled in. They are used by default and produce the same
+	 * results as the lookup table versions, which remain the reference.
+	 */
+	void setUseSIMD(bool useSIMD) { _useSIMD = useSIMD; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -114,6 +121,7 @@ private:
 
 	YUVToRGBLookup *_lookup;
 	int16 _colorTab[4 * 256]; // 2048 bytes
+	bool _useSIMD;
 };
 
 } // End of namespace Graphics
@@ -0,0 +1,508 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "gui/ThemeCache.h"
+#include "gui/ThemeEval.h"
+#include "gui/ThemeParser.h"
+
+#include "graphics/VectorRenderer.h"
+
+#include "base/version.h"
+
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace GUI {
+
+/**
+ * The version of the compiled theme format. This has to be increased
+ * whenever the format changes, or the ThemeParser sets up the engine in
+ * a different way.
+ */
+static const uint32 kThemeCacheVersion = 2;
+
+enum ThemeCacheCall {
+	kCallAddDrawData,
+	kCallAddDrawStep,
+	kCallAddTextData,
+	kCallAddFont,
+	kCallAddTextColor,
+	kCallAddBitmap,
+	kCallCreateCursor,
+	kCallSetVar,
+	kCallAddDialog,
+	kCallAddLayout,
+	kCallAddWidget,
+	kCallAddImportedLayout,
+	kCallAddSpace,
+	kCallAddPadding,
+	kCallCloseLayout,
+	kCallCloseDialog
+};
+
+static Common::String readString(Common::ReadStream &in) {
+	uint size = in.readUint16LE();
+
+	Common::String str;
+	char buffer[256];
+	while (size > 0 && !in.eos()) {
+		const uint length = MIN<uint>(size, sizeof(buffer));
+		in.read(buffer, length);
+		str += Common::String(buffer, length);
+		size -= length;
+	}
+	return str;
+}
+
+static void writeColor(Common::WriteStream &out, const Graphics::DrawStep::Color &color) {
+	out.writeByte(color.r);
+	out.writeByte(color.g);
+	out.writeByte(color.b);
+	out.writeByte(color.set);
+}
+
+static void readColor(Common::ReadStream &in, Graphics::DrawStep::Color &color) {
+	color.r = in.readByte();
+	color.g = in.readByte();
+	color.b = in.readByte();
+	color.set = in.readByte() != 0;
+}
+
+ThemeCache::ThemeCache(const Common::String &themeId, const Common::String &hash)
+	: _hash(hash), _calls(DisposeAfterUse::YES) {
+	// Ports which keep the config file in the current directory have no
+	// place for the cache, then nothing is cached
+	const Common::FSNode configFile(g_system->getDefaultConfigFileName());
+	_dir = configFile.getParent();
+	if (_dir.getPath() == configFile.getPath())
+		_dir = Common::FSNode();
+
+	_fileName = Common::String::format("themecache-%s-%dx%d.bin", themeId.c_str(),
+	                                   g_system->getOverlayWidth(), g_system->getOverlayHeight());
+}
+
+bool ThemeCache::load() {
+	if (!_dir.isDirectory())
+		return false;
+
+	Common::FSNode file = _dir.getChild(_fileName);
+	if (!file.exists())
+		return false;
+
+	Common::SeekableReadStream *in = file.createReadStream();
+	if (!in)
+		return false;
+
+	// The ThemeParser may change between builds without a new version of
+	// the format, so a cache is only used by the build which wrote it
+	bool valid = (in->readUint32BE() == MKTAG('T','H','M','C') && in->readUint32BE() == kThemeCacheVersion &&
+	              readString(*in) == Cabal::getFullVersion() && readString(*in) == _hash);
+
+	const uint32 size = in->readUint32LE();
+	uint8 digest[16];
+	in->read(digest, sizeof(digest));
+	valid = valid && !in->err() && !in->eos() && size <= (uint32)(in->size() - in->pos());
+
+	if (valid) {
+		byte *data = (byte *)malloc(size);
+		valid = (data && in->read(data, size) == size);
+
+		// The calls are replayed without checking them any further, so the
+		// whole file has to be intact
+		uint8 dataDigest[16];
+		if (valid) {
+			Common::MemoryReadStream dataStream(data, size);
+			valid = Common::computeStreamMD5(dataStream, dataDigest) && !memcmp(digest, dataDigest, sizeof(digest));
+		}
+
+		if (valid)
+			_calls.write(data, size);
+		free(data);
+	}
+
+	delete in;
+	return valid;
+}
+
+void ThemeCache::save() {
+	if (!_dir.isDirectory() || !_dir.isWritable())
+		return;
+
+	// Written uncompressed, so that loading it is as fast as possible
+	Common::WriteStream *out = _dir.getChild(_fileName).createWriteStream();
+	if (!out)
+		return;
+
+	const uint32 size = _calls.size();
+	uint8 digest[16];
+	Common::MemoryReadStream dataStream(_calls.getData(), size);
+	Common::computeStreamMD5(dataStream, digest);
+
+	out->writeUint32BE(MKTAG('T','H','M','C'));
+	out->writeUint32BE(kThemeCacheVersion);
+	const Common::String version = Cabal::getFullVersion();
+	out->writeUint16LE(version.size());
+	out->writeString(version);
+	out->writeUint16LE(_hash.size());
+	out->writeString(_hash);
+	out->writeUint32LE(size);
+	out->write(digest, sizeof(digest));
+	out->write(_calls.getData(), size);
+
+	out->finalize();
+	if (out->err())
+		warning("ThemeCache::save: Failed to write '%s'", _fileName.c_str());
+
+	delete out;
+}
+
+bool ThemeCache::apply(ThemeEngine *engine) {
+	ThemeEval *eval = engine->getEvaluator();
+	Common::MemoryReadStream in(_calls.getData(), _calls.size());
+
+	while (in.pos() < in.size()) {
+		switch (in.readByte()) {
+		case kCallAddDrawData: {
+			const Common::String data = readString(in);
+			const bool cached = in.readByte() != 0;
+			if (!engine->addDrawData(data, cached))
+				return false;
+			break;
+		}
+
+		case kCallAddDrawStep: {
+			const Common::String drawDataId = readString(in);
+
+			Graphics::DrawStep step = Graphics::DrawStep();
+
+			readColor(in, step.fgColor);
+			readColor(in, step.bgColor);
+			readColor(in, step.gradColor1);
+			readColor(in, step.gradColor2);
+			readColor(in, step.bevelColor);
+
+			step.autoWidth = in.readByte() != 0;
+			step.autoHeight = in.readByte() != 0;
+			step.x = in.readSint16LE();
+			step.y = in.readSint16LE();
+			step.w = in.readSint16LE();
+			step.h = in.readSint16LE();
+
+			step.padding.left = in.readSint16LE();
+			step.padding.top = in.readSint16LE();
+			step.padding.right = in.readSint16LE();
+			step.padding.bottom = in.readSint16LE();
+
+			step.xAlign = (Graphics::DrawStep::VectorAlignment)in.readByte();
+			step.yAlign = (Graphics::DrawStep::VectorAlignment)in.readByte();
+
+			step.shadow = in.readByte();
+			step.stroke = in.readByte();
+			step.factor = in.readByte();
+			step.radius = in.readByte();
+			step.bevel = in.readByte();
+			step.fillMode = in.readByte();
+			step.shadowFillMode = in.readByte();
+			step.extraData = in.readUint32LE();
+			step.scale = in.readUint32LE();
+
+			step.drawingCall = ThemeParser::getDrawingFunctionCallback(readString(in));
+			if (!step.drawingCall)
+				return false;
+
+			const Common::String bitmap = readString(in);
+			if (!bitmap.empty()) {
+				step.blitSrc = engine->getBitmap(bitmap);
+				if (!step.blitSrc)
+					return false;
+			}
+
+			engine->addDrawStep(drawDataId, step);
+			break;
+		}
+
+		case kCallAddTextData: {
+			const Common::String drawDataId = readString(in);
+			const TextData textId = (TextData)in.readSint16LE();
+			const TextColor colorId = (TextColor)in.readSint16LE();
+			const Graphics::TextAlign alignH = (Graphics::TextAlign)in.readByte();
+			const ThemeEngine::TextAlignVertical alignV = (ThemeEngine::TextAlignVertical)in.readByte();
+			if (!engine->addTextData(drawDataId, textId, colorId, alignH, alignV))
+				return false;
+			break;
+		}
+
+		case kCallAddFont: {
+			const TextData textId = (TextData)in.readSint16LE();
+			const Common::String file = readString(in);
+			const Common::String scalableFile = readString(in);
+			const int pointsize = in.readSint32LE();
+			if (!engine->addFont(textId, file, scalableFile, pointsize))
+				return false;
+			break;
+		}
+
+		case kCallAddTextColor: {
+			const TextColor colorId = (TextColor)in.readSint16LE();
+			const int r = in.readByte();
+			const int g = in.readByte();
+			const int b = in.readByte();
+			if (!engine->addTextColor(colorId, r, g, b))
+				return false;
+			break;
+		}
+
+		case kCallAddBitmap:
+			if (!engine->addBitmap(readString(in)))
+				return false;
+			break;
+
+		case kCallCreateCursor: {
+			const Common::String filename = readString(in);
+			const int hotspotX = in.readSint32LE();
+			const int hotspotY = in.readSint32LE();
+			if (!engine->createCursor(filename, hotspotX, hotspotY))
+				return false;
+			break;
+		}
+
+		case kCallSetVar: {
+			const Common::String name = readString(in);
+			eval->setVar(name, in.readSint32LE());
+			break;
+		}
+
+		case kCallAddDialog: {
+			const Common::String name = readString(in);
+			const Common::String overlays = readString(in);
+			const bool enabled = in.readByte() != 0;
+			const int inset = in.readSint32LE();
+			eval->addDialog(name, overlays, enabled, inset);
+			break;
+		}
+
+		case kCallAddLayout: {
+			const ThemeLayout::LayoutType type = (ThemeLayout::LayoutType)in.readByte();
+			const int spacing = in.readSint32LE();
+			const bool center = in.readByte() != 0;
+			eval->addLayout(type, spacing, center);
+			break;
+		}
+
+		case kCallAddWidget: {
+			const Common::String name = readString(in);
+			const int w = in.readSint32LE();
+			const int h = in.readSint32LE();
+			const Common::String type = readString(in);
+			const bool enabled = in.readByte() != 0;
+			const Graphics::TextAlign align = (Graphics::TextAlign)in.readByte();
+			eval->addWidget(name, w, h, type, enabled, align);
+			break;
+		}
+
+		case kCallAddImportedLayout:
+			if (!eval->addImportedLayout(readString(in)))
+				return false;
+			break;
+
+		case kCallAddSpace:
+			eval->addSpace(in.readSint32LE());
+			break;
+
+		case kCallAddPadding: {
+			const int16 l = in.readSint16LE();
+			const int16 r = in.readSint16LE();
+			const int16 t = in.readSint16LE();
+			const int16 b = in.readSint16LE();
+			eval->addPadding(l, r, t, b);
+			break;
+		}
+
+		case kCallCloseLayout:
+			eval->closeLayout();
+			break;
+
+		case kCallCloseDialog:
+			eval->closeDialog();
+			break;
+
+		default:
+			return false;
+		}
+
+		if (in.eos())
+			return false;
+	}
+
+	return true;
+}
+
+void ThemeCache::writeString(const Common::String &str) {
+	_calls.writeUint16LE(str.size());
+	_calls.writeString(str);
+}
+
+void ThemeCache::addDrawData(const Common::String &data, bool cached) {
+	_calls.writeByte(kCallAddDrawData);
+	writeString(data);
+	_calls.writeByte(cached);
+}
+
+void ThemeCache::addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step,
+                             const Common::String &function, const Common::String &bitmap) {
+	_calls.writeByte(kCallAddDrawStep);
+	writeString(drawDataId);
+
+	writeColor(_calls, step.fgColor);
+	writeColor(_calls, step.bgColor);
+	writeColor(_calls, step.gradColor1);
+	writeColor(_calls, step.gradColor2);
+	writeColor(_calls, step.bevelColor);
+
+	_calls.writeByte(step.autoWidth);
+	_calls.writeByte(step.autoHeight);
+	_calls.writeSint16LE(step.x);
+	_calls.writeSint16LE(step.y);
+	_calls.writeSint16LE(step.w);
+	_calls.writeSint16LE(step.h);
+
+	_calls.writeSint16LE(step.padding.left);
+	_calls.writeSint16LE(step.padding.top);
+	_calls.writeSint16LE(step.padding.right);
+	_calls.writeSint16LE(step.padding.bottom);
+
+	_calls.writeByte(step.xAlign);
+	_calls.writeByte(step.yAlign);
+
+	_calls.writeByte(step.shadow);
+	_calls.writeByte(step.stroke);
+	_calls.writeByte(step.factor);
+	_calls.writeByte(step.radius);
+	_calls.writeByte(step.bevel);
+	_calls.writeByte(step.fillMode);
+	_calls.writeByte(step.shadowFillMode);
+	_calls.writeUint32LE(step.extraData);
+	_calls.writeUint32LE(step.scale);
+
+	// Pointers are stored by the names they were looked up with
+	writeString(function);
+	writeString(bitmap);
+}
+
+void ThemeCache::addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId,
+                             Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV) {
+	_calls.writeByte(kCallAddTextData);
+	writeString(drawDataId);
+	_calls.writeSint16LE(textId);
+	_calls.writeSint16LE(colorId);
+	_calls.writeByte(alignH);
+	_calls.writeByte(alignV);
+}
+
+void ThemeCache::addFont(TextData textId, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	_calls.writeByte(kCallAddFont);
+	_calls.writeSint16LE(textId);
+	writeString(file);
+	writeString(scalableFile);
+	_calls.writeSint32LE(pointsize);
+}
+
+void ThemeCache::addTextColor(TextColor colorId, int r, int g, int b) {
+	_calls.writeByte(kCallAddTextColor);
+	_calls.writeSint16LE(colorId);
+	_calls.writeByte(r);
+	_calls.writeByte(g);
+	_calls.writeByte(b);
+}
+
+void ThemeCache::addBitmap(const Common::String &filename) {
+	_calls.writeByte(kCallAddBitmap);
+	writeString(filename);
+}
+
+void ThemeCache::createCursor(const Common::String &filename, int hotspotX, int hotspotY) {
+	_calls.writeByte(kCallCreateCursor);
+	writeString(filename);
+	_calls.writeSint32LE(hotspotX);
+	_calls.writeSint32LE(hotspotY);
+}
+
+void ThemeCache::setVar(const Common::String &name, int val) {
+	_calls.writeByte(kCallSetVar);
+	writeString(name);
+	_calls.writeSint32LE(val);
+}
+
+void ThemeCache::addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset) {
+	_calls.writeByte(kCallAddDialog);
+	writeString(name);
+	writeString(overlays);
+	_calls.writeByte(enabled);
+	_calls.writeSint32LE(inset);
+}
+
+void ThemeCache::addLayout(ThemeLayout::LayoutType type, int spacing, bool center) {
+	_calls.writeByte(kCallAddLayout);
+	_calls.writeByte(type);
+	_calls.writeSint32LE(spacing);
+	_calls.writeByte(center);
+}
+
+void ThemeCache::addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align) {
+	_calls.writeByte(kCallAddWidget);
+	writeString(name);
+	_calls.writeSint32LE(w);
+	_calls.writeSint32LE(h);
+	writeString(type);
+	_calls.writeByte(enabled);
+	_calls.writeByte(align);
+}
+
+void ThemeCache::addImportedLayout(const Common::String &name) {
+	_calls.writeByte(kCallAddImportedLayout);
+	writeString(name);
+}
+
+void ThemeCache::addSpace(int size) {
+	_calls.writeByte(kCallAddSpace);
+	_calls.writeSint32LE(size);
+}
+
+void ThemeCache::addPadding(int16 l, int16 r, int16 t, int16 b) {
+	_calls.writeByte(kCallAddPadding);
+	_calls.writeSint16LE(l);
+	_calls.writeSint16LE(r);
+	_calls.writeSint16LE(t);
+	_calls.writeSint16LE(b);
+}
+
+void ThemeCache::closeLayout() {
+	_calls.writeByte(kCallCloseLayout);
+}
+
+void ThemeCache::closeDialog() {
+	_calls.writeByte(kCallCloseDialog);
+}
+
+} // End of namespace GUI
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GUI_THEME_CACHE_H
+#define GUI_THEME_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "gui/ThemeEngine.h"
+#include "gui/ThemeLayout.h"
+
+namespace GUI {
+
+/**
+ * A theme compiled into a binary form, which can be loaded without parsing
+ * the XML of the theme again.
+ *
+ * While the ThemeParser parses a theme, it records every call it makes to
+ * set up the ThemeEngine and its ThemeEval, with all values already parsed.
+ * Replaying these calls sets up the engine in the same way. Fonts and
+ * bitmaps are only referenced by their file names, and loaded again.
+ *
+ * Compiled themes are kept next to the config file, as they do not belong
+ * to any game. The parser checks resolutions and computes sizes from the
+ * overlay size, so there is one file for every theme and overlay size. It
+ * is only used by the build which wrote it, and while the hash of the XML
+ * sources stays the same.
+ */
+class ThemeCache {
+public:
+	/**
+	 * @param themeId The id of the theme.
+	 * @param hash    The hash of the XML sources of the theme.
+	 */
+	ThemeCache(const Common::String &themeId, const Common::String &hash);
+
+	/**
+	 * Load the compiled theme from the config directory.
+	 *
+	 * @return false if there is no compiled theme for the current overlay
+	 *         size, or if it was compiled by another build or from
+	 *         different sources.
+	 */
+	bool load();
+
+	/** Write the recorded calls to the config directory. */
+	void save();
+
+	/**
+	 * Replay the recorded calls on the given theme engine.
+	 *
+	 * @return false if one of the calls failed.
+	 */
+	bool apply(ThemeEngine *engine);
+
+	/** @name Recording of the ThemeEngine calls */
+	//@{
+	void addDrawData(const Common::String &data, bool cached);
+	void addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step,
+	                 const Common::String &function, const Common::String &bitmap);
+	void addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId,
+	                 Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV);
+	void addFont(TextData textId, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void addTextColor(TextColor colorId, int r, int g, int b);
+	void addBitmap(const Common::String &filename);
+	void createCursor(const Common::String &filename, int hotspotX, int hotspotY);
+	//@}
+
+	/** @name Recording of the ThemeEval calls */
+	//@{
+	void setVar(const Common::String &name, int val);
+	void addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset);
+	void addLayout(ThemeLayout::LayoutType type, int spacing, bool center);
+	void addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align);
+	void addImportedLayout(const Common::String &name);
+	void addSpace(int size);
+	void addPadding(int16 l, int16 r, int16 t, int16 b);
+	void closeLayout();
+	void closeDialog();
+	//@}
+
+private:
+	/** The directory of the config file, or an invalid node if there is none */
+	Common::FSNode _dir;
+	Common::String _fileName;
+	const Common::String _hash;
+
+	/** The recorded calls */
+	Common::MemoryWriteStreamDynamic _calls;
+
+	void writeString(const Common::String &str);
+};
+
+} // End of namespace GUI
+
+#endif
@@ -26,6 +26,8 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -40,6 +42,7 @@
 #include "image/bmp.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -86,6 +89,10 @@ struct WidgetDrawData {
 
 	bool _buffer;
 
+	/** Whether drawing this widget only depends on its steps, so that the
+	    result can be cached */
+	bool _cacheable;
+
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -95,6 +102,14 @@ struct WidgetDrawData {
 	 * value will be added when restoring the background of the widget.
 	 */
 	void calcBackgroundOffset();
+
+	/**
+	 * Checks whether the result of drawing a DrawData item can be cached.
+	 * This needs its DrawSteps to stay within the area of the widget, and
+	 * to set all the colors they use. Otherwise they draw with the colors
+	 * left in the renderer by whatever was drawn before.
+	 */
+	void calcCacheable();
 };
 
 class ThemeItem {
@@ -235,11 +250,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawWidgetData(_data, _area, extendedRect, _dynamicData);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -277,6 +289,7 @@ void ThemeItemBitmap::drawSelf(bool draw, bool restore) {
  *********************************************************/
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(0), _vectorRenderer(0),
+	_clearedScreenValid(false), _overlayCopyValid(false), _widgetCachePixels(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
 	_font(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
 	_cursor(0) {
@@ -322,8 +335,11 @@ ThemeEngine::~ThemeEngine() {
 	_vectorRenderer = 0;
 	_screen.free();
 	_backBuffer.free();
+	_clearedScreen.free();
+	_overlayCopy.free();
 
 	unloadTheme();
+	clearWidgetCache();
 
 	// Release all graphics surfaces
 	for (ImagesMap::iterator i = _bitmaps.begin(); i != _bitmaps.end(); ++i) {
@@ -442,8 +458,22 @@ bool ThemeEngine::init() {
 
 void ThemeEngine::clearAll() {
 	if (_initOk) {
-		_system->clearOverlay();
-		_system->grabOverlay(_screen.getPixels(), _screen.pitch);
+		// Clearing the overlay shows the game screen, which does not change
+		// while the GUI is enabled. So it is only cleared the first time,
+		// and the overlay keeps showing the dialogs until they are redrawn.
+		// The whole screen is marked dirty, but only the parts which
+		// actually changed are copied to the overlay.
+		if (!_clearedScreenValid) {
+			_system->clearOverlay();
+			_system->grabOverlay(_clearedScreen.getPixels(), _clearedScreen.pitch);
+			_clearedScreenValid = true;
+
+			_overlayCopy.copyRectToSurface(_clearedScreen, 0, 0, Common::Rect(_screen.w, _screen.h));
+			_overlayCopyValid = true;
+		}
+
+		_screen.copyRectToSurface(_clearedScreen, 0, 0, Common::Rect(_screen.w, _screen.h));
+		addDirtyRect(Common::Rect(0, 0, _screen.w, _screen.h));
 	}
 }
 
@@ -480,6 +510,8 @@ void ThemeEngine::enable() {
 	showCursor();
 
 	_system->showOverlay();
+	_clearedScreenValid = false;
+	_overlayCopyValid = false;
 	clearAll();
 	_enabled = true;
 }
@@ -489,6 +521,8 @@ void ThemeEngine::disable() {
 		return;
 
 	_system->hideOverlay();
+	_clearedScreenValid = false;
+	_overlayCopyValid = false;
 
 	hideCursor();
 
@@ -522,6 +556,17 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_screen.free();
 	_screen.create(width, height, _overlayFormat);
 
+	_clearedScreen.free();
+	_clearedScreen.create(width, height, _overlayFormat);
+	_clearedScreenValid = false;
+
+	_overlayCopy.free();
+	_overlayCopy.create(width, height, _overlayFormat);
+	_overlayCopyValid = false;
+
+	// The cached widgets were drawn by the old renderer, in the old format
+	clearWidgetCache();
+
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
@@ -547,6 +592,51 @@ void WidgetDrawData::calcBackgroundOffset() {
 	_backgroundOffset = maxShadow;
 }
 
+void WidgetDrawData::calcCacheable() {
+	bool fgSet = false, bgSet = false, bevelSet = false, gradientSet = false;
+
+	_cacheable = true;
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		fgSet |= step->fgColor.set;
+		bgSet |= step->bgColor.set;
+		bevelSet |= step->bevelColor.set;
+		gradientSet |= (step->gradColor1.set && step->gradColor2.set);
+
+		// Only the area of the widget, grown by _backgroundOffset, is cached.
+		// Steps which are placed manually may be drawn outside of it, and
+		// tabs draw their base line along the whole tab bar.
+		if (!step->autoWidth || !step->autoHeight ||
+		        step->drawingCall == &Graphics::VectorRenderer::drawCallback_TAB) {
+			_cacheable = false;
+			return;
+		}
+
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_VOID ||
+		        step->drawingCall == &Graphics::VectorRenderer::drawCallback_BITMAP)
+			continue;
+
+		// Filled shapes without a border are the only ones which do not
+		// use the foreground color
+		bool usesFg = true;
+		if (step->stroke == 0 &&
+		        (step->fillMode == Graphics::VectorRenderer::kFillGradient || step->fillMode == Graphics::VectorRenderer::kFillDisabled) &&
+		        (step->drawingCall == &Graphics::VectorRenderer::drawCallback_SQUARE ||
+		         step->drawingCall == &Graphics::VectorRenderer::drawCallback_ROUNDSQ ||
+		         step->drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE))
+			usesFg = false;
+
+		const bool usesBg = (step->fillMode == Graphics::VectorRenderer::kFillBackground);
+		const bool usesBevel = (step->bevel > 0 || step->drawingCall == &Graphics::VectorRenderer::drawCallback_BEVELSQ);
+		const bool usesGradient = (step->fillMode == Graphics::VectorRenderer::kFillGradient);
+
+		if ((usesFg && !fgSet) || (usesBg && !bgSet) || (usesBevel && !bevelSet) || (usesGradient && !gradientSet)) {
+			_cacheable = false;
+			return;
+		}
+	}
+}
+
 void ThemeEngine::restoreBackground(Common::Rect r) {
 	r.clip(_screen.w, _screen.h);
 	_vectorRenderer->blitSurface(&_backBuffer, r);
@@ -554,6 +644,102 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
 
 
 
+/**********************************************************
+ * Widget cache
+ *********************************************************/
+uint ThemeEngine::WidgetCacheKeyHash::operator()(const WidgetCacheKey &key) const {
+	uint hash = (uint)(size_t)key.data;
+	hash = hash * 31 + key.area.left;
+	hash = hash * 31 + key.area.top;
+	hash = hash * 31 + key.area.right;
+	hash = hash * 31 + key.area.bottom;
+	hash = hash * 31 + key.dynamicData;
+	return hash * 2 + (key.shadows ? 1 : 0);
+}
+
+/**
+ * Checks if an area of a surface has the same pixels as a copy of it, which
+ * is stored at the top left of another surface.
+ */
+static bool equalsCopy(const Graphics::Surface &surface, const Common::Rect &area, const Graphics::Surface &copy) {
+	const int width = area.width() * surface.format.bytesPerPixel;
+
+	for (int y = 0; y < area.height(); y++) {
+		if (memcmp(surface.getBasePtr(area.left, area.top + y), copy.getBasePtr(0, y), width))
+			return false;
+	}
+
+	return true;
+}
+
+void ThemeEngine::drawWidgetData(const WidgetDrawData *data, const Common::Rect &area, Common::Rect extendedArea, uint32 dynamicData) {
+	Graphics::Surface *surface = _vectorRenderer->getActiveSurface();
+	extendedArea.clip(surface->w, surface->h);
+
+	const uint pixels = extendedArea.width() * extendedArea.height();
+	const uint screenPixels = _screen.w * _screen.h;
+	WidgetCacheEntry *entry = 0;
+
+	// Big items like dialog backgrounds are drawn rarely, and caching them
+	// would push everything else out of the cache
+	if (data->_cacheable && pixels > 0 && pixels <= screenPixels / 4) {
+		WidgetCacheKey key;
+		key.data = data;
+		key.area = extendedArea;
+		key.dynamicData = dynamicData;
+		key.shadows = _vectorRenderer->shadowsEnabled();
+
+		WidgetCache::iterator i = _widgetCache.find(key);
+		if (i != _widgetCache.end()) {
+			entry = i->_value;
+
+			if (equalsCopy(*surface, extendedArea, entry->before)) {
+				surface->copyRectToSurface(entry->after, extendedArea.left, extendedArea.top,
+				                           Common::Rect(extendedArea.width(), extendedArea.height()));
+
+				// Anything drawn afterwards may depend on the colors set by
+				// the steps
+				Common::List<Graphics::DrawStep>::const_iterator step;
+				for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+					_vectorRenderer->applyStepState(*step, dynamicData);
+				return;
+			}
+		} else {
+			if (_widgetCachePixels + 2 * pixels > 2 * screenPixels)
+				clearWidgetCache();
+
+			entry = new WidgetCacheEntry;
+			entry->before.create(extendedArea.width(), extendedArea.height(), surface->format);
+			entry->after.create(extendedArea.width(), extendedArea.height(), surface->format);
+			_widgetCache[key] = entry;
+			_widgetCachePixels += 2 * pixels;
+		}
+	}
+
+	if (entry)
+		entry->before.copyRectToSurface(*surface, 0, 0, extendedArea);
+
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+		_vectorRenderer->drawStep(area, *step, dynamicData);
+
+	if (entry)
+		entry->after.copyRectToSurface(*surface, 0, 0, extendedArea);
+}
+
+void ThemeEngine::clearWidgetCache() {
+	for (WidgetCache::iterator i = _widgetCache.begin(); i != _widgetCache.end(); ++i) {
+		i->_value->before.free();
+		i->_value->after.free();
+		delete i->_value;
+	}
+
+	_widgetCache.clear();
+	_widgetCachePixels = 0;
+}
+
+
+
 /**********************************************************
  * Theme elements management
  *********************************************************/
@@ -676,6 +862,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 
 	_widgets[id] = new WidgetDrawData;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
+	_widgets[id]->_cacheable = false;
 	_widgets[id]->_textDataId = kTextDataNone;
 
 	return true;
@@ -707,6 +894,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheable();
 		}
 	}
 }
@@ -715,6 +903,9 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	// The cache is keyed by the DrawData items, which are deleted now
+	clearWidgetCache();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -753,21 +944,33 @@ bool ThemeEngine::loadDefaultXML() {
 	for (int i = 0; i < ARRAYSIZE(defaultXML); i++)
 		strncat((char *)tmpXML, defaultXML[i], xmllen);
 
+	_themeName = "ScummVM Classic Theme (Builtin Version)";
+	_themeId = "builtin";
+	_themeFile.clear();
+
+	Common::MemoryReadStream xmlStream(tmpXML, xmllen);
+	ThemeCache cache(_themeId, Common::computeStreamMD5AsString(xmlStream));
+	if (cache.load()) {
+		free(tmpXML);
+		return applyThemeCache(cache);
+	}
+
 	if (!_parser->loadBuffer(tmpXML, xmllen)) {
 		free(tmpXML);
 
 		return false;
 	}
 
-	_themeName = "ScummVM Classic Theme (Builtin Version)";
-	_themeId = "builtin";
-	_themeFile.clear();
-
+	_parser->setCache(&cache);
 	bool result = _parser->parse();
+	_parser->setCache(0);
 	_parser->close();
 
 	free(tmpXML);
 
+	if (result)
+		cache.save();
+
 	return result;
 #else
 	warning("The built-in theme is not enabled in the current build. Please load an external theme");
@@ -804,31 +1007,66 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		return false;
 	}
 
+	//
+	// Hash the STX files, and use the compiled theme if they did not change
+	//
+	Common::String sourceHashes;
+	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (!stream)
+			continue;
+
+		sourceHashes += (*i)->getName() + ':' + Common::computeStreamMD5AsString(*stream) + ';';
+		delete stream;
+	}
+
+	Common::MemoryReadStream hashStream((const byte *)sourceHashes.c_str(), sourceHashes.size());
+	ThemeCache cache(_themeId, Common::computeStreamMD5AsString(hashStream));
+	if (cache.load())
+		return applyThemeCache(cache);
+
 	//
 	// Loop over all STX files, load and parse them
 	//
+	_parser->setCache(&cache);
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
 		if (_parser->loadStream((*i)->createReadStream()) == false) {
 			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
+			_parser->setCache(0);
 			_parser->close();
 			return false;
 		}
 
 		if (_parser->parse() == false) {
 			warning("Failed to parse STX file '%s'", (*i)->getDisplayName().c_str());
+			_parser->setCache(0);
 			_parser->close();
 			return false;
 		}
 
 		_parser->close();
 	}
+	_parser->setCache(0);
+
+	cache.save();
 
 	assert(!_themeName.empty());
 	return true;
 }
 
+bool ThemeEngine::applyThemeCache(ThemeCache &cache) {
+	debug(6, "Loading compiled theme %s", _themeId.c_str());
+
+	if (!cache.apply(this)) {
+		warning("Failed to load the compiled theme '%s'", _themeId.c_str());
+		return false;
+	}
+
+	return true;
+}
+
 
 
 /**********************************************************
@@ -1299,12 +1537,66 @@ void ThemeEngine::renderDirtyScreen() {
 
 	Common::List<Common::Rect>::iterator i;
 	for (i = _dirtyScreen.begin(); i != _dirtyScreen.end(); ++i) {
-		_vectorRenderer->copyFrame(_system, *i);
+		copyChangesToOverlay(*i);
 	}
 
 	_dirtyScreen.clear();
 }
 
+void ThemeEngine::copyChangesToOverlay(const Common::Rect &r) {
+	if (!_overlayCopyValid) {
+		_vectorRenderer->copyFrame(_system, r);
+		_overlayCopy.copyRectToSurface(_screen, r.left, r.top, r);
+		return;
+	}
+
+	// Unchanged rows between two changed ones are copied along, unless
+	// there are enough of them to make copying two areas worthwhile
+	const int maxGap = 8;
+	const int bytesPerPixel = _screen.format.bytesPerPixel;
+	const int width = r.width() * bytesPerPixel;
+
+	int top = -1, bottom = -1;
+	int left = width, right = 0;
+
+	for (int y = r.top; y <= r.bottom; y++) {
+		bool changed = false;
+		if (y < r.bottom) {
+			const byte *screen = (const byte *)_screen.getBasePtr(r.left, y);
+			const byte *copy = (const byte *)_overlayCopy.getBasePtr(r.left, y);
+			changed = memcmp(screen, copy, width) != 0;
+
+			if (changed) {
+				int first = 0;
+				while (screen[first] == copy[first])
+					first++;
+				int last = width - 1;
+				while (screen[last] == copy[last])
+					last--;
+
+				left = MIN(left, first / bytesPerPixel);
+				right = MAX(right, last / bytesPerPixel + 1);
+
+				if (top == -1)
+					top = y;
+				bottom = y + 1;
+			}
+		}
+
+		// Copy the changed area once the end of the dirty area or a big
+		// enough gap is reached
+		if (top != -1 && !changed && (y == r.bottom || y - bottom >= maxGap)) {
+			const Common::Rect area(r.left + left, top, r.left + right, bottom);
+			_vectorRenderer->copyFrame(_system, area);
+			_overlayCopy.copyRectToSurface(_screen, area.left, area.top, area);
+
+			top = bottom = -1;
+			left = width;
+			right = 0;
+		}
+	}
+}
+
 void ThemeEngine::openDialog(bool doBuffer, ShadingStyle style) {
 	if (doBuffer)
 		_buffering = true;
@@ -1617,10 +1909,9 @@ bool ThemeEngine::themeConfigUsable(const Common::FSNode &node, Common::String &
 		}
 		// Delete the ZIP archive again. Note: This only works because
 		// stream.open() only uses ZipArchive::createReadStreamForMember,
-		// and that in turn happens to read all the data for a given
-		// archive member into a memory block. So there will be no dangling
-		// reference to zipArchive anywhere. This could change if we
-		// ever modify ZipArchive::createReadStreamForMember.
+		// and the streams created by that keep the archive file open on
+		// their own. So there will be no dangling reference to zipArchive
+		// anywhere.
 		delete zipArchive;
 	} else if (node.isDirectory()) {
 		Common::FSNode headerfile = node.getChild("THEMERC");
@@ -54,6 +54,7 @@ struct TextDrawData;
 struct TextColorData;
 class Dialog;
 class GuiObject;
+class ThemeCache;
 class ThemeEval;
 class ThemeItem;
 class ThemeParser;
@@ -143,6 +144,35 @@ class ThemeEngine {
 protected:
 	typedef Common::HashMap<Common::String, Graphics::Surface *> ImagesMap;
 
+	/** Identifies a DrawData item drawn at a given place, see _widgetCache */
+	struct WidgetCacheKey {
+		const WidgetDrawData *data;
+		Common::Rect area;
+		uint32 dynamicData;
+		bool shadows;
+	};
+
+	struct WidgetCacheKeyHash {
+		uint operator()(const WidgetCacheKey &key) const;
+	};
+
+	struct WidgetCacheKeyEqual {
+		bool operator()(const WidgetCacheKey &x, const WidgetCacheKey &y) const {
+			return x.data == y.data && x.area == y.area && x.dynamicData == y.dynamicData && x.shadows == y.shadows;
+		}
+	};
+
+	/**
+	 * The pixels of the area of a cached DrawData item, before and after it
+	 * was drawn.
+	 */
+	struct WidgetCacheEntry {
+		Graphics::Surface before;
+		Graphics::Surface after;
+	};
+
+	typedef Common::HashMap<WidgetCacheKey, WidgetCacheEntry *, WidgetCacheKeyHash, WidgetCacheKeyEqual> WidgetCache;
+
 	friend class GUI::Dialog;
 	friend class GUI::GuiObject;
 
@@ -525,6 +555,18 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws all the steps of a DrawData item on the active surface.
+	 * If the item was drawn on the same pixels before, the result is
+	 * copied from the widget cache instead.
+	 *
+	 * @param data DrawData item to draw.
+	 * @param area Area of the item.
+	 * @param extendedArea Area which drawing the item may change.
+	 * @param dynamicData Dynamic data passed to the draw steps.
+	 */
+	void drawWidgetData(const WidgetDrawData *data, const Common::Rect &area, Common::Rect extendedArea, uint32 dynamicData);
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -555,6 +597,11 @@ protected:
 	 */
 	bool loadDefaultXML();
 
+	/**
+	 * Sets up the theme from a compiled theme, instead of parsing its XML.
+	 */
+	bool applyThemeCache(ThemeCache &cache);
+
 	/**
 	 * Unloads the currently loaded theme so another one can
 	 * be loaded.
@@ -574,6 +621,18 @@ protected:
 	 */
 	void renderDirtyScreen();
 
+	/**
+	 * Copies an area of the screen to the overlay. Only the parts which
+	 * differ from what was copied to the overlay before are copied, when
+	 * that is known.
+	 */
+	void copyChangesToOverlay(const Common::Rect &r);
+
+	/**
+	 * Frees all the cached DrawData items.
+	 */
+	void clearWidgetCache();
+
 	/**
 	 * Generates a DrawQueue item and enqueues it so it's drawn to the screen
 	 * when the drawing queue is processed.
@@ -634,6 +693,23 @@ protected:
 	/** Backbuffer surface. Stores previous states of the screen to blit back */
 	Graphics::Surface _backBuffer;
 
+	/** Contents of the overlay after clearing it, see clearAll() */
+	Graphics::Surface _clearedScreen;
+	bool _clearedScreenValid;
+
+	/** Copy of the overlay, as far as the screen was copied to it */
+	Graphics::Surface _overlayCopy;
+	bool _overlayCopyValid;
+
+	/**
+	 * Results of drawing DrawData items, which can be reused as long as an
+	 * item is drawn at the same place, with the same pixels below.
+	 */
+	WidgetCache _widgetCache;
+
+	/** Number of pixels used by all the surfaces in _widgetCache */
+	uint _widgetCachePixels;
+
 	/** Sets whether the current drawing is being buffered (stored for later
 	    processing) or drawn directly to the screen. */
 	bool _buffering;
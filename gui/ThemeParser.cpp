@@ -20,6 +20,7 @@
  *
  */
 
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -106,6 +107,7 @@ ThemeParser::ThemeParser(ThemeEngine *parent) : XMLParser() {
 	_defaultStepGlobal = defaultDrawStep();
 	_defaultStepLocal = 0;
 	_theme = parent;
+	_cache = 0;
 }
 
 ThemeParser::~ThemeParser() {
@@ -186,6 +188,8 @@ bool ThemeParser::parserCallback_font(ParserNode *node) {
 	TextData textDataId = parseTextDataId(node->values["id"]);
 	if (!_theme->addFont(textDataId, node->values["file"], node->values["scalable_file"], pointsize))
 		return parserError("Error loading Font in theme engine.");
+	if (_cache)
+		_cache->addFont(textDataId, node->values["file"], node->values["scalable_file"], pointsize);
 
 	return true;
 }
@@ -204,6 +208,8 @@ bool ThemeParser::parserCallback_text_color(ParserNode *node) {
 
 	if (!_theme->addTextColor(colorId, red, green, blue))
 		return parserError("Error while adding text color information.");
+	if (_cache)
+		_cache->addTextColor(colorId, red, green, blue);
 
 	return true;
 }
@@ -225,6 +231,8 @@ bool ThemeParser::parserCallback_cursor(ParserNode *node) {
 
 	if (!_theme->createCursor(node->values["file"], spotx, spoty))
 		return parserError("Error creating Bitmap Cursor.");
+	if (_cache)
+		_cache->createCursor(node->values["file"], spotx, spoty);
 
 	return true;
 }
@@ -237,6 +245,8 @@ bool ThemeParser::parserCallback_bitmap(ParserNode *node) {
 
 	if (!_theme->addBitmap(node->values["filename"]))
 		return parserError("Error loading Bitmap file '" + node->values["filename"] + "'");
+	if (_cache)
+		_cache->addBitmap(node->values["filename"]);
 
 	return true;
 }
@@ -257,6 +267,8 @@ bool ThemeParser::parserCallback_text(ParserNode *node) {
 
 	if (!_theme->addTextData(id, textDataId, textColorId, alignH, alignV))
 		return parserError("Error adding Text Data for '" + id + "'.");
+	if (_cache)
+		_cache->addTextData(id, textDataId, textColorId, alignH, alignV);
 
 	return true;
 }
@@ -299,7 +311,7 @@ bool ThemeParser::parserCallback_color(ParserNode *node) {
 }
 
 
-static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name) {
+Graphics::DrawingFunctionCallback ThemeParser::getDrawingFunctionCallback(const Common::String &name) {
 
 	if (name == "circle")
 		return &Graphics::VectorRenderer::drawCallback_CIRCLE;
@@ -346,6 +358,8 @@ bool ThemeParser::parserCallback_drawstep(ParserNode *node) {
 	}
 
 	_theme->addDrawStep(getParentNode(node)->values["id"], *drawstep);
+	if (_cache)
+		_cache->addDrawStep(getParentNode(node)->values["id"], *drawstep, functionName, node->values["file"]);
 	delete drawstep;
 
 	return true;
@@ -366,6 +380,8 @@ bool ThemeParser::parserCallback_drawdata(ParserNode *node) {
 
 	if (_theme->addDrawData(node->values["id"], cached) == false)
 		return parserError("Error adding Draw Data set: Invalid DrawData name.");
+	if (_cache)
+		_cache->addDrawData(node->values["id"], cached);
 
 	delete _defaultStepLocal;
 	_defaultStepLocal = 0;
@@ -584,7 +600,7 @@ bool ThemeParser::parserCallback_def(ParserNode *node) {
 	else if (!parseIntegerKey(node->values["value"], 1, &value))
 		return parserError("Invalid definition for '" + var + "'.");
 
-	_theme->getEvaluator()->setVar(var, value);
+	setVar(var, value);
 	return true;
 }
 
@@ -638,6 +654,8 @@ bool ThemeParser::parserCallback_widget(ParserNode *node) {
 		}
 
 		_theme->getEvaluator()->addWidget(var, width, height, node->values["type"], enabled, alignH);
+		if (_cache)
+			_cache->addWidget(var, width, height, node->values["type"], enabled, alignH);
 	}
 
 	return true;
@@ -664,6 +682,8 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 	}
 
 	_theme->getEvaluator()->addDialog(var, node->values["overlays"], enabled, inset);
+	if (_cache)
+		_cache->addDialog(var, node->values["overlays"], enabled, inset);
 
 	if (node->values.contains("shading")) {
 		int shading = 0;
@@ -673,7 +693,7 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 			shading = 2;
 		else return parserError("Invalid value for Dialog background shading.");
 
-		_theme->getEvaluator()->setVar(var + ".Shading", shading);
+		setVar(var + ".Shading", shading);
 	}
 
 	return true;
@@ -683,6 +703,8 @@ bool ThemeParser::parserCallback_import(ParserNode *node) {
 
 	if (!_theme->getEvaluator()->addImportedLayout(node->values["layout"]))
 		return parserError("Error importing external layout");
+	if (_cache)
+		_cache->addImportedLayout(node->values["layout"]);
 	return true;
 }
 
@@ -697,13 +719,18 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 
 	(void)Common::parseBool(node->values["center"], center);
 
+	GUI::ThemeLayout::LayoutType type;
 	if (node->values["type"] == "vertical")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutVertical, spacing, center);
+		type = GUI::ThemeLayout::kLayoutVertical;
 	else if (node->values["type"] == "horizontal")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutHorizontal, spacing, center);
+		type = GUI::ThemeLayout::kLayoutHorizontal;
 	else
 		return parserError("Invalid layout type. Only 'horizontal' and 'vertical' layouts allowed.");
 
+	_theme->getEvaluator()->addLayout(type, spacing, center);
+	if (_cache)
+		_cache->addLayout(type, spacing, center);
+
 
 	if (node->values.contains("padding")) {
 		int paddingL, paddingR, paddingT, paddingB;
@@ -712,6 +739,8 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 			return false;
 
 		_theme->getEvaluator()->addPadding(paddingL, paddingR, paddingT, paddingB);
+		if (_cache)
+			_cache->addPadding(paddingL, paddingR, paddingT, paddingB);
 	}
 
 	return true;
@@ -729,14 +758,21 @@ bool ThemeParser::parserCallback_space(ParserNode *node) {
 	}
 
 	_theme->getEvaluator()->addSpace(size);
+	if (_cache)
+		_cache->addSpace(size);
 	return true;
 }
 
 bool ThemeParser::closedKeyCallback(ParserNode *node) {
-	if (node->name == "layout")
+	if (node->name == "layout") {
 		_theme->getEvaluator()->closeLayout();
-	else if (node->name == "dialog")
+		if (_cache)
+			_cache->closeLayout();
+	} else if (node->name == "dialog") {
 		_theme->getEvaluator()->closeDialog();
+		if (_cache)
+			_cache->closeDialog();
+	}
 
 	return true;
 }
@@ -783,8 +819,8 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		}
 
 
-		_theme->getEvaluator()->setVar(var + "Width", width);
-		_theme->getEvaluator()->setVar(var + "Height", height);
+		setVar(var + "Width", width);
+		setVar(var + "Height", height);
 	}
 
 	if (node->values.contains("pos")) {
@@ -839,8 +875,8 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 				return false;
 		}
 
-		_theme->getEvaluator()->setVar(var + "X", x);
-		_theme->getEvaluator()->setVar(var + "Y", y);
+		setVar(var + "X", x);
+		setVar(var + "Y", y);
 	}
 
 	if (node->values.contains("padding")) {
@@ -849,10 +885,10 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		if (!parseIntegerKey(node->values["padding"], 4, &paddingL, &paddingR, &paddingT, &paddingB))
 			return false;
 
-		_theme->getEvaluator()->setVar(var + "Padding.Left", paddingL);
-		_theme->getEvaluator()->setVar(var + "Padding.Right", paddingR);
-		_theme->getEvaluator()->setVar(var + "Padding.Top", paddingT);
-		_theme->getEvaluator()->setVar(var + "Padding.Bottom", paddingB);
+		setVar(var + "Padding.Left", paddingL);
+		setVar(var + "Padding.Right", paddingR);
+		setVar(var + "Padding.Top", paddingT);
+		setVar(var + "Padding.Bottom", paddingB);
 	}
 
 
@@ -862,11 +898,17 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		if ((alignH = parseTextHAlign(node->values["textalign"])) == Graphics::kTextAlignInvalid)
 			return parserError("Invalid value for text alignment.");
 
-		_theme->getEvaluator()->setVar(var + "Align", alignH);
+		setVar(var + "Align", alignH);
 	}
 	return true;
 }
 
+void ThemeParser::setVar(const Common::String &name, int value) {
+	_theme->getEvaluator()->setVar(name, value);
+	if (_cache)
+		_cache->setVar(name, value);
+}
+
 bool ThemeParser::resolutionCheck(const Common::String &resolution) {
 	if (resolution.empty())
 		return true;
@@ -26,8 +26,11 @@
 #include "common/scummsys.h"
 #include "common/xmlparser.h"
 
+#include "graphics/VectorRenderer.h"
+
 namespace GUI {
 
+class ThemeCache;
 class ThemeEngine;
 
 class ThemeParser : public Common::XMLParser {
@@ -47,8 +50,21 @@ public:
 		return true;
 	}
 
+	/**
+	 * Record the calls made to the theme engine while parsing into the
+	 * given compiled theme. Pass 0 to stop recording.
+	 */
+	void setCache(ThemeCache *cache) { _cache = cache; }
+
+	/**
+	 * Look up the drawing function with the given name, as used in the
+	 * "func" property of draw steps. Returns 0 for unknown names.
+	 */
+	static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name);
+
 protected:
 	ThemeEngine *_theme;
+	ThemeCache *_cache;
 
 	CUSTOM_XML_PARSER(ThemeParser) {
 		XML_KEY(render_info)
@@ -247,6 +263,7 @@ protected:
 	Graphics::DrawStep *defaultDrawStep();
 	bool parseDrawStep(ParserNode *stepNode, Graphics::DrawStep *drawstep, bool functionSpecific);
 	bool parseCommonLayoutProps(ParserNode *node, const Common::String &var);
+	void setVar(const Common::String &name, int value);
 
 	Graphics::DrawStep *_defaultStepGlobal;
 	Graphics::DrawStep *_defaultStepLocal;
@@ -20,12 +20,14 @@
  *
  */
 
+#include "engines/advancedDetector.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
 #include "common/system.h"
 #include "common/taskbar.h"
+#include "common/threadpool.h"
 #include "common/translation.h"
 
 #include "gui/launcher.h"	// For addGameToConf()
@@ -51,6 +53,12 @@ enum {
 	kMaxScanTime = 50
 };
 
+enum {
+	// Number of directories handed to each scan thread at a time. Only
+	// these have to finish when the scan is cancelled.
+	kScanJobsPerThread = 2
+};
+
 enum {
 	kOkCmd = 'OK  ',
 	kCancelCmd = 'CNCL'
@@ -58,11 +66,46 @@ enum {
 
 
 
+/**
+ * Lists a directory on one of the scan threads. The detector is run on the
+ * listing by the dialog, as it uses ConfMan, the engine plugins and the
+ * OSystem API, which the scan threads must not touch.
+ */
+class MassAddDialog::ScanJob : public Common::ThreadJob {
+public:
+	ScanJob(MassAddDialog *dialog, const Common::FSNode &d) : dir(d), done(false), _dialog(dialog) {}
+
+	virtual void run();
+
+	const Common::FSNode dir;
+	Common::FSList files;
+	Common::FSList subdirs;
+	/** Set once the job finished, guarded by MassAddDialog::_jobMutex */
+	bool done;
+
+private:
+	MassAddDialog *_dialog;
+};
+
+void MassAddDialog::ScanJob::run() {
+	if (!_dialog->_scanCancelled && dir.getChildren(files, Common::FSNode::kListAll)) {
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (file->isDirectory())
+				subdirs.push_back(*file);
+		}
+	}
+
+	Common::StackLock lock(_dialog->_jobMutex);
+	done = true;
+}
+
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_scanPool(0),
+	_scanCancelled(false),
 	_dirsScanned(0),
 	_oldGamesCount(0),
-	_dirTotal(0),
+	_dirTotal(1),
 	_okButton(0),
 	_dirProgressText(0),
 	_gameProgressText(0) {
@@ -72,6 +115,10 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	// The dir we start our scan at
 	_scanStack.push(startDir);
 
+	// Listing directories mostly waits for the disk, so use more than one
+	// thread even on single core systems
+	_scanPool = new Common::ThreadPool(MAX<uint>(g_system->getCPUCount(), 2), "MassAdd");
+
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
 
@@ -119,6 +166,10 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	stopScan();
+}
+
 struct GameTargetLess {
 	bool operator()(const GameDescriptor &x, const GameDescriptor &y) const {
 		return x.preferredtarget().compareToIgnoreCase(y.preferredtarget()) < 0;
@@ -163,7 +214,10 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave. The MD5
+		// sums computed so far are still useful for the next scan, though.
+		stopScan();
+		ADDetectionCache::instance().flush();
 		_games.clear();
 		close();
 	} else {
@@ -171,74 +225,34 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 	}
 }
 
-void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
-		return;	// We have finished scanning
-
-	uint32 t = g_system->getMillis();
+void MassAddDialog::startScanJobs() {
+	const uint maxJobs = MAX<uint>(_scanPool->getThreadCount(), 1) * kScanJobsPerThread;
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
+	while (!_scanStack.empty() && _scanJobs.size() < maxJobs) {
+		ScanJob *job = new ScanJob(this, _scanStack.pop());
+		_scanJobs.push_back(job);
+		_scanPool->addJob(job);
+	}
+}
 
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
-		}
+void MassAddDialog::finishScanJobs(uint32 startTime) {
+	Common::List<ScanJob *>::iterator iter = _scanJobs.begin();
+	while (iter != _scanJobs.end()) {
+		ScanJob *job = *iter;
 
-		// Run the detector on the dir
-		GameList candidates(EngineMan.detectGames(files));
-
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		for (GameList::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
-			GameDescriptor result = *cand;
-			Common::String path = dir.getPath();
-
-			// Remove trailing slashes
-			while (path != "/" && path.lastChar() == '/')
-				path.deleteLastChar();
-
-			// Check for existing config entries for this path/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				bool duplicate = false;
-				const StringArray &targets = _pathToTargets[path];
-				for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
-					// If the gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
-					assert(dom);
-
-					if ((*dom)["gameid"] == result["gameid"] &&
-					    (*dom)["platform"] == result["platform"] &&
-					    (*dom)["language"] == result["language"]) {
-						duplicate = true;
-						break;
-					}
-				}
-				if (duplicate) {
-					_oldGamesCount++;
-					break;	// Skip duplicates
-				}
+		{
+			Common::StackLock lock(_jobMutex);
+			if (!job->done) {
+				++iter;
+				continue;
 			}
-			result["path"] = path;
-			_games.push_back(result);
-
-			_list->append(result.description());
 		}
 
+		for (Common::FSList::const_iterator dir = job->subdirs.begin(); dir != job->subdirs.end(); ++dir)
+			_scanStack.push(*dir);
+		_dirTotal += job->subdirs.size();
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
-
-				_dirTotal++;
-			}
-		}
+		addDetectedGames(job->dir, EngineMan.detectGames(job->files, false));
 
 		_dirsScanned++;
 
@@ -246,13 +260,101 @@ void MassAddDialog::handleTickle() {
 		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
 		g_system->getTaskbarManager()->setCount(_games.size());
 #endif
+
+		delete job;
+		iter = _scanJobs.erase(iter);
+
+		// Leave the other listings for the next tickle
+		if (g_system->getMillis() - startTime >= kMaxScanTime)
+			break;
+	}
+}
+
+void MassAddDialog::stopScan() {
+	if (!_scanPool)
+		return;
+
+	// The jobs which did not start yet return right away
+	_scanCancelled = true;
+	delete _scanPool;
+	_scanPool = 0;
+
+	for (Common::List<ScanJob *>::iterator iter = _scanJobs.begin(); iter != _scanJobs.end(); ++iter)
+		delete *iter;
+	_scanJobs.clear();
+	_scanStack.clear();
+}
+
+void MassAddDialog::addDetectedGames(const Common::FSNode &dir, const GameList &candidates) {
+	// Just add all detected games / game variants. If we get more than one,
+	// that either means the directory contains multiple games, or the detector
+	// could not fully determine which game variant it was seeing. In either
+	// case, let the user choose which entries he wants to keep.
+	//
+	// However, we only add games which are not already in the config file.
+	Common::String path = dir.getPath();
+
+	// Remove trailing slashes
+	while (path != "/" && path.lastChar() == '/')
+		path.deleteLastChar();
+
+	for (GameList::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
+		GameDescriptor result = *cand;
+
+		// Check for existing config entries for this path/gameid/lang/platform combination
+		if (_pathToTargets.contains(path)) {
+			bool duplicate = false;
+			const StringArray &targets = _pathToTargets[path];
+			for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
+				// If the gameid, platform and language match -> skip it
+				Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
+				assert(dom);
+
+				if ((*dom)["gameid"] == result["gameid"] &&
+				    (*dom)["platform"] == result["platform"] &&
+				    (*dom)["language"] == result["language"]) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) {
+				_oldGamesCount++;
+				break;	// Skip duplicates
+			}
+		}
+		result["path"] = path;
+		_games.push_back(result);
+
+		_list->append(result.description());
 	}
+}
+
+void MassAddDialog::handleTickle() {
+	if (!_scanPool)
+		return;	// We have finished scanning
+
+	uint32 t = g_system->getMillis();
+
+	// Perform a depth-first scan of the filesystem. The scan threads list
+	// the directories, and the detector is run here on the listings as they
+	// come in. Without threads, poll() runs the jobs right here, until the
+	// time for this tickle is used up.
+	do {
+		startScanJobs();
+		_scanPool->poll();
+		finishScanJobs(t);
+	} while (!_scanJobs.empty() && _scanPool->getThreadCount() == 0 && (g_system->getMillis() - t) < kMaxScanTime);
 
 
 	// Update the dialog
 	Common::String buf;
 
-	if (_scanStack.empty()) {
+	if (_scanStack.empty() && _scanJobs.empty()) {
+		delete _scanPool;
+		_scanPool = 0;
+
+		ADDetectionCache::instance().flush();
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -26,9 +26,15 @@
 #include "gui/dialog.h"
 #include "common/fs.h"
 #include "common/hashmap.h"
+#include "common/list.h"
+#include "common/mutex.h"
 #include "common/stack.h"
 #include "common/str.h"
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace GUI {
 
 class StaticTextWidget;
@@ -37,6 +43,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::String> StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog();
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data);
@@ -49,9 +56,36 @@ public:
 	}
 
 private:
+	class ScanJob;
+	friend class ScanJob;
+
+	/** Hand the next directories on the stack to the scan threads. */
+	void startScanJobs();
+
+	/**
+	 * Run the detector on the directories listed by the finished scan jobs,
+	 * add the new games to the list, and queue the subdirectories found for
+	 * scanning. This stops once the time for this tickle is used up.
+	 *
+	 * @param startTime The time the current tickle started at.
+	 */
+	void finishScanJobs(uint32 startTime);
+
+	/** Cancel the scan, and wait for the scan threads to stop. */
+	void stopScan();
+
+	void addDetectedGames(const Common::FSNode &dir, const GameList &candidates);
+
 	Common::Stack<Common::FSNode>  _scanStack;
 	GameList _games;
 
+	/** The scan threads, which list the directories */
+	Common::ThreadPool *_scanPool;
+	Common::List<ScanJob *> _scanJobs;
+	/** Guards whether the scan jobs are done */
+	Common::Mutex _jobMutex;
+	volatile bool _scanCancelled;
+
 	/**
 	 * Map each path occuring in the config file to the target(s) using that path.
 	 * Used to detect whether a potential new target is already present in the
@@ -61,6 +95,7 @@ private:
 
 	int _dirsScanned;
 	int _oldGamesCount;
+	/** Number of directories found so far, including the starting directory */
 	int _dirTotal;
 
 	Widget *_okButton;
@@ -65,7 +65,7 @@ enum {
 #endif // !DISABLE_SAVELOADCHOOSER_GRID
 
 SaveLoadChooserDialog::SaveLoadChooserDialog(const Common::String &dialogName, const bool saveMode)
-	: Dialog(dialogName), _metaEngine(0), _delSupport(false), _metaInfoSupport(false),
+	: Dialog(dialogName), _metaEngine(0), _saveIndex(0), _delSupport(false), _metaInfoSupport(false),
 	_thumbnailSupport(false), _saveDateSupport(false), _playTimeSupport(false), _saveMode(saveMode)
 #ifndef DISABLE_SAVELOADCHOOSER_GRID
 	, _listButton(0), _gridButton(0)
@@ -77,7 +77,7 @@ SaveLoadChooserDialog::SaveLoadChooserDialog(const Common::String &dialogName, c
 }
 
 SaveLoadChooserDialog::SaveLoadChooserDialog(int x, int y, int w, int h, const bool saveMode)
-	: Dialog(x, y, w, h), _metaEngine(0), _delSupport(false), _metaInfoSupport(false),
+	: Dialog(x, y, w, h), _metaEngine(0), _saveIndex(0), _delSupport(false), _metaInfoSupport(false),
 	_thumbnailSupport(false), _saveDateSupport(false), _playTimeSupport(false), _saveMode(saveMode)
 #ifndef DISABLE_SAVELOADCHOOSER_GRID
 	, _listButton(0), _gridButton(0)
@@ -105,7 +105,13 @@ int SaveLoadChooserDialog::run(const Common::String &target, const MetaEngine *m
 	_saveDateSupport = _metaInfoSupport && _metaEngine->hasFeature(MetaEngine::kSavesSupportCreationDate);
 	_playTimeSupport = _metaInfoSupport && _metaEngine->hasFeature(MetaEngine::kSavesSupportPlayTime);
 
-	return runIntern();
+	// Don't open every savefile each time the dialog is shown
+	_saveIndex = new SaveStateIndex(*metaEngine, target);
+	const int result = runIntern();
+	delete _saveIndex;
+	_saveIndex = 0;
+
+	return result;
 }
 
 void SaveLoadChooserDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data) {
@@ -362,7 +368,7 @@ void SaveLoadChooserSimple::updateSelection(bool redraw) {
 	_playtime->setLabel(_("No playtime saved"));
 
 	if (selItem >= 0 && _metaInfoSupport) {
-		SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), _saveList[selItem].getSaveSlot());
+		SaveStateDescriptor desc = _saveIndex->querySaveMetaInfos(_saveList[selItem].getSaveSlot());
 
 		isDeletable = desc.getDeletableFlag() && _delSupport;
 		isWriteProtected = desc.getWriteProtectedFlag();
@@ -463,7 +469,7 @@ void SaveLoadChooserSimple::close() {
 }
 
 void SaveLoadChooserSimple::updateSaveList() {
-	_saveList = _metaEngine->listSaves(_target.c_str());
+	_saveList = _saveIndex->listSaves();
 
 	int curSlot = 0;
 	int saveSlot = 0;
@@ -622,7 +628,7 @@ void SaveLoadChooserGrid::handleMouseWheel(int x, int y, int direction) {
 void SaveLoadChooserGrid::open() {
 	SaveLoadChooserDialog::open();
 
-	_saveList = _metaEngine->listSaves(_target.c_str());
+	_saveList = _saveIndex->listSaves();
 	_resultString.clear();
 
 	// Load information to restore the last page the user had open.
@@ -655,7 +661,7 @@ void SaveLoadChooserGrid::open() {
 			// In case there was a gap found use the slot.
 			if (lastSlot + 1 < curSlot) {
 				// Check that the save slot can be used for user saves.
-				SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), lastSlot + 1);
+				SaveStateDescriptor desc = _saveIndex->querySaveMetaInfos(lastSlot + 1);
 				if (!desc.getWriteProtectedFlag()) {
 					_nextFreeSaveSlot = lastSlot + 1;
 					break;
@@ -669,7 +675,7 @@ void SaveLoadChooserGrid::open() {
 		const int maxSlot = _metaEngine->getMaximumSaveSlot();
 		for (int i = lastSlot; _nextFreeSaveSlot == -1 && i < maxSlot; ++i) {
 			// Check that the save slot can be used for user saves.
-			SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), i + 1);
+			SaveStateDescriptor desc = _saveIndex->querySaveMetaInfos(i + 1);
 			if (!desc.getWriteProtectedFlag()) {
 				_nextFreeSaveSlot = i + 1;
 			}
@@ -863,7 +869,7 @@ void SaveLoadChooserGrid::updateSaves() {
 	for (uint i = _curPage * _entriesPerPage, curNum = 0; i < _saveList.size() && curNum < _entriesPerPage; ++i, ++curNum) {
 		const uint saveSlot = _saveList[i].getSaveSlot();
 
-		SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), saveSlot);
+		SaveStateDescriptor desc = _saveIndex->querySaveMetaInfos(saveSlot);
 		SlotButton &curButton = _buttons[curNum];
 		curButton.setVisible(true);
 		const Graphics::Surface *thumbnail = desc.getThumbnail();
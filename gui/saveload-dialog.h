@@ -27,6 +27,7 @@
 #include "gui/widgets/list.h"
 
 #include "engines/metaengine.h"
+#include "engines/saveindex.h"
 
 namespace GUI {
 
@@ -72,6 +73,7 @@ protected:
 
 	const bool				_saveMode;
 	const MetaEngine		*_metaEngine;
+	SaveStateIndex			*_saveIndex;
 	bool					_delSupport;
 	bool					_metaInfoSupport;
 	bool					_thumbnailSupport;
@@ -0,0 +1,202 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/audiostream.h"
+
+#include "../system/null_osystem.h"
+
+/**
+ * A mono stream of constant samples at the output rate of the mixer, which
+ * counts how many samples were read from it.
+ */
+class ConstantStream : public Audio::AudioStream {
+public:
+	ConstantStream(int length) : samplesRead(0), _left(length) {}
+
+	virtual int readBuffer(int16 *buffer, const int numSamples) {
+		const int samples = MIN(numSamples, _left);
+		for (int i = 0; i < samples; i++)
+			buffer[i] = 1000;
+
+		_left -= samples;
+		samplesRead += samples;
+		return samples;
+	}
+
+	virtual uint getChannels() const { return 1; }
+	virtual int getRate() const { return 22050; }
+	virtual bool endOfData() const { return _left == 0; }
+
+	volatile int samplesRead;
+
+private:
+	int _left;
+};
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kFrames = 64
+	};
+
+	int16 _buffer[kFrames * 2];
+
+	/** Mix one buffer, and return whether it is silent */
+	bool mixSilence(Audio::MixerImpl &mixer) {
+		mixer.mixCallback((byte *)_buffer, sizeof(_buffer));
+
+		for (int i = 0; i < kFrames * 2; i++)
+			if (_buffer[i] != 0)
+				return false;
+
+		return true;
+	}
+
+	struct MixingThread {
+		Audio::MixerImpl *mixer;
+		volatile bool stop;
+		int16 buffer[kFrames * 2];
+
+		static void run(void *param) {
+			MixingThread *thread = (MixingThread *)param;
+			while (!thread->stop)
+				thread->mixer->mixCallback((byte *)thread->buffer, sizeof(thread->buffer));
+		}
+	};
+
+public:
+	void test_play_and_stop() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		ConstantStream stream(100000);
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, &stream, 42, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, false);
+
+		// The channel is known right away, even before the mixing picked it up
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixer.isSoundIDActive(42));
+		TS_ASSERT_EQUALS(mixer.getSoundID(handle), 42);
+		TS_ASSERT_EQUALS(stream.samplesRead, 0);
+
+		TS_ASSERT(!mixSilence(mixer));
+		TS_ASSERT_EQUALS(stream.samplesRead, kFrames);
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixSilence(mixer));
+		TS_ASSERT_EQUALS(stream.samplesRead, kFrames);
+	}
+
+	void test_finished_sound() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, new ConstantStream(kFrames), -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false);
+		TS_ASSERT(mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+
+		TS_ASSERT(!mixSilence(mixer));
+		TS_ASSERT(mixSilence(mixer));
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+	}
+
+	void test_pause() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		ConstantStream stream(100000);
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, &stream, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, false);
+
+		mixer.pauseHandle(handle, true);
+		TS_ASSERT(mixSilence(mixer));
+		TS_ASSERT_EQUALS(stream.samplesRead, 0);
+
+		mixer.pauseAll(true);
+		mixer.pauseHandle(handle, false);
+		TS_ASSERT(mixSilence(mixer));
+
+		mixer.pauseAll(false);
+		TS_ASSERT(!mixSilence(mixer));
+		TS_ASSERT_EQUALS(stream.samplesRead, kFrames);
+
+		mixer.stopAll();
+	}
+
+	void test_elapsed_time() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, new ConstantStream(100000), -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false);
+		TS_ASSERT_EQUALS(mixer.getSoundElapsedTime(handle), 0u);
+
+		((NullOSystem *)g_system)->advanceMillis(10);
+		mixSilence(mixer);
+		mixSilence(mixer);
+		((NullOSystem *)g_system)->advanceMillis(20);
+
+		// Two buffers were consumed, plus the time since the last one
+		TS_ASSERT_EQUALS(mixer.getElapsedTime(handle).totalNumberOfFrames(), (int)(kFrames + 20 * 22050 / 1000));
+	}
+
+	void test_volume_without_mixing() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, new ConstantStream(100000), -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false);
+
+		// More commands than the queue holds, while the mixer is not running
+		for (int i = 0; i < 1000; i++)
+			mixer.setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 999 & 0xFF);
+
+		mixer.setChannelVolume(handle, 0);
+		TS_ASSERT(mixSilence(mixer));
+
+		mixer.setChannelVolume(handle, Audio::Mixer::kMaxChannelVolume);
+		mixer.muteSoundType(Audio::Mixer::kPlainSoundType, true);
+		TS_ASSERT(mixSilence(mixer));
+
+		mixer.muteSoundType(Audio::Mixer::kPlainSoundType, false);
+		TS_ASSERT(!mixSilence(mixer));
+	}
+
+	void test_stop_while_mixing() {
+		NullOSystemInstaller system;
+		Audio::MixerImpl mixer(g_system, 22050);
+		mixer.setReady(true);
+
+		MixingThread thread;
+		thread.mixer = &mixer;
+		thread.stop = false;
+		OSystem::ThreadRef ref = g_system->createThread(&MixingThread::run, &thread, "Mixer");
+		if (!ref)
+			return;
+
+		for (int i = 0; i < 200; i++) {
+			ConstantStream stream(100000);
+			Audio::SoundHandle handle;
+			mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, &stream, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, false);
+			mixer.setChannelVolume(handle, i & 0xFF);
+
+			// Once stopped, the mixing must not touch the stream anymore
+			mixer.stopHandle(handle);
+			const int read = stream.samplesRead;
+			for (int j = 0; j < 100; j++)
+				TS_ASSERT_EQUALS(stream.samplesRead, read);
+		}
+
+		thread.stop = true;
+		g_system->joinThread(ref);
+	}
+};
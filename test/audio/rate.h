@@ -0,0 +1,179 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoders/pcm.h"
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/stream.h"
+#include "common/endian.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	static Audio::AudioStream *createStream(const int16 *samples, int count, int rate, bool stereo) {
+		byte *data = (byte *)malloc(count * 2);
+		for (int i = 0; i < count; i++)
+			WRITE_LE_UINT16(data + i * 2, samples[i]);
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream(data, count * 2, DisposeAfterUse::YES);
+		return Audio::makePCMStream(stream, rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0), DisposeAfterUse::YES);
+	}
+
+	static int16 *createSamples(int count) {
+		// Full scale values, so that mixing has to clamp
+		int16 *samples = new int16[count];
+		uint32 seed = 0x1234567;
+		for (int i = 0; i < count; i++) {
+			seed = seed * 1103515245 + 12345;
+			samples[i] = (int16)(seed >> 16);
+		}
+		return samples;
+	}
+
+	static int16 mixReference(int16 out, int16 in, Audio::st_volume_t vol) {
+		int value = out + (in * (int)vol) / Audio::Mixer::kMaxMixerVolume;
+		if (value > 32767)
+			return 32767;
+		if (value < -32768)
+			return -32768;
+		return value;
+	}
+
+	static const int kOutFrames = 1000;
+
+	/**
+	 * Convert the samples, and check the mixed output against the
+	 * expected converted frames (stereo).
+	 */
+	void checkConverter(int inRate, int outRate, bool stereo, const int16 *samples, int inFrames, const int16 *expected) {
+		const int channels = stereo ? 2 : 1;
+		const Audio::st_volume_t volL = 200;
+		const Audio::st_volume_t volR = Audio::Mixer::kMaxMixerVolume;
+
+		int16 *initial = createSamples(kOutFrames * 2 + 2);
+		int16 *output = new int16[kOutFrames * 2 + 2];
+		memcpy(output, initial, (kOutFrames * 2 + 2) * 2);
+
+		Audio::AudioStream *stream = createStream(samples, inFrames * channels, inRate, stereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo);
+
+		// Odd request sizes exercise the generic tail of the mixing loop
+		int converted = converter->flow(*stream, output, 333, volL, volR);
+		converted += converter->flow(*stream, output + converted * 2, kOutFrames + 1 - converted, volL, volR);
+		TS_ASSERT_EQUALS(converted, kOutFrames);
+
+		for (int i = 0; i < kOutFrames; i++) {
+			TS_ASSERT_EQUALS(output[i * 2 + 0], mixReference(initial[i * 2 + 0], expected[i * 2 + 0], volL));
+			TS_ASSERT_EQUALS(output[i * 2 + 1], mixReference(initial[i * 2 + 1], expected[i * 2 + 1], volR));
+		}
+
+		// Nothing past the converted frames may be touched
+		TS_ASSERT_EQUALS(output[kOutFrames * 2 + 0], initial[kOutFrames * 2 + 0]);
+		TS_ASSERT_EQUALS(output[kOutFrames * 2 + 1], initial[kOutFrames * 2 + 1]);
+
+		delete converter;
+		delete stream;
+		delete[] output;
+		delete[] initial;
+	}
+
+	/**
+	 * Check a converter which picks every step-th input frame, starting
+	 * with the given one.
+	 */
+	void checkPickingConverter(int inRate, int outRate, bool stereo, int step, int offset) {
+		const int channels = stereo ? 2 : 1;
+		const int inFrames = kOutFrames * step + offset;
+		int16 *samples = createSamples(inFrames * channels);
+		int16 *expected = new int16[kOutFrames * 2];
+
+		for (int i = 0; i < kOutFrames; i++) {
+			// Frames before the start of the input are silence
+			const int frame = i * step + offset;
+			expected[i * 2 + 0] = (frame < 0) ? 0 : samples[frame * channels];
+			expected[i * 2 + 1] = (frame < 0) ? 0 : samples[frame * channels + (stereo ? 1 : 0)];
+		}
+
+		checkConverter(inRate, outRate, stereo, samples, inFrames, expected);
+
+		delete[] expected;
+		delete[] samples;
+	}
+
+	/**
+	 * Check a converter which interpolates between the two input frames
+	 * around each output frame, with 15 bits of fractional position.
+	 */
+	void checkInterpolatingConverter(int inRate, int outRate, bool stereo) {
+		const int channels = stereo ? 2 : 1;
+		const int32 step = (inRate << 15) / outRate;
+		// Just enough input for the output frames, so the converter stops
+		const int inFrames = (((kOutFrames - 1) * step) >> 15) + 1;
+		assert(((kOutFrames * step) >> 15) >= inFrames);
+		int16 *samples = createSamples(inFrames * channels);
+		int16 *expected = new int16[kOutFrames * 2];
+
+		for (int i = 0; i < kOutFrames; i++) {
+			// Output frame i lies between the input frames frame - 1 and
+			// frame. The first frame is preceded by silence.
+			const int32 pos = i * step;
+			const int frame = pos >> 15;
+			const int32 frac = pos & 0x7FFF;
+
+			for (int c = 0; c < 2; c++) {
+				const int channel = stereo ? c : 0;
+				const int32 prev = (frame == 0) ? 0 : samples[(frame - 1) * channels + channel];
+				const int32 cur = samples[frame * channels + channel];
+				expected[i * 2 + c] = prev + (((cur - prev) * frac + 0x4000) >> 15);
+			}
+		}
+
+		checkConverter(inRate, outRate, stereo, samples, inFrames, expected);
+
+		delete[] expected;
+		delete[] samples;
+	}
+
+public:
+	void test_copy_mono() {
+		checkPickingConverter(22050, 22050, false, 1, 0);
+	}
+
+	void test_copy_stereo() {
+		checkPickingConverter(22050, 22050, true, 1, 0);
+	}
+
+	void test_simple_mono() {
+		checkPickingConverter(44100, 22050, false, 2, 1);
+	}
+
+	void test_simple_stereo() {
+		checkPickingConverter(44100, 22050, true, 2, 1);
+	}
+
+	void test_linear_mono() {
+		// Rates of 65536 Hz and above always use the linear converter. Each
+		// output frame falls exactly on an input frame here, so the result
+		// is the previous input frame and no interpolation happens.
+		checkPickingConverter(98304, 32768, false, 3, -1);
+	}
+
+	void test_linear_stereo() {
+		checkPickingConverter(98304, 32768, true, 3, -1);
+	}
+
+	void test_linear_upsample_mono() {
+		// 22050 / 48000 is not a whole number, so almost all output frames
+		// are interpolated
+		checkInterpolatingConverter(22050, 48000, false);
+	}
+
+	void test_linear_upsample_stereo() {
+		checkInterpolatingConverter(22050, 48000, true);
+	}
+
+	void test_linear_downsample_stereo() {
+		checkInterpolatingConverter(44100, 32000, true);
+	}
+};
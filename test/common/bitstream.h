@@ -149,4 +149,36 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.peekBits(5), 12u);
 		TS_ASSERT(!bs.eos());
 	}
+
+	void test_peek_bits_end() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		// Bits past the end of the stream are read as 0
+		Common::BitStream8MSB bs(ms);
+		bs.skip(11);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 0x10u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT_EQUALS(bs.getBits(5), 2u);
+		TS_ASSERT(bs.eos());
+	}
+
+	void test_skip_values() {
+		byte contents[] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x12, 0x34, 0x56, 0x78 };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream32LELSB bs(ms);
+		TS_ASSERT_EQUALS(bs.getBits(4), 0x1u);
+		TS_ASSERT_EQUALS(bs.peekBits(32), 0x96745230u);
+		bs.skip(28);
+		TS_ASSERT_EQUALS(bs.pos(), 32u);
+		bs.skip(36);
+		TS_ASSERT_EQUALS(bs.pos(), 68u);
+		TS_ASSERT_EQUALS(bs.getBits(8), 0x41u);
+		TS_ASSERT_EQUALS(bs.peekBits(20), 0x78563u);
+		bs.skip(20);
+		TS_ASSERT(bs.eos());
+	}
 };
@@ -0,0 +1,68 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dcl.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+class DCLTestSuite : public CxxTest::TestSuite {
+	// Binary mode, 1024 byte dictionary: a literal "AI" followed by a copy
+	// which overlaps its own output, and the end of stream marker
+	static const byte *packedData() {
+		static const byte data[] = { 0x00, 0x04, 0x82, 0x24, 0x25, 0x8F, 0x80, 0x7F };
+		return data;
+	}
+
+	enum {
+		kPackedSize = 8,
+		kUnpackedSize = 13
+	};
+
+public:
+	void test_fixed_size() {
+		byte output[kUnpackedSize + 1];
+		memset(output, 0, sizeof(output));
+
+		Common::MemoryReadStream stream(packedData(), kPackedSize);
+		TS_ASSERT(Common::decompressDCL(&stream, output, kPackedSize, kUnpackedSize));
+		TS_ASSERT(!memcmp(output, "AIAIAIAIAIAIA", kUnpackedSize + 1));
+	}
+
+	void test_size_mismatch() {
+		byte output[kUnpackedSize + 4];
+
+		Common::MemoryReadStream stream(packedData(), kPackedSize);
+		TS_ASSERT(!Common::decompressDCL(&stream, output, kPackedSize, kUnpackedSize + 4));
+
+		// The copy would write past the end of a smaller target
+		Common::MemoryReadStream stream2(packedData(), kPackedSize);
+		TS_ASSERT(!Common::decompressDCL(&stream2, output, kPackedSize, kUnpackedSize - 2));
+	}
+
+	void test_dynamic_size() {
+		Common::MemoryReadStream stream(packedData(), kPackedSize);
+		Common::SeekableReadStream *output = Common::decompressDCL(&stream);
+		TS_ASSERT(output);
+		if (!output)
+			return;
+
+		TS_ASSERT_EQUALS(output->size(), (int32)kUnpackedSize);
+		char text[kUnpackedSize + 1];
+		text[output->read(text, kUnpackedSize)] = 0;
+		TS_ASSERT_EQUALS(Common::String(text), "AIAIAIAIAIAIA");
+		delete output;
+	}
+
+	void test_stream_position() {
+		// Data following the packed data is left alone
+		byte data[kPackedSize + 2];
+		memcpy(data, packedData(), kPackedSize);
+		data[kPackedSize] = 0x12;
+		data[kPackedSize + 1] = 0x34;
+
+		Common::MemoryReadStream stream(data, sizeof(data));
+		Common::SeekableReadStream *output = Common::decompressDCL(&stream, kPackedSize, kUnpackedSize);
+		TS_ASSERT(output);
+		delete output;
+		TS_ASSERT_EQUALS(stream.readByte(), 0x12);
+	}
+};
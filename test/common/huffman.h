@@ -141,4 +141,67 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[5]);
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[6]);
 	}
+
+	void test_long_codes() {
+		/*
+		 * Codes longer than the lookup tables, read from streams of
+		 * both bit orders.
+		 *
+		 * Encoding, with codes given MSB first:
+		 * 0=0
+		 * 1=10
+		 * 2=110
+		 * ...
+		 * 13=11111111111110
+		 * 14=11111111111111
+		 */
+		const uint32 codeCount = 15;
+		uint8 lengths[codeCount];
+		uint32 codes[codeCount], codesLSB[codeCount];
+		for (uint32 i = 0; i < codeCount; i++) {
+			lengths[i] = MIN<uint32>(i + 1, codeCount - 1);
+			codes[i] = ((1 << lengths[i]) - 1) & ~(i < codeCount - 1 ? 1 : 0);
+
+			// The same codes with the first bit in the LSB
+			codesLSB[i] = 0;
+			for (uint32 j = 0; j < lengths[i]; j++)
+				codesLSB[i] |= ((codes[i] >> (lengths[i] - 1 - j)) & 1) << j;
+		}
+
+		Common::Huffman h(0, codeCount, codes, lengths, 0);
+		Common::Huffman hLSB(0, codeCount, codesLSB, lengths, 0);
+
+		// Write the symbols 14, 0, 13, 1, 12, 2, ... and fill up with 0
+		byte inputMSB[16], inputLSB[16];
+		memset(inputMSB, 0, sizeof(inputMSB));
+		memset(inputLSB, 0, sizeof(inputLSB));
+		uint32 bitCount = 0;
+		for (uint32 i = 0; i < codeCount; i++) {
+			uint32 symbol = (i & 1) ? i / 2 : codeCount - 1 - i / 2;
+			for (uint32 j = 0; j < lengths[symbol]; j++, bitCount++) {
+				if ((codes[symbol] >> (lengths[symbol] - 1 - j)) & 1) {
+					inputMSB[bitCount / 8] |= 0x80 >> (bitCount % 8);
+					inputLSB[bitCount / 8] |= 1 << (bitCount % 8);
+				}
+			}
+		}
+
+		Common::MemoryReadStream msMSB(inputMSB, sizeof(inputMSB));
+		Common::BitStream8MSB bsMSB(msMSB);
+		Common::MemoryReadStream msLSB(inputLSB, sizeof(inputLSB));
+		Common::BitStream32LELSB bsLSB(msLSB);
+
+		for (uint32 i = 0; i < codeCount; i++) {
+			uint32 symbol = (i & 1) ? i / 2 : codeCount - 1 - i / 2;
+			TS_ASSERT_EQUALS(h.getSymbol(bsMSB), symbol);
+			TS_ASSERT_EQUALS(hLSB.getSymbol(bsLSB), symbol);
+		}
+		TS_ASSERT_EQUALS(bsMSB.pos(), bitCount);
+		TS_ASSERT_EQUALS(bsLSB.pos(), bitCount);
+
+		// The last code ends right at the end of the stream
+		while (bsMSB.pos() < bsMSB.size())
+			TS_ASSERT_EQUALS(h.getSymbol(bsMSB), 0u);
+		TS_ASSERT(bsMSB.eos());
+	}
 };
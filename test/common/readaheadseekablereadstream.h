@@ -0,0 +1,120 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/bufferedstream.h"
+
+#include "../system/null_osystem.h"
+
+class ReadAheadSeekableReadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_traverse() {
+		NullOSystemInstaller system;
+
+		byte contents[100];
+		for (int i = 0; i < 100; ++i)
+			contents[i] = i;
+		Common::MemoryReadStream ms(contents, 100);
+
+		// Reading through more than a few buffers starts reading ahead
+		Common::SeekableReadStream &rasrs
+			= *Common::wrapReadAheadSeekableReadStream(&ms, 4, DisposeAfterUse::NO);
+
+		byte i, b;
+		for (i = 0; i < 100; ++i) {
+			TS_ASSERT(!rasrs.eos());
+
+			TS_ASSERT_EQUALS(i, rasrs.pos());
+
+			rasrs.read(&b, 1);
+			TS_ASSERT_EQUALS(i, b);
+		}
+
+		TS_ASSERT(!rasrs.eos());
+
+		TS_ASSERT_EQUALS((uint)0, rasrs.read(&b, 1));
+		TS_ASSERT(rasrs.eos());
+		TS_ASSERT(!rasrs.err());
+
+		delete &rasrs;
+	}
+
+	void test_large_reads() {
+		NullOSystemInstaller system;
+
+		byte contents[100];
+		for (int i = 0; i < 100; ++i)
+			contents[i] = i;
+		Common::MemoryReadStream ms(contents, 100);
+
+		Common::SeekableReadStream &rasrs
+			= *Common::wrapReadAheadSeekableReadStream(&ms, 8, DisposeAfterUse::NO);
+
+		byte buffer[30];
+		for (int i = 0; i < 3; ++i) {
+			TS_ASSERT_EQUALS(rasrs.read(buffer, 30), (uint)30);
+			TS_ASSERT_EQUALS(memcmp(buffer, contents + i * 30, 30), 0);
+		}
+
+		TS_ASSERT_EQUALS(rasrs.read(buffer, 30), (uint)10);
+		TS_ASSERT_EQUALS(memcmp(buffer, contents + 90, 10), 0);
+		TS_ASSERT(rasrs.eos());
+
+		delete &rasrs;
+	}
+
+	void test_seek() {
+		NullOSystemInstaller system;
+
+		byte contents[100];
+		for (int i = 0; i < 100; ++i)
+			contents[i] = i;
+		Common::MemoryReadStream ms(contents, 100);
+
+		Common::SeekableReadStream &rasrs
+			= *Common::wrapReadAheadSeekableReadStream(&ms, 4, DisposeAfterUse::NO);
+		byte b;
+
+		TS_ASSERT_EQUALS(rasrs.pos(), 0);
+
+		rasrs.seek(1, SEEK_SET);
+		TS_ASSERT_EQUALS(rasrs.pos(), 1);
+		b = rasrs.readByte();
+		TS_ASSERT_EQUALS(b, 1);
+
+		rasrs.seek(5, SEEK_CUR);
+		TS_ASSERT_EQUALS(rasrs.pos(), 7);
+		b = rasrs.readByte();
+		TS_ASSERT_EQUALS(b, 7);
+
+		rasrs.seek(-3, SEEK_CUR);
+		TS_ASSERT_EQUALS(rasrs.pos(), 5);
+		b = rasrs.readByte();
+		TS_ASSERT_EQUALS(b, 5);
+
+		// Seek back while the next buffer is read ahead
+		rasrs.skip(40);
+		TS_ASSERT_EQUALS(rasrs.pos(), 46);
+		b = rasrs.readByte();
+		TS_ASSERT_EQUALS(b, 46);
+		for (int i = 47; i < 60; ++i)
+			TS_ASSERT_EQUALS(rasrs.readByte(), i);
+
+		rasrs.seek(10, SEEK_SET);
+		for (int i = 10; i < 30; ++i)
+			TS_ASSERT_EQUALS(rasrs.readByte(), i);
+
+		rasrs.seek(0, SEEK_END);
+		TS_ASSERT_EQUALS(rasrs.pos(), 100);
+		TS_ASSERT(!rasrs.eos());
+		b = rasrs.readByte();
+		TS_ASSERT(rasrs.eos());
+
+		rasrs.seek(-3, SEEK_END);
+		TS_ASSERT(!rasrs.eos());
+		TS_ASSERT_EQUALS(rasrs.pos(), 97);
+		b = rasrs.readByte();
+		TS_ASSERT_EQUALS(b, 97);
+
+		delete &rasrs;
+	}
+};
@@ -70,4 +70,17 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_data_ptr() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		Common::SeekableSubReadStream ssrs(&ms, 2, 8);
+
+		// The data of the parent stream is shared
+		TS_ASSERT_EQUALS(ssrs.getDataPtr(), contents + 2);
+
+		// Nested substreams share it as well
+		Common::SeekableSubReadStream nested(&ssrs, 1, 4);
+		TS_ASSERT_EQUALS(nested.getDataPtr(), contents + 3);
+	}
 };
@@ -0,0 +1,235 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Large enough for several seek checkpoints of deflated members
+		kLargeSize = 3 * 1024 * 1024 + 123,
+		kSmallSize = 1000
+	};
+
+	byte *_data;
+
+	static byte *createData(uint32 size) {
+		// Random words, so that the data compresses into many deflate blocks
+		// full of references to earlier data
+		static const char *const words[] = {
+			"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ",
+			"zip ", "archive ", "member ", "stream ", "inflate ", "seek ", "a ", "of "
+		};
+
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 0x1234567;
+		for (uint32 i = 0; i < size; ) {
+			seed = seed * 1103515245 + 12345;
+			const char *word = words[(seed >> 24) % ARRAYSIZE(words)];
+			for (; *word && i < size; word++)
+				data[i++] = *word;
+		}
+		return data;
+	}
+
+	static void deflateData(const byte *data, uint32 size, Common::MemoryWriteStreamDynamic &out) {
+#ifdef USE_ZLIB
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+		stream.next_in = const_cast<byte *>(data);
+		stream.avail_in = size;
+
+		byte buf[4096];
+		int zlibErr;
+		do {
+			stream.next_out = buf;
+			stream.avail_out = sizeof(buf);
+			zlibErr = deflate(&stream, Z_FINISH);
+			out.write(buf, sizeof(buf) - stream.avail_out);
+		} while (zlibErr == Z_OK);
+
+		deflateEnd(&stream);
+#endif
+	}
+
+	struct Member {
+		const char *name;
+		uint32 size;
+		bool compressed;
+	};
+
+	/** Create a zip archive with the given members, all taking data from _data. */
+	Common::Archive *createArchive(const Member *members, int count) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		Common::MemoryWriteStreamDynamic centralDir(DisposeAfterUse::YES);
+
+		for (int i = 0; i < count; i++) {
+			const uint32 offset = zip.pos();
+#ifdef USE_ZLIB
+			const uint32 crc = crc32(0, _data, members[i].size);
+#else
+			// The CRC is only checked when zlib is available
+			const uint32 crc = 0;
+#endif
+
+			Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+			if (members[i].compressed)
+				deflateData(_data, members[i].size, data);
+			else
+				data.write(_data, members[i].size);
+
+			const uint16 nameLength = strlen(members[i].name);
+
+			zip.writeUint32LE(0x04034B50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(members[i].compressed ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(crc);
+			zip.writeUint32LE(data.size());
+			zip.writeUint32LE(members[i].size);
+			zip.writeUint16LE(nameLength);
+			zip.writeUint16LE(0);
+			zip.write(members[i].name, nameLength);
+			zip.write(data.getData(), data.size());
+
+			centralDir.writeUint32LE(0x02014B50);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(members[i].compressed ? 8 : 0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(crc);
+			centralDir.writeUint32LE(data.size());
+			centralDir.writeUint32LE(members[i].size);
+			centralDir.writeUint16LE(nameLength);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(offset);
+			centralDir.write(members[i].name, nameLength);
+		}
+
+		const uint32 centralDirOffset = zip.pos();
+		zip.write(centralDir.getData(), centralDir.size());
+
+		zip.writeUint32LE(0x06054B50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(count);
+		zip.writeUint16LE(count);
+		zip.writeUint32LE(centralDir.size());
+		zip.writeUint32LE(centralDirOffset);
+		zip.writeUint16LE(0);
+
+		return Common::makeZipArchive(new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES));
+	}
+
+	bool checkRead(Common::SeekableReadStream &stream, uint32 pos, uint32 size) {
+		byte *buf = (byte *)malloc(size);
+		const bool result = stream.read(buf, size) == size && !memcmp(buf, _data + pos, size);
+		free(buf);
+		return result;
+	}
+
+	void checkMember(Common::SeekableReadStream *stream, uint32 size) {
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// Read everything, in pieces of odd sizes
+		for (uint32 pos = 0; pos < size; pos += 99991)
+			TS_ASSERT(checkRead(*stream, pos, MIN<uint32>(99991, size - pos)));
+		TS_ASSERT(!stream->eos());
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		// Seek around, forward and backward, past and in between checkpoints
+		const uint32 positions[] = { size / 2, 10, size - 100, size / 3, size / 3 + size / 500, 0, size * 5 / 6 };
+		for (uint i = 0; i < ARRAYSIZE(positions); i++) {
+			TS_ASSERT(stream->seek(positions[i], SEEK_SET));
+			TS_ASSERT_EQUALS(stream->pos(), (int32)positions[i]);
+			TS_ASSERT(checkRead(*stream, positions[i], MIN<uint32>(100, size - positions[i])));
+		}
+
+		TS_ASSERT(stream->seek(-50, SEEK_END));
+		TS_ASSERT(checkRead(*stream, size - 50, 50));
+		TS_ASSERT(!stream->err());
+	}
+
+public:
+	void setUp() {
+		_data = createData(kLargeSize);
+	}
+
+	void tearDown() {
+		free(_data);
+	}
+
+	void test_deflated_member() {
+#ifdef USE_ZLIB
+		const Member members[] = { { "large.dat", kLargeSize, true } };
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("large.dat");
+		checkMember(stream, kLargeSize);
+		delete stream;
+		delete archive;
+#endif
+	}
+
+	void test_stored_member() {
+		const Member members[] = { { "large.dat", kLargeSize, false } };
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("large.dat");
+		checkMember(stream, kLargeSize);
+		delete stream;
+		delete archive;
+	}
+
+	void test_small_member() {
+#ifdef USE_ZLIB
+		const Member members[] = { { "small.dat", kSmallSize, true } };
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("small.dat");
+		checkMember(stream, kSmallSize);
+		delete stream;
+		delete archive;
+#endif
+	}
+
+	void test_streams_outlive_archive() {
+#ifdef USE_ZLIB
+		const Member members[] = {
+			{ "deflated.dat", kLargeSize, true },
+			{ "stored.dat", kLargeSize - 1000, false }
+		};
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		Common::SeekableReadStream *deflated = archive->createReadStreamForMember("deflated.dat");
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.dat");
+		delete archive;
+
+		// Both streams use the same archive file, in turns
+		for (uint32 pos = 0; pos < 200000; pos += 10000) {
+			TS_ASSERT(checkRead(*deflated, pos, 10000));
+			TS_ASSERT(checkRead(*stored, pos, 10000));
+		}
+
+		delete deflated;
+		delete stored;
+#endif
+	}
+};
@@ -0,0 +1,101 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Wider than one pattern chunk, and not a multiple of four, so the
+		// generic tail of every chunk is used
+		kWidth = 301,
+		kHeight = 13,
+		// The scalers read one pixel around the source area
+		kSrcPitch = kWidth + 2,
+		kMaxScale = 3
+	};
+
+	static void fillSource(uint16 *src, uint32 seed) {
+		// Simple LCG, so every run tests the same values
+		for (int i = 0; i < kSrcPitch * (kHeight + 2); i++) {
+			seed = seed * 1103515245 + 12345;
+			src[i] = seed >> 16;
+		}
+
+		// Flat areas and areas with small differences, which the hq scalers
+		// don't see as edges
+		for (int y = 3; y < 8; y++) {
+			for (int x = 40; x < 120; x++)
+				src[y * kSrcPitch + x] = 0x4208;
+			for (int x = 150; x < 200; x++)
+				src[y * kSrcPitch + x] = 0x4208 + ((x + y) & 1);
+		}
+	}
+
+	/**
+	 * Scale the source with and without the SIMD code paths, and check
+	 * that both give the same result.
+	 */
+	bool compareScaler(ScalerProc *scaler, int scale) {
+		uint16 *src = new uint16[kSrcPitch * (kHeight + 2)];
+		uint16 *dst = new uint16[kWidth * kHeight * kMaxScale * kMaxScale];
+		uint16 *reference = new uint16[kWidth * kHeight * kMaxScale * kMaxScale];
+		const uint32 dstPitch = kWidth * scale * sizeof(uint16);
+		const uint32 dstSize = kWidth * kHeight * scale * scale * sizeof(uint16);
+
+		bool equal = true;
+		for (uint32 seed = 1; seed <= 3 && equal; seed++) {
+			fillSource(src, seed);
+			const uint8 *srcPtr = (const uint8 *)(src + kSrcPitch + 1);
+
+			SetScalerSIMD(true);
+			scaler(srcPtr, kSrcPitch * sizeof(uint16), (uint8 *)dst, dstPitch, kWidth, kHeight);
+			SetScalerSIMD(false);
+			scaler(srcPtr, kSrcPitch * sizeof(uint16), (uint8 *)reference, dstPitch, kWidth, kHeight);
+			SetScalerSIMD(true);
+
+			equal = !memcmp(dst, reference, dstSize);
+		}
+
+		delete[] src;
+		delete[] dst;
+		delete[] reference;
+		return equal;
+	}
+
+public:
+	void tearDown() {
+		DestroyScalers();
+	}
+
+	void test_hq_scalers_565() {
+#ifdef USE_HQ_SCALERS
+		InitScalers(565);
+		TS_ASSERT(compareScaler(HQ2x, 2));
+		TS_ASSERT(compareScaler(HQ3x, 3));
+#endif
+	}
+
+	void test_hq_scalers_555() {
+#ifdef USE_HQ_SCALERS
+		InitScalers(555);
+		TS_ASSERT(compareScaler(HQ2x, 2));
+		TS_ASSERT(compareScaler(HQ3x, 3));
+#endif
+	}
+
+	void test_hq2x_flat() {
+#ifdef USE_HQ_SCALERS
+		// Without any edges, every pixel is just repeated
+		InitScalers(565);
+		uint16 src[kSrcPitch * 3];
+		for (int i = 0; i < ARRAYSIZE(src); i++)
+			src[i] = 0x1234;
+		uint16 dst[kWidth * 2 * 2];
+		HQ2x((const uint8 *)(src + kSrcPitch + 1), kSrcPitch * sizeof(uint16), (uint8 *)dst, kWidth * 2 * sizeof(uint16), kWidth, 1);
+
+		bool flat = true;
+		for (int i = 0; i < ARRAYSIZE(dst); i++)
+			flat &= (dst[i] == 0x1234);
+		TS_ASSERT(flat);
+#endif
+	}
+};
@@ -0,0 +1,202 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/threadpool.h"
+#include "graphics/pixelformat.h"
+#include "graphics/transparent_surface.h"
+
+#include "../system/null_osystem.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Not a multiple of four, so the generic tail of every row is used
+		kWidth = 37,
+		kHeight = 9
+	};
+
+	static void fillSurface(Graphics::Surface &surface, uint32 seed) {
+		// Simple LCG, so every run tests the same values
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				seed = seed * 1103515245 + 12345;
+				uint32 pixel = (seed >> 16) & 0xFFFF;
+				seed = seed * 1103515245 + 12345;
+				pixel |= seed & 0xFFFF0000;
+
+				// Make fully transparent and fully opaque pixels common
+				if ((x + y) % 5 == 0)
+					pixel &= ~surface.format.ARGBToColor(255, 0, 0, 0);
+				else if ((x + y) % 5 == 1)
+					pixel |= surface.format.ARGBToColor(255, 0, 0, 0);
+
+				*(uint32 *)surface.getBasePtr(x, y) = pixel;
+			}
+		}
+	}
+
+	/**
+	 * Blit a sprite normally, and blit its mirror image flipped horizontally.
+	 * The flipped blit always uses the generic code, so both have to give
+	 * the same result.
+	 */
+	bool compareBlit(uint color, Graphics::TSpriteBlendMode blendMode, Graphics::AlphaType alphaMode) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		Graphics::TransparentSurface sprite, mirror;
+		sprite.create(kWidth, kHeight, format);
+		mirror.create(kWidth, kHeight, format);
+		sprite.setAlphaMode(alphaMode);
+		mirror.setAlphaMode(alphaMode);
+
+		fillSurface(sprite, 12345);
+		for (int y = 0; y < kHeight; y++)
+			for (int x = 0; x < kWidth; x++)
+				*(uint32 *)mirror.getBasePtr(kWidth - 1 - x, y) = *(const uint32 *)sprite.getBasePtr(x, y);
+
+		Graphics::Surface target, reference;
+		target.create(kWidth + 3, kHeight + 2, format);
+		reference.create(kWidth + 3, kHeight + 2, format);
+		fillSurface(target, 54321);
+		reference.copyFrom(target);
+
+		sprite.blit(target, 1, 1, Graphics::FLIP_NONE, nullptr, color, -1, -1, blendMode);
+		mirror.blit(reference, 1, 1, Graphics::FLIP_H, nullptr, color, -1, -1, blendMode);
+
+		bool equal = true;
+		for (int y = 0; y < target.h && equal; y++)
+			equal = !memcmp(target.getBasePtr(0, y), reference.getBasePtr(0, y), target.w * 4);
+
+		sprite.free();
+		mirror.free();
+		target.free();
+		reference.free();
+		return equal;
+	}
+
+	static bool equalSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h)
+			return false;
+
+		for (int y = 0; y < a.h; y++)
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * 4))
+				return false;
+
+		return true;
+	}
+
+	/**
+	 * Scale or rotate a sprite large enough to be split into bands, on the
+	 * calling thread and on a thread pool, which has to give the same result.
+	 */
+	bool compareBanded(bool rotate, bool filtering) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::TransparentSurface sprite;
+		sprite.create(kWidth * 4, kHeight * 20, format);
+		fillSurface(sprite, 12345);
+
+		Graphics::TransformStruct transform(200, 150, 30, kWidth * 2, kHeight * 10);
+		Common::ThreadPool pool(3, "Transform");
+
+		Graphics::TransparentSurface *single, *banded;
+		if (rotate) {
+			single = sprite.rotoscale(transform, filtering);
+			banded = sprite.rotoscale(transform, filtering, &pool);
+		} else {
+			single = sprite.scale(kWidth * 9, kHeight * 30, filtering);
+			banded = sprite.scale(kWidth * 9, kHeight * 30, filtering, &pool);
+		}
+
+		const bool equal = equalSurfaces(*single, *banded);
+
+		single->free();
+		delete single;
+		banded->free();
+		delete banded;
+		sprite.free();
+		return equal;
+	}
+
+public:
+	void test_blit_binary() {
+		TS_ASSERT(compareBlit(0xFFFFFFFF, Graphics::BLEND_NORMAL, Graphics::ALPHA_BINARY));
+	}
+
+	void test_blit_alpha_blend() {
+		TS_ASSERT(compareBlit(0xFFFFFFFF, Graphics::BLEND_NORMAL, Graphics::ALPHA_FULL));
+	}
+
+	void test_blit_alpha_blend_color_mod() {
+		TS_ASSERT(compareBlit(0x80FF4010, Graphics::BLEND_NORMAL, Graphics::ALPHA_FULL));
+		TS_ASSERT(compareBlit(0xFF7FC0FF, Graphics::BLEND_NORMAL, Graphics::ALPHA_FULL));
+	}
+
+	void test_blit_additive_blend() {
+		TS_ASSERT(compareBlit(0xFFFFFFFF, Graphics::BLEND_ADDITIVE, Graphics::ALPHA_FULL));
+		TS_ASSERT(compareBlit(0x80FF4010, Graphics::BLEND_ADDITIVE, Graphics::ALPHA_FULL));
+	}
+
+	void test_blit_subtractive_blend() {
+		TS_ASSERT(compareBlit(0xFFFFFFFF, Graphics::BLEND_SUBTRACTIVE, Graphics::ALPHA_FULL));
+		TS_ASSERT(compareBlit(0x80FF4010, Graphics::BLEND_SUBTRACTIVE, Graphics::ALPHA_FULL));
+	}
+
+	void test_scale_nearest() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::TransparentSurface sprite;
+		sprite.create(kWidth, kHeight, format);
+		fillSurface(sprite, 12345);
+
+		Graphics::TransparentSurface *scaled = sprite.scale(kWidth * 2, kHeight * 2);
+		bool equal = true;
+		for (int y = 0; y < scaled->h; y++)
+			for (int x = 0; x < scaled->w; x++)
+				equal &= *(const uint32 *)scaled->getBasePtr(x, y) == *(const uint32 *)sprite.getBasePtr(x / 2, y / 2);
+		TS_ASSERT(equal);
+
+		scaled->free();
+		delete scaled;
+		sprite.free();
+	}
+
+	void test_scale_bilinear() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::TransparentSurface sprite;
+		sprite.create(kWidth, kHeight, format);
+
+		// Horizontal gradient, which has to stay monotonic and keep its ends
+		for (int y = 0; y < kHeight; y++)
+			for (int x = 0; x < kWidth; x++)
+				*(uint32 *)sprite.getBasePtr(x, y) = format.ARGBToColor(255, x * 7, 128, 255 - x * 7);
+
+		Graphics::TransparentSurface *scaled = sprite.scale(kWidth * 3, kHeight, true);
+		bool monotonic = true;
+		for (int x = 1; x < scaled->w; x++) {
+			byte a0, r0, g0, b0, a1, r1, g1, b1;
+			format.colorToARGB(*(const uint32 *)scaled->getBasePtr(x - 1, 2), a0, r0, g0, b0);
+			format.colorToARGB(*(const uint32 *)scaled->getBasePtr(x, 2), a1, r1, g1, b1);
+			monotonic &= (r1 >= r0 && b1 <= b0 && g1 == 128 && a1 == 255);
+		}
+		TS_ASSERT(monotonic);
+		TS_ASSERT_EQUALS(*(const uint32 *)scaled->getBasePtr(0, 0), *(const uint32 *)sprite.getBasePtr(0, 0));
+
+		// Bilinear filtering has to produce in-between values
+		byte a, r, g, b;
+		format.colorToARGB(*(const uint32 *)scaled->getBasePtr(1, 0), a, r, g, b);
+		TS_ASSERT(r > 0 && r < 7);
+
+		scaled->free();
+		delete scaled;
+		sprite.free();
+	}
+
+	void test_scale_banded() {
+		NullOSystemInstaller system;
+		TS_ASSERT(compareBanded(false, false));
+		TS_ASSERT(compareBanded(false, true));
+	}
+
+	void test_rotoscale_banded() {
+		NullOSystemInstaller system;
+		TS_ASSERT(compareBanded(true, false));
+		TS_ASSERT(compareBanded(true, true));
+	}
+};
@@ -0,0 +1,95 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 44,
+		kHeight = 12,
+		kPitch = 48
+	};
+
+	byte _y[kPitch * kHeight];
+	byte _u[kPitch * kHeight];
+	byte _v[kPitch * kHeight];
+
+	void fillPlanes() {
+		// Simple LCG, so every run tests the same values
+		uint32 seed = 12345;
+
+		for (int i = 0; i < kPitch * kHeight; i++) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = (seed >> 16) & 0xFF;
+			seed = seed * 1103515245 + 12345;
+			_u[i] = (seed >> 16) & 0xFF;
+			seed = seed * 1103515245 + 12345;
+			_v[i] = (seed >> 16) & 0xFF;
+		}
+
+		// Make sure the extremes are hit as well
+		_y[0] = _u[0] = _v[0] = 0;
+		_y[1] = _u[1] = _v[1] = 255;
+	}
+
+	bool compare(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, int type) {
+		Graphics::Surface reference, simd;
+		reference.create(kWidth, kHeight, format);
+		simd.create(kWidth, kHeight, format);
+
+		for (int pass = 0; pass < 2; pass++) {
+			Graphics::Surface *dst = pass ? &simd : &reference;
+			YUVToRGBMan.setUseSIMD(pass != 0);
+
+			switch (type) {
+			case 444:
+				YUVToRGBMan.convert444(dst, scale, _y, _u, _v, kWidth, kHeight, kPitch, kPitch);
+				break;
+			case 420:
+				YUVToRGBMan.convert420(dst, scale, _y, _u, _v, kWidth, kHeight, kPitch, kPitch);
+				break;
+			case 410:
+				YUVToRGBMan.convert410(dst, scale, _y, _u, _v, kWidth, kHeight, kPitch, kPitch);
+				break;
+			}
+		}
+
+		YUVToRGBMan.setUseSIMD(true);
+		bool result = memcmp(reference.getPixels(), simd.getPixels(), reference.pitch * reference.h) == 0;
+		reference.free();
+		simd.free();
+		return result;
+	}
+
+	void compareAll(int type) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0)
+		};
+
+		fillPlanes();
+
+		for (int i = 0; i < ARRAYSIZE(formats); i++) {
+			TS_ASSERT(compare(formats[i], Graphics::YUVToRGBManager::kScaleFull, type));
+			TS_ASSERT(compare(formats[i], Graphics::YUVToRGBManager::kScaleITU, type));
+		}
+	}
+
+public:
+	void test_convert444() {
+		compareAll(444);
+	}
+
+	void test_convert420() {
+		compareAll(420);
+	}
+
+	void test_convert410() {
+		compareAll(410);
+	}
+};
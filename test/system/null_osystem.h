@@ -0,0 +1,153 @@
+#ifndef TEST_SYSTEM_NULL_OSYSTEM_H
+#define TEST_SYSTEM_NULL_OSYSTEM_H
+
+#include "common/scummsys.h"
+#include "common/system.h"
+#include "graphics/surface.h"
+
+#if defined(POSIX)
+#include <pthread.h>
+#endif
+
+/**
+ * A minimal OSystem for tests of code that needs g_system.
+ *
+ * It has no screen, overlay or mixer. Time only advances through
+ * advanceMillis(), so tests are deterministic. Mutexes, and on POSIX also
+ * worker threads, are real.
+ */
+class NullOSystem : public OSystem {
+public:
+	NullOSystem() : _millis(0) {}
+
+	void advanceMillis(uint32 msecs) { _millis += msecs; }
+
+	virtual const GraphicsMode *getSupportedGraphicsModes() const {
+		static const GraphicsMode modes[] = { { 0, 0, 0 } };
+		return modes;
+	}
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return true; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return &_screen; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(void *buf, int pitch) {}
+	virtual void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+	virtual uint32 getMillis(bool skipRecord = false) { return _millis; }
+	virtual void delayMillis(uint msecs) { _millis += msecs; }
+	virtual void getTimeAndDate(TimeDate &t) const { memset(&t, 0, sizeof(t)); }
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+
+#if defined(POSIX)
+	virtual MutexRef createMutex() {
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+		pthread_mutex_t *mutex = new pthread_mutex_t;
+		pthread_mutex_init(mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+		return (MutexRef)mutex;
+	}
+	virtual void lockMutex(MutexRef mutex) { pthread_mutex_lock((pthread_mutex_t *)mutex); }
+	virtual void unlockMutex(MutexRef mutex) { pthread_mutex_unlock((pthread_mutex_t *)mutex); }
+	virtual void deleteMutex(MutexRef mutex) {
+		pthread_mutex_destroy((pthread_mutex_t *)mutex);
+		delete (pthread_mutex_t *)mutex;
+	}
+
+	virtual ThreadRef createThread(ThreadProc proc, void *param, const char *name) {
+		ThreadStart *start = new ThreadStart;
+		start->proc = proc;
+		start->param = param;
+
+		if (pthread_create(&start->thread, 0, threadEntry, start) != 0) {
+			delete start;
+			return 0;
+		}
+
+		return (ThreadRef)start;
+	}
+	virtual void joinThread(ThreadRef thread) {
+		ThreadStart *start = (ThreadStart *)thread;
+		pthread_join(start->thread, 0);
+		delete start;
+	}
+
+	virtual ConditionRef createCondition() {
+		pthread_cond_t *cond = new pthread_cond_t;
+		pthread_cond_init(cond, 0);
+		return (ConditionRef)cond;
+	}
+	virtual void waitCondition(ConditionRef cond, MutexRef mutex) {
+		pthread_cond_wait((pthread_cond_t *)cond, (pthread_mutex_t *)mutex);
+	}
+	virtual void signalCondition(ConditionRef cond) { pthread_cond_signal((pthread_cond_t *)cond); }
+	virtual void broadcastCondition(ConditionRef cond) { pthread_cond_broadcast((pthread_cond_t *)cond); }
+	virtual void deleteCondition(ConditionRef cond) {
+		pthread_cond_destroy((pthread_cond_t *)cond);
+		delete (pthread_cond_t *)cond;
+	}
+	virtual uint getCPUCount() { return 2; }
+#else
+	virtual MutexRef createMutex() { return (MutexRef)1; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+#endif
+
+private:
+	uint32 _millis;
+	Graphics::Surface _screen;
+
+#if defined(POSIX)
+	struct ThreadStart {
+		pthread_t thread;
+		ThreadProc proc;
+		void *param;
+	};
+
+	static void *threadEntry(void *param) {
+		ThreadStart *start = (ThreadStart *)param;
+		start->proc(start->param);
+		return 0;
+	}
+#endif
+};
+
+/**
+ * Installs a NullOSystem as g_system for as long as it exists.
+ */
+class NullOSystemInstaller {
+public:
+	NullOSystemInstaller() : _oldSystem(g_system) { g_system = &_system; }
+	~NullOSystemInstaller() { g_system = _oldSystem; }
+
+	NullOSystem &getSystem() { return _system; }
+
+private:
+	NullOSystem _system;
+	OSystem *_oldSystem;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include <cxxtest/TestSuite.h>
+
+#include "video/video_decoder.h"
+
+#include "../system/null_osystem.h"
+
+#if defined(POSIX)
+#include <unistd.h>
+#endif
+
+/**
+ * A video of single pixel frames, whose value is the frame number.
+ */
+class StubVideoDecoder : public Video::VideoDecoder {
+public:
+	class StubVideoTrack : public FixedRateVideoTrack {
+	public:
+		StubVideoTrack(int frameCount) : _frameCount(frameCount), _curFrame(-1), _decodedFrames(0), _failSeek(false) {
+			_surface.create(1, 1, Graphics::PixelFormat::createFormatCLUT8());
+		}
+
+		~StubVideoTrack() { _surface.free(); }
+
+		bool isSeekable() const { return true; }
+		bool seek(const Common::Timestamp &time) {
+			if (_failSeek)
+				return false;
+
+			_curFrame = time.convertToFramerate(10).totalNumberOfFrames() - 1;
+			return true;
+		}
+
+		uint16 getWidth() const { return 1; }
+		uint16 getHeight() const { return 1; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return _frameCount; }
+
+		const Graphics::Surface *decodeNextFrame() {
+			_curFrame++;
+			*(byte *)_surface.getPixels() = _curFrame;
+			_decodedFrames++;
+			return &_surface;
+		}
+
+		int _frameCount;
+		int _curFrame;
+		volatile int _decodedFrames;
+		bool _failSeek;
+
+	protected:
+		Common::Rational getFrameRate() const { return 10; }
+
+	private:
+		Graphics::Surface _surface;
+	};
+
+	StubVideoDecoder() : _track(0) {}
+	~StubVideoDecoder() { close(); }
+
+	bool loadStream(Common::SeekableReadStream *stream) {
+		_track = new StubVideoTrack(10);
+		addTrack(_track);
+		return true;
+	}
+
+	/** Wait until the decode-ahead thread has decoded the given number of frames. */
+	bool waitForDecodedFrames(int count) {
+#if defined(POSIX)
+		for (int i = 0; i < 5000 && _track->_decodedFrames < count; i++)
+			usleep(1000);
+#endif
+		return _track->_decodedFrames >= count;
+	}
+
+	StubVideoTrack *_track;
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite {
+public:
+	static int nextFrame(StubVideoDecoder &video) {
+		const Graphics::Surface *frame = video.decodeNextFrame();
+
+		if (!frame)
+			return -1;
+
+		return *(const byte *)frame->getPixels();
+	}
+
+	void test_decode_ahead_order() {
+		NullOSystemInstaller system;
+		StubVideoDecoder video;
+		video.loadStream(0);
+
+		if (!video.setDecodeAhead(3))
+			return; // No worker threads on this platform
+
+		TS_ASSERT(video.isDecodingAhead());
+		video.start();
+
+		for (int i = 0; i < 10; i++) {
+			TS_ASSERT(!video.endOfVideo());
+			TS_ASSERT_EQUALS(nextFrame(video), i);
+			TS_ASSERT_EQUALS(video.getCurFrame(), i);
+		}
+
+		TS_ASSERT(video.endOfVideo());
+	}
+
+	void test_decode_ahead_seek() {
+		NullOSystemInstaller system;
+		StubVideoDecoder video;
+		video.loadStream(0);
+
+		if (!video.setDecodeAhead(3))
+			return;
+
+		video.start();
+		TS_ASSERT_EQUALS(nextFrame(video), 0);
+		TS_ASSERT_EQUALS(nextFrame(video), 1);
+
+		// The queued frames 2 to 4 are dropped
+		TS_ASSERT(video.waitForDecodedFrames(5));
+		TS_ASSERT(video.seekToFrame(7));
+		TS_ASSERT_EQUALS(video.getCurFrame(), 6);
+		TS_ASSERT_EQUALS(nextFrame(video), 7);
+		TS_ASSERT_EQUALS(nextFrame(video), 8);
+
+		// A failed seek keeps the queue, and the thread decoding
+		TS_ASSERT(video.waitForDecodedFrames(8));
+		video._track->_failSeek = true;
+		TS_ASSERT(!video.seekToFrame(2));
+		TS_ASSERT_EQUALS(nextFrame(video), 9);
+		TS_ASSERT(video.endOfVideo());
+	}
+
+	void test_decode_ahead_failed_seek_restarts_thread() {
+		NullOSystemInstaller system;
+		StubVideoDecoder video;
+		video.loadStream(0);
+
+		video.start();
+		video._track->_failSeek = true;
+
+		if (!video.setDecodeAhead(3))
+			return;
+
+		// Seeking stops the thread, which has to fill the queue afterwards
+		TS_ASSERT(!video.seekToFrame(5));
+		TS_ASSERT(video.waitForDecodedFrames(3));
+		TS_ASSERT_EQUALS(nextFrame(video), 0);
+	}
+
+	void test_decode_ahead_rewind() {
+		NullOSystemInstaller system;
+		StubVideoDecoder video;
+		video.loadStream(0);
+
+		if (!video.setDecodeAhead(3))
+			return;
+
+		video.start();
+		TS_ASSERT_EQUALS(nextFrame(video), 0);
+		TS_ASSERT_EQUALS(nextFrame(video), 1);
+		TS_ASSERT_EQUALS(nextFrame(video), 2);
+
+		TS_ASSERT(video.rewind());
+		TS_ASSERT_EQUALS(video.getCurFrame(), -1);
+		TS_ASSERT_EQUALS(nextFrame(video), 0);
+		TS_ASSERT_EQUALS(nextFrame(video), 1);
+	}
+
+	void test_decode_ahead_pause() {
+		NullOSystemInstaller system;
+		StubVideoDecoder video;
+		video.loadStream(0);
+
+		if (!video.setDecodeAhead(3))
+			return;
+
+		video.start();
+		TS_ASSERT(video.waitForDecodedFrames(3));
+
+		// Pausing waits for the thread, and nothing is decoded while paused
+		video.pauseVideo(true);
+		const int decodedFrames = video._track->_decodedFrames;
+		TS_ASSERT_EQUALS(decodedFrames, 3);
+		TS_ASSERT_EQUALS(nextFrame(video), 0);
+		TS_ASSERT_EQUALS(video._track->_decodedFrames, decodedFrames);
+
+		// Resuming fills the queue again
+		video.pauseVideo(false);
+		TS_ASSERT(video.waitForDecodedFrames(4));
+		TS_ASSERT_EQUALS(nextFrame(video), 1);
+	}
+};
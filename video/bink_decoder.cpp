@@ -31,6 +31,7 @@
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/math.h"
+#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/substream.h"
 #include "common/file.h"
@@ -201,16 +202,20 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	// Read the whole video packet at once. The bit reader fetches 32 bits
+	// at a time, and going through the file for each of those adds up for
+	// large frames. The chroma planes may get a bit reader of their own.
+	byte *data = (byte *)malloc(frameSize);
+	frameSize = _bink->read(data, frameSize);
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
+	frame.data = data;
+	frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(data, frameSize, DisposeAfterUse::YES), true);
 
 	videoTrack->decodePacket(frame);
 
 	delete frame.bits;
 	frame.bits = 0;
+	frame.data = 0;
 }
 
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
@@ -223,7 +228,7 @@ VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
-BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
+BinkDecoder::VideoFrame::VideoFrame() : data(0), bits(0) {
 }
 
 BinkDecoder::VideoFrame::~VideoFrame() {
@@ -250,23 +255,29 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
-	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = 0;
+	for (int k = 0; k < 2; k++) {
+		PlaneState &state = _planeStates[k];
 
-		_bundles[i].huffman.index = 0;
-		for (int j = 0; j < 16; j++)
-			_bundles[i].huffman.symbols[j] = j;
+		for (int i = 0; i < kSourceMAX; i++) {
+			state.bundles[i].countLength = 0;
 
-		_bundles[i].data     = 0;
-		_bundles[i].dataEnd  = 0;
-		_bundles[i].curDec   = 0;
-		_bundles[i].curPtr   = 0;
-	}
+			state.bundles[i].huffman.index = 0;
+			for (int j = 0; j < 16; j++)
+				state.bundles[i].huffman.symbols[j] = j;
 
-	for (int i = 0; i < 16; i++) {
-		_colHighHuffman[i].index = 0;
-		for (int j = 0; j < 16; j++)
-			_colHighHuffman[i].symbols[j] = j;
+			state.bundles[i].data     = 0;
+			state.bundles[i].dataEnd  = 0;
+			state.bundles[i].curDec   = 0;
+			state.bundles[i].curPtr   = 0;
+		}
+
+		for (int i = 0; i < 16; i++) {
+			state.colHighHuffman[i].index = 0;
+			for (int j = 0; j < 16; j++)
+				state.colHighHuffman[i].symbols[j] = j;
+		}
+
+		state.colLastVal = 0;
 	}
 
 	// Make the surface even-sized:
@@ -310,8 +321,25 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, (width >> 1) * (height >> 1));
 	memset(_oldPlanes[3], 255,  width       *  height      );
 
-	initBundles();
+	initBundles(_planeStates[0]);
 	initHuffman();
+
+	// With a second core, the chroma planes of BIKi videos are decoded at
+	// the same time as the luma plane
+	_planeThread = 0;
+	_chromaOffset = kChromaOffsetNone;
+
+	if (_id == kBIKiID && g_system->getCPUCount() > 1) {
+		_planeThread = new Common::ThreadPool(1, "BinkChroma");
+
+		if (_planeThread->getThreadCount() != 0) {
+			initBundles(_planeStates[1]);
+			_chromaOffset = kChromaOffsetUnknown;
+		} else {
+			delete _planeThread;
+			_planeThread = 0;
+		}
+	}
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
@@ -320,7 +348,10 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
 	}
 
-	deinitBundles();
+	delete _planeThread;
+
+	deinitBundles(_planeStates[0]);
+	deinitBundles(_planeStates[1]);
 
 	for (int i = 0; i < 16; i++) {
 		delete _huffman[i];
@@ -337,19 +368,56 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
 
-		decodePlane(frame, 3, false);
+		decodePlane(frame, _planeStates[0], 3, false);
 	}
 
-	if (_id == kBIKiID)
-		frame.bits->skip(32);
+	uint32 chromaOffset = 0, chromaOffsetEnd = 0;
 
-	for (int i = 0; i < 3; i++) {
-		int planeIdx = ((i == 0) || !_swapPlanes) ? i : (i ^ 3);
+	if (_id == kBIKiID) {
+		chromaOffset = frame.bits->getBits(32);
+		chromaOffsetEnd = frame.bits->pos() / 8;
+	}
 
-		decodePlane(frame, planeIdx, i != 0);
+	// Within a plane, every block row reads its bundle data right after
+	// the previous row's, so the planes themselves are the smallest unit
+	// that can be decoded on its own. Only BIKi stores where the chroma
+	// planes start; the two of them still follow each other.
+	uint32 chromaStart;
+
+	if (getChromaStart(chromaOffset, chromaOffsetEnd, frame.bits->size() / 8, chromaStart)) {
+		VideoFrame chroma;
+		chroma.data = frame.data;
+		chroma.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(frame.data + chromaStart,
+				frame.bits->size() / 8 - chromaStart), true);
+
+		ChromaJob job(this, &chroma);
+		_planeThread->addJob(&job);
+		decodePlane(frame, _planeStates[0], 0, false);
+		_planeThread->wait();
+
+		// Should the offset ever be wrong, decode them again from where
+		// the luma plane really ended
+		if (frame.bits->pos() != chromaStart * 8) {
+			warning("Bink chroma plane offset %d does not match %d", chromaStart, frame.bits->pos() / 8);
+			_chromaOffset = kChromaOffsetNone;
+			decodeChromaPlanes(frame, _planeStates[0]);
+		}
+	} else {
+		decodePlane(frame, _planeStates[0], 0, false);
 
-		if (frame.bits->pos() >= frame.bits->size())
-			break;
+		// The first frame tells how the offset is stored
+		if (_chromaOffset == kChromaOffsetUnknown) {
+			const uint32 lumaEnd = frame.bits->pos() / 8;
+
+			if (lumaEnd == chromaOffset)
+				_chromaOffset = kChromaOffsetAbsolute;
+			else if (lumaEnd == chromaOffsetEnd + chromaOffset)
+				_chromaOffset = kChromaOffsetRelative;
+			else
+				_chromaOffset = kChromaOffsetNone;
+		}
+
+		decodeChromaPlanes(frame, _planeStates[0]);
 	}
 
 	// Convert the YUV data we have to our format
@@ -367,7 +435,36 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
+void BinkDecoder::BinkVideoTrack::decodeChromaPlanes(VideoFrame &video, PlaneState &state) {
+	for (int i = 1; i < 3; i++) {
+		// Some videos have no chroma planes
+		if (video.bits->pos() >= video.bits->size())
+			break;
+
+		decodePlane(video, state, _swapPlanes ? (i ^ 3) : i, true);
+	}
+}
+
+bool BinkDecoder::BinkVideoTrack::getChromaStart(uint32 offset, uint32 offsetEnd, uint32 size, uint32 &start) const {
+	switch (_chromaOffset) {
+	case kChromaOffsetAbsolute:
+		start = offset;
+		break;
+	case kChromaOffsetRelative:
+		start = offsetEnd + offset;
+		break;
+	default:
+		return false;
+	}
+
+	return start > offsetEnd && start < size;
+}
+
+void BinkDecoder::BinkVideoTrack::ChromaJob::run() {
+	_track->decodeChromaPlanes(*_video, _track->_planeStates[1]);
+}
+
+void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, PlaneState &state, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? ((_surface.w  + 15) >> 4) : ((_surface.w  + 7) >> 3);
 	uint32 blockHeight = isChroma ? ((_surface.h + 15) >> 4) : ((_surface.h + 7) >> 3);
 	uint32 width       = isChroma ?  (_surface.w        >> 1) :   _surface.w;
@@ -376,6 +473,7 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	DecodeContext ctx;
 
 	ctx.video     = &video;
+	ctx.state     = &state;
 	ctx.planeIdx  = planeIdx;
 	ctx.destStart = _curPlanes[planeIdx];
 	ctx.destEnd   = _curPlanes[planeIdx] + width * height;
@@ -393,27 +491,27 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	}
 
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = _bundles[i].countLengths[isChroma ? 1 : 0];
+		state.bundles[i].countLength = state.bundles[i].countLengths[isChroma ? 1 : 0];
 
-		readBundle(video, (Source) i);
+		readBundle(video, state, (Source) i);
 	}
 
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
-		readBlockTypes  (video, _bundles[kSourceBlockTypes]);
-		readBlockTypes  (video, _bundles[kSourceSubBlockTypes]);
-		readColors      (video, _bundles[kSourceColors]);
-		readPatterns    (video, _bundles[kSourcePattern]);
-		readMotionValues(video, _bundles[kSourceXOff]);
-		readMotionValues(video, _bundles[kSourceYOff]);
-		readDCS         (video, _bundles[kSourceIntraDC], kDCStartBits, false);
-		readDCS         (video, _bundles[kSourceInterDC], kDCStartBits, true);
-		readRuns        (video, _bundles[kSourceRun]);
+		readBlockTypes  (video, state.bundles[kSourceBlockTypes]);
+		readBlockTypes  (video, state.bundles[kSourceSubBlockTypes]);
+		readColors      (video, state);
+		readPatterns    (video, state.bundles[kSourcePattern]);
+		readMotionValues(video, state.bundles[kSourceXOff]);
+		readMotionValues(video, state.bundles[kSourceYOff]);
+		readDCS         (video, state.bundles[kSourceIntraDC], kDCStartBits, false);
+		readDCS         (video, state.bundles[kSourceInterDC], kDCStartBits, true);
+		readRuns        (video, state.bundles[kSourceRun]);
 
 		ctx.dest = ctx.destStart + 8 * ctx.blockY * ctx.pitch;
 		ctx.prev = ctx.prevStart + 8 * ctx.blockY * ctx.pitch;
 
 		for (ctx.blockX = 0; ctx.blockX < blockWidth; ctx.blockX++, ctx.dest += 8, ctx.prev += 8) {
-			BlockType blockType = (BlockType) getBundleValue(kSourceBlockTypes);
+			BlockType blockType = (BlockType) getBundleValue(ctx, kSourceBlockTypes);
 
 			// 16x16 block type on odd line means part of the already decoded block, so skip it
 			if ((ctx.blockY & 1) && (blockType == kBlockScaled)) {
@@ -467,19 +565,19 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 }
 
-void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, Source source) {
+void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, PlaneState &state, Source source) {
 	if (source == kSourceColors) {
 		for (int i = 0; i < 16; i++)
-			readHuffman(video, _colHighHuffman[i]);
+			readHuffman(video, state.colHighHuffman[i]);
 
-		_colLastVal = 0;
+		state.colLastVal = 0;
 	}
 
 	if ((source != kSourceIntraDC) && (source != kSourceInterDC))
-		readHuffman(video, _bundles[source].huffman);
+		readHuffman(video, state.bundles[source].huffman);
 
-	_bundles[source].curDec = _bundles[source].data;
-	_bundles[source].curPtr = _bundles[source].data;
+	state.bundles[source].curDec = state.bundles[source].data;
+	state.bundles[source].curPtr = state.bundles[source].data;
 }
 
 void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffman) {
@@ -556,14 +654,14 @@ void BinkDecoder::BinkVideoTrack::mergeHuffmanSymbols(VideoFrame &video, byte *d
 		*dst++ = *src2++;
 }
 
-void BinkDecoder::BinkVideoTrack::initBundles() {
+void BinkDecoder::BinkVideoTrack::initBundles(PlaneState &state) {
 	uint32 bw     = (_surface.w  + 7) >> 3;
 	uint32 bh     = (_surface.h + 7) >> 3;
 	uint32 blocks = bw * bh;
 
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].data    = new byte[blocks * 64];
-		_bundles[i].dataEnd = _bundles[i].data + blocks * 64;
+		state.bundles[i].data    = new byte[blocks * 64];
+		state.bundles[i].dataEnd = state.bundles[i].data + blocks * 64;
 	}
 
 	uint32 cbw[2] = { (uint32)((_surface.w + 7) >> 3), (uint32)((_surface.w  + 15) >> 4) };
@@ -573,21 +671,21 @@ void BinkDecoder::BinkVideoTrack::initBundles() {
 	for (int i = 0; i < 2; i++) {
 		int width = MAX<uint32>(cw[i], 8);
 
-		_bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
-		_bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
-		_bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
-		_bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
+		state.bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		state.bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
+		state.bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
+		state.bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		state.bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		state.bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		state.bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		state.bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
+		state.bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::deinitBundles() {
+void BinkDecoder::BinkVideoTrack::deinitBundles(PlaneState &state) {
 	for (int i = 0; i < kSourceMAX; i++)
-		delete[] _bundles[i].data;
+		delete[] state.bundles[i].data;
 }
 
 void BinkDecoder::BinkVideoTrack::initHuffman() {
@@ -599,16 +697,16 @@ byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(VideoFrame &video, Huffman &h
 	return huffman.symbols[_huffman[huffman.index]->getSymbol(*video.bits)];
 }
 
-int32 BinkDecoder::BinkVideoTrack::getBundleValue(Source source) {
+int32 BinkDecoder::BinkVideoTrack::getBundleValue(DecodeContext &ctx, Source source) {
 	if ((source < kSourceXOff) || (source == kSourceRun))
-		return *_bundles[source].curPtr++;
+		return *ctx.state->bundles[source].curPtr++;
 
 	if ((source == kSourceXOff) || (source == kSourceYOff))
-		return (int8) *_bundles[source].curPtr++;
+		return (int8) *ctx.state->bundles[source].curPtr++;
 
-	int16 ret = *((int16 *) _bundles[source].curPtr);
+	int16 ret = *((int16 *) ctx.state->bundles[source].curPtr);
 
-	_bundles[source].curPtr += 2;
+	ctx.state->bundles[source].curPtr += 2;
 
 	return ret;
 }
@@ -645,7 +743,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
 		if (i > 64)
@@ -653,7 +751,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++, scan++)
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
@@ -665,7 +763,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
 				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
@@ -673,14 +771,14 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 		ctx.dest[ctx.coordScaledMap1[*scan]] =
 		ctx.dest[ctx.coordScaledMap2[*scan]] =
 		ctx.dest[ctx.coordScaledMap3[*scan]] =
-		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
@@ -698,7 +796,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 16; i++, dest += ctx.pitch)
@@ -709,12 +807,12 @@ void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
 	byte *dest1 = ctx.dest;
 	byte *dest2 = ctx.dest + ctx.pitch;
 	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		byte v = getBundleValue(kSourcePattern);
+		byte v = getBundleValue(ctx, kSourcePattern);
 
 		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
 			dest1[0] = dest1[1] = dest2[0] = dest2[1] = col[v & 1];
@@ -727,17 +825,17 @@ void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
 	byte *dest1 = ctx.dest;
 	byte *dest2 = ctx.dest + ctx.pitch;
 	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
+		memcpy(row, ctx.state->bundles[kSourceColors].curPtr, 8);
 
 		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
 			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
 
-		_bundles[kSourceColors].curPtr += 8;
+		ctx.state->bundles[kSourceColors].curPtr += 8;
 	}
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
-	BlockType blockType = (BlockType) getBundleValue(kSourceSubBlockTypes);
+	BlockType blockType = (BlockType) getBundleValue(ctx, kSourceSubBlockTypes);
 
 	switch (blockType) {
 	case kBlockRun:
@@ -765,8 +863,8 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
-	int8 xOff = getBundleValue(kSourceXOff);
-	int8 yOff = getBundleValue(kSourceYOff);
+	int8 xOff = getBundleValue(ctx, kSourceXOff);
+	int8 yOff = getBundleValue(ctx, kSourceYOff);
 
 	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
@@ -782,7 +880,7 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
 		if (i > 64)
@@ -790,18 +888,18 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++)
 				ctx.dest[ctx.coordMap[*scan++]] = v;
 
 		} else
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
 	if (i == 63)
-		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
@@ -825,7 +923,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
@@ -833,7 +931,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch)
@@ -846,7 +944,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceInterDC);
+	block[0] = getBundleValue(ctx, kSourceInterDC);
 
 	readDCTCoeffs(*ctx.video, block, false);
 
@@ -857,11 +955,11 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
-		byte v = getBundleValue(kSourcePattern);
+		byte v = getBundleValue(ctx, kSourcePattern);
 
 		for (int j = 0; j < 8; j++, v >>= 1)
 			*dest++ = col[v & 1];
@@ -870,11 +968,11 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
 	byte *dest = ctx.dest;
-	byte *data = _bundles[kSourceColors].curPtr;
+	byte *data = ctx.state->bundles[kSourceColors].curPtr;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch, data += 8)
 		memcpy(dest, data, 8);
 
-	_bundles[kSourceColors].curPtr += 64;
+	ctx.state->bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
@@ -989,7 +1087,9 @@ void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle
 }
 
 
-void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle) {
+void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, PlaneState &state) {
+	Bundle &bundle = state.bundles[kSourceColors];
+
 	uint32 n = readBundleCount(video, bundle);
 	if (n == 0)
 		return;
@@ -999,11 +1099,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 		error("Too many color values");
 
 	if (video.bits->getBit()) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		state.colLastVal = getHuffmanSymbol(video, state.colHighHuffman[state.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (state.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1018,11 +1118,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 	}
 
 	while (bundle.curDec < decEnd) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		state.colLastVal = getHuffmanSymbol(video, state.colHighHuffman[state.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (state.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -33,6 +33,7 @@
 #include "common/array.h"
 #include "common/rational.h"
 #include "common/scummsys.h"
+#include "common/threadpool.h"
 
 #include "video/video_decoder.h"
 
@@ -133,6 +134,7 @@ private:
 		uint32 offset;
 		uint32 size;
 
+		const byte *data; ///< The packet data, while it is decoded.
 		Common::BitStream *bits;
 
 		VideoFrame();
@@ -158,9 +160,12 @@ private:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
 	private:
+		struct PlaneState;
+
 		/** A decoder state. */
 		struct DecodeContext {
 			VideoFrame *video;
+			PlaneState *state;
 
 			uint32 planeIdx;
 
@@ -245,31 +250,66 @@ private:
 
 		Common::Rational _frameRate;
 
-		Bundle _bundles[kSourceMAX]; ///< Bundles for decoding all data types.
+		/** The state for decoding one plane. Planes decoded at the same time each need their own. */
+		struct PlaneState {
+			Bundle bundles[kSourceMAX]; ///< Bundles for decoding all data types.
 
-		Common::Huffman *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
+			/** Huffman codebooks to use for decoding high nibbles in color data types. */
+			Huffman colHighHuffman[16];
+			/** Value of the last decoded high nibble in color data types. */
+			int colLastVal;
+		};
+
+		/** How BIKi stores the start of the chroma planes. */
+		enum ChromaOffset {
+			kChromaOffsetUnknown,  ///< Not checked yet.
+			kChromaOffsetAbsolute, ///< From the start of the packet.
+			kChromaOffsetRelative, ///< From the end of the offset.
+			kChromaOffsetNone      ///< Not usable, so the planes are decoded in order.
+		};
+
+		/** Decodes the chroma planes while the luma plane is decoded. */
+		class ChromaJob : public Common::ThreadJob {
+		public:
+			ChromaJob(BinkVideoTrack *track, VideoFrame *video) : _track(track), _video(video) {}
+			void run();
 
-		/** Huffman codebooks to use for decoding high nibbles in color data types. */
-		Huffman _colHighHuffman[16];
-		/** Value of the last decoded high nibble in color data types. */
-		int _colLastVal;
+		private:
+			BinkVideoTrack *_track;
+			VideoFrame *_video;
+		};
+
+		friend class ChromaJob;
+
+		/** The luma (and alpha) plane state, and the chroma plane state when decoding in parallel. */
+		PlaneState _planeStates[2];
+
+		/** The worker thread for the chroma planes, 0 if they are decoded in order. */
+		Common::ThreadPool *_planeThread;
+		ChromaOffset _chromaOffset;
+
+		Common::Huffman *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
 
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
 		/** Initialize the bundles. */
-		void initBundles();
+		void initBundles(PlaneState &state);
 		/** Deinitialize the bundles. */
-		void deinitBundles();
+		void deinitBundles(PlaneState &state);
 
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
 		/** Decode a plane. */
-		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
+		void decodePlane(VideoFrame &video, PlaneState &state, int planeIdx, bool isChroma);
+		/** Decode the chroma planes, which follow each other in the bitstream. */
+		void decodeChromaPlanes(VideoFrame &video, PlaneState &state);
+		/** Find where the chroma planes start, or return false if that is not known. */
+		bool getChromaStart(uint32 offset, uint32 offsetEnd, uint32 size, uint32 &start) const;
 
 		/** Read/Initialize a bundle for decoding a plane. */
-		void readBundle(VideoFrame &video, Source source);
+		void readBundle(VideoFrame &video, PlaneState &state, Source source);
 
 		/** Read the symbols for a Huffman code. */
 		void readHuffman(VideoFrame &video, Huffman &huffman);
@@ -280,7 +320,7 @@ private:
 		byte getHuffmanSymbol(VideoFrame &video, Huffman &huffman);
 
 		/** Get a direct value out of a bundle. */
-		int32 getBundleValue(Source source);
+		int32 getBundleValue(DecodeContext &ctx, Source source);
 		/** Read a count value out of a bundle. */
 		uint32 readBundleCount(VideoFrame &video, Bundle &bundle);
 
@@ -307,7 +347,7 @@ private:
 		void readMotionValues(VideoFrame &video, Bundle &bundle);
 		void readBlockTypes  (VideoFrame &video, Bundle &bundle);
 		void readPatterns    (VideoFrame &video, Bundle &bundle);
-		void readColors      (VideoFrame &video, Bundle &bundle);
+		void readColors      (VideoFrame &video, PlaneState &state);
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
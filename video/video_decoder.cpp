@@ -27,14 +27,29 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/archive.h"
 #include "common/rational.h"
-#include "common/file.h"
+#include "common/rect.h"
 #include "common/system.h"
+#include "common/threadpool.h"
 
 #include "graphics/palette.h"
 
 namespace Video {
 
+/**
+ * Fills the decode-ahead queue of a VideoDecoder on its worker thread.
+ */
+class DecodeAheadJob : public Common::ThreadJob {
+public:
+	DecodeAheadJob(VideoDecoder *decoder) : _decoder(decoder) {}
+
+	void run() { _decoder->decodeAheadFrames(); }
+
+private:
+	VideoDecoder *_decoder;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -50,6 +65,15 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAheadTrack = 0;
+	_decodeAheadHead = 0;
+	_decodeAheadQueued = 0;
+	_decodeAheadEnd = false;
+	_decodeAheadNextStartTime = 0;
+	_decodeAheadCurFrame = -1;
+	_decodeAheadRunning = false;
+	_decodeAheadStop = false;
+	_decodeAheadThread = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -58,10 +82,18 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	// Subclasses should have called close() already, but make sure the
+	// decode-ahead thread no longer references us.
+	disableDecodeAhead();
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	disableDecodeAhead();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -84,14 +116,13 @@ void VideoDecoder::close() {
 }
 
 bool VideoDecoder::loadFile(const Common::String &filename) {
-	Common::File *file = new Common::File();
-
-	if (!file->open(filename)) {
-		delete file;
+	// Videos are mostly read from start to end, so read the next part of
+	// the file while the current one is decoded, where the archive allows
+	Common::SeekableReadStream *stream = SearchMan.createReadAheadStreamForMember(filename, 64 * 1024);
+	if (!stream)
 		return false;
-	}
 
-	return loadStream(file);
+	return loadStream(stream);
 }
 
 bool VideoDecoder::needsUpdate() const {
@@ -116,11 +147,15 @@ void VideoDecoder::pauseVideo(bool pause) {
 
 		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 			(*it)->pause(true);
+
+		// No need to keep decoding while paused; the queued frames stay valid
+		stopDecodeAhead();
 	} else if (_pauseLevel == 0) {
 		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 			(*it)->pause(false);
 
 		_startTime += (g_system->getMillis() - _pauseStartTime);
+		startDecodeAhead();
 	}
 }
 
@@ -177,6 +212,9 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (_decodeAheadTrack)
+		return decodeNextFrameAhead();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -198,8 +236,8 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 }
 
 bool VideoDecoder::setReverse(bool reverse) {
-	// Can only reverse video-only videos
-	if (reverse && hasAudio())
+	// Can only reverse video-only videos, and only when not decoding ahead
+	if (reverse && (hasAudio() || _decodeAheadTrack))
 		return false;
 
 	// Attempt to make sure all the tracks are in the requested direction
@@ -222,6 +260,12 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	// The track is ahead of what was returned by decodeNextFrame()
+	if (_decodeAheadTrack) {
+		Common::StackLock lock(_decodeAheadMutex);
+		return _decodeAheadCurFrame;
+	}
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -267,7 +311,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getNextFrameStartTime(_nextVideoTrack);
 
 	if (_nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
@@ -285,9 +329,16 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
-	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if (!(*it)->endOfTrack() && ((*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			const VideoTrack *track = (const VideoTrack *)*it;
+
+			if (!endOfVideoTrack(track) && (!_endTimeSet || getNextFrameStartTime(track) < (uint)_endTime.msecs()))
+				return false;
+		} else if (!(*it)->endOfTrack()) {
 			return false;
+		}
+	}
 
 	return true;
 }
@@ -311,9 +362,16 @@ bool VideoDecoder::rewind() {
 	if (isPlaying())
 		stopAudio();
 
-	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if (!(*it)->rewind())
+	// Also stop decoding ahead, the queued frames are now invalid
+	stopDecodeAhead();
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if (!(*it)->rewind()) {
+			// Nothing was rewound, so keep the queued frames
+			startDecodeAhead();
 			return false;
+		}
+	}
 
 	// Now that we've rewound, start all tracks again
 	if (isPlaying())
@@ -322,6 +380,7 @@ bool VideoDecoder::rewind() {
 	_lastTimeChange = 0;
 	_startTime = g_system->getMillis();
 	resetPauseStartTime();
+	resetDecodeAhead();
 	findNextVideoTrack();
 	return true;
 }
@@ -345,14 +404,24 @@ bool VideoDecoder::seek(const Common::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
+	// Also stop decoding ahead, the queued frames are now invalid
+	stopDecodeAhead();
+
 	// Do the actual seeking
-	if (!seekIntern(time))
+	if (!seekIntern(time)) {
+		// Nothing was seeked, so keep the queued frames
+		startDecodeAhead();
 		return false;
+	}
 
 	// Seek any external track too
-	for (TrackListIterator it = _externalTracks.begin(); it != _externalTracks.end(); it++)
-		if (!(*it)->seek(time))
+	for (TrackListIterator it = _externalTracks.begin(); it != _externalTracks.end(); it++) {
+		if (!(*it)->seek(time)) {
+			// The video track was seeked already
+			resetDecodeAhead();
 			return false;
+		}
+	}
 
 	_lastTimeChange = time;
 
@@ -364,6 +433,7 @@ bool VideoDecoder::seek(const Common::Timestamp &time) {
 	}
 
 	resetPauseStartTime();
+	resetDecodeAhead();
 	findNextVideoTrack();
 	_needsUpdate = true;
 	return true;
@@ -428,6 +498,9 @@ void VideoDecoder::stop() {
 	// Reset the pause state of the tracks too
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		(*it)->pause(false);
+
+	// And resume decoding ahead if we were paused
+	startDecodeAhead();
 }
 
 void VideoDecoder::setRate(const Common::Rational &rate) {
@@ -510,6 +583,232 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setDecodeAhead(uint frameCount) {
+	disableDecodeAhead();
+
+	if (frameCount == 0) {
+		findNextVideoTrack();
+		return true;
+	}
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// We only allow decoding ahead when one video track
+			// is present
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed())
+		return false;
+
+	// Decoding ahead needs a thread of its own
+	Common::ThreadPool *thread = new Common::ThreadPool(1, "VideoDecodeAhead");
+
+	if (thread->getThreadCount() == 0) {
+		delete thread;
+		return false;
+	}
+
+	// Frames will be decoded from now on, so dithering can't be changed
+	_canSetDither = false;
+
+	_decodeAheadThread = thread;
+	_decodeAheadTrack = track;
+	_decodeAheadFrames.resize(frameCount + 1);
+	resetDecodeAhead();
+	return true;
+}
+
+void VideoDecoder::disableDecodeAhead() {
+	if (!_decodeAheadTrack)
+		return;
+
+	stopDecodeAhead();
+	delete _decodeAheadThread;
+	_decodeAheadThread = 0;
+
+	for (uint i = 0; i < _decodeAheadFrames.size(); i++)
+		_decodeAheadFrames[i].surface.free();
+
+	_decodeAheadFrames.clear();
+	_decodeAheadTrack = 0;
+}
+
+void VideoDecoder::startDecodeAhead() {
+	// Never decode while paused or without a track
+	if (!_decodeAheadTrack || isPaused())
+		return;
+
+	Common::StackLock lock(_decodeAheadMutex);
+	_decodeAheadStop = false;
+
+	if (_decodeAheadRunning || !canDecodeAhead())
+		return;
+
+	_decodeAheadRunning = true;
+	_decodeAheadThread->addJob(new DecodeAheadJob(this), DisposeAfterUse::YES);
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_decodeAheadTrack)
+		return;
+
+	_decodeAheadMutex.lock();
+	_decodeAheadStop = true;
+	_decodeAheadMutex.unlock();
+
+	// Wait for the frame currently being decoded to be queued. The thread
+	// does not touch the track anymore after this.
+	_decodeAheadThread->wait();
+}
+
+void VideoDecoder::resetDecodeAhead() {
+	// The track may have changed position, so drop all queued frames
+	// and restart from where it is now.
+	if (!_decodeAheadTrack)
+		return;
+
+	stopDecodeAhead();
+
+	{
+		Common::StackLock lock(_decodeAheadMutex);
+		_decodeAheadHead = 0;
+		_decodeAheadQueued = 0;
+		_decodeAheadEnd = _decodeAheadTrack->endOfTrack();
+		_decodeAheadNextStartTime = _decodeAheadTrack->getNextFrameStartTime();
+		_decodeAheadCurFrame = _decodeAheadTrack->getCurFrame();
+	}
+
+	startDecodeAhead();
+}
+
+bool VideoDecoder::canDecodeAhead() const {
+	return !_decodeAheadEnd && _decodeAheadQueued < _decodeAheadFrames.size() - 1;
+}
+
+void VideoDecoder::decodeAheadFrames() {
+	while (true) {
+		{
+			Common::StackLock lock(_decodeAheadMutex);
+
+			if (_decodeAheadStop || !canDecodeAhead()) {
+				_decodeAheadRunning = false;
+				return;
+			}
+		}
+
+		decodeAheadFrame();
+	}
+}
+
+bool VideoDecoder::decodeAheadFrame() {
+	uint slot;
+
+	{
+		Common::StackLock lock(_decodeAheadMutex);
+
+		if (!canDecodeAhead())
+			return false;
+
+		slot = (_decodeAheadHead + _decodeAheadQueued) % _decodeAheadFrames.size();
+	}
+
+	// The slot is not visible to the engine thread until it is queued,
+	// so it can be filled without holding the mutex.
+	DecodeAheadFrame &frame = _decodeAheadFrames[slot];
+	frame.startTime = _decodeAheadTrack->getNextFrameStartTime();
+
+	readNextPacket();
+	const Graphics::Surface *surface = _decodeAheadTrack->decodeNextFrame();
+
+	frame.hasSurface = surface != 0;
+
+	if (surface) {
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+			frame.surface.free();
+			frame.surface.create(surface->w, surface->h, surface->format);
+		}
+
+		frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+	}
+
+	frame.dirtyPalette = _decodeAheadTrack->hasDirtyPalette();
+
+	if (frame.dirtyPalette)
+		memcpy(frame.palette, _decodeAheadTrack->getPalette(), 256 * 3);
+
+	frame.curFrame = _decodeAheadTrack->getCurFrame();
+
+	Common::StackLock lock(_decodeAheadMutex);
+	_decodeAheadQueued++;
+	_decodeAheadEnd = _decodeAheadTrack->endOfTrack();
+	_decodeAheadNextStartTime = _decodeAheadTrack->getNextFrameStartTime();
+	return true;
+}
+
+const Graphics::Surface *VideoDecoder::decodeNextFrameAhead() {
+	_decodeAheadMutex.lock();
+	bool underrun = _decodeAheadQueued == 0;
+	_decodeAheadMutex.unlock();
+
+	// If the thread couldn't keep up, decode the frame ourselves
+	if (underrun) {
+		stopDecodeAhead();
+		decodeAheadFrame();
+	}
+
+	Common::StackLock lock(_decodeAheadMutex);
+
+	// Nothing left to show
+	if (_decodeAheadQueued == 0)
+		return 0;
+
+	DecodeAheadFrame &frame = _decodeAheadFrames[_decodeAheadHead];
+	_decodeAheadHead = (_decodeAheadHead + 1) % _decodeAheadFrames.size();
+	_decodeAheadQueued--;
+	_decodeAheadCurFrame = frame.curFrame;
+
+	// Copy the palette, as the slot will be reused by the next frame
+	if (frame.dirtyPalette) {
+		memcpy(_decodeAheadPalette, frame.palette, 256 * 3);
+		_palette = _decodeAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	// A slot is free again, so keep the thread busy
+	startDecodeAhead();
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+bool VideoDecoder::endOfVideoTrack(const VideoTrack *track) const {
+	if (track == _decodeAheadTrack) {
+		Common::StackLock lock(_decodeAheadMutex);
+		return _decodeAheadEnd && _decodeAheadQueued == 0;
+	}
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getNextFrameStartTime(const VideoTrack *track) const {
+	if (track == _decodeAheadTrack) {
+		Common::StackLock lock(_decodeAheadMutex);
+
+		if (_decodeAheadQueued != 0)
+			return _decodeAheadFrames[_decodeAheadHead].startTime;
+
+		return _decodeAheadNextStartTime;
+	}
+
+	return track->getNextFrameStartTime();
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -839,6 +1138,12 @@ bool VideoDecoder::endOfVideoTracks() const {
 }
 
 VideoDecoder::VideoTrack *VideoDecoder::findNextVideoTrack() {
+	// The only video track is busy decoding ahead
+	if (_decodeAheadTrack) {
+		_nextVideoTrack = _decodeAheadTrack;
+		return _nextVideoTrack;
+	}
+
 	_nextVideoTrack = 0;
 	uint32 bestTime = 0xFFFFFFFF;
 
@@ -887,7 +1192,7 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack() && (!_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !endOfVideoTrack((const VideoTrack *)*it) && (!_endTimeSet || getNextFrameStartTime((const VideoTrack *)*it) < (uint)_endTime.msecs()))
 			return true;
 
 	return false;
@@ -27,10 +27,12 @@
 
 #include "audio/mixer.h"
 #include "common/array.h"
+#include "common/mutex.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "common/timestamp.h"
 #include "graphics/pixelformat.h"
+#include "graphics/surface.h"
 
 namespace Audio {
 class AudioStream;
@@ -40,10 +42,7 @@ class SeekableAudioStream;
 
 namespace Common {
 class SeekableReadStream;
-}
-
-namespace Graphics {
-struct Surface;
+class ThreadPool;
 }
 
 namespace Video {
@@ -54,7 +53,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -398,6 +397,36 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time.
+	 *
+	 * When enabled, frames are decoded on a thread of their own into a
+	 * queue of up to frameCount surfaces. decodeNextFrame() then only has
+	 * to take the next frame from the queue. If no frame is ready yet, it
+	 * is decoded right away, just like without this setting. Pausing,
+	 * seeking and rewinding stop the thread first, and the latter two
+	 * drop all queued frames.
+	 *
+	 * This only works for videos with exactly one video track that is
+	 * played forward, and on backends which can create worker threads.
+	 * Any dithering palette needs to be set before calling this. While
+	 * this is enabled, subclasses must not touch the state of their
+	 * tracks outside of readNextPacket() and the tracks' own
+	 * decodeNextFrame() functions.
+	 *
+	 * This should be called after loadStream(). The setting is reset by
+	 * close().
+	 *
+	 * @param frameCount The number of frames to decode ahead, or 0 to disable
+	 * @return true on success, false otherwise
+	 */
+	bool setDecodeAhead(uint frameCount);
+
+	/**
+	 * Returns if frames are currently being decoded ahead of time.
+	 */
+	bool isDecodingAhead() const { return _decodeAheadTrack != 0; }
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -916,6 +945,8 @@ protected:
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
 private:
+	friend class DecodeAheadJob;
+
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
 	TrackList _internalTracks;
@@ -952,6 +983,45 @@ private:
 	int8 _audioBalance;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decoding ahead of time
+	struct DecodeAheadFrame {
+		DecodeAheadFrame() : hasSurface(false), dirtyPalette(false), startTime(0), curFrame(-1) {}
+
+		Graphics::Surface surface;
+		bool hasSurface;
+		bool dirtyPalette;
+		byte palette[256 * 3];
+		uint32 startTime;
+		int curFrame;
+	};
+
+	// The frame ring has one more entry than frames that may be queued,
+	// so the frame returned by the last decodeNextFrame() is never
+	// overwritten.
+	Common::Array<DecodeAheadFrame> _decodeAheadFrames;
+	VideoTrack *_decodeAheadTrack;
+	uint _decodeAheadHead;
+	uint _decodeAheadQueued;
+	bool _decodeAheadEnd;
+	uint32 _decodeAheadNextStartTime;
+	int _decodeAheadCurFrame;
+	bool _decodeAheadRunning; // A job is queued on the thread
+	bool _decodeAheadStop;    // The job has to end after the current frame
+	byte _decodeAheadPalette[256 * 3];
+	Common::Mutex _decodeAheadMutex;
+	Common::ThreadPool *_decodeAheadThread;
+
+	void disableDecodeAhead();
+	void startDecodeAhead();
+	void stopDecodeAhead();
+	void resetDecodeAhead();
+	bool canDecodeAhead() const;
+	bool decodeAheadFrame();
+	void decodeAheadFrames();
+	const Graphics::Surface *decodeNextFrameAhead();
+	bool endOfVideoTrack(const VideoTrack *track) const;
+	uint32 getNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video